@@ -114,7 +114,7 @@ std::string Bundle::GenerateClassDefinition(
       &output, "Instruction *", class_name, "::Decode(uint64_t address, ",
       encoding_type,
       " *encoding) {\n"
-      "  Instruction *inst = new Instruction(address, arch_state_);\n"
+      "  Instruction *inst = Instruction::Create(address, arch_state_);\n"
       "  Instruction *tmp_inst;\n");
   // Decoded bundles are added to the child list.
   for (const auto& bundle_name : bundle_names()) {
@@ -396,7 +396,7 @@ std::string InstructionSet::GenerateClassDefinitions(
     // are added as children of this parent instruction. The parent instruction
     // is responsible for controlling issue of the bundles.
     absl::StrAppend(&output,
-                    "  inst = new Instruction(address, arch_state_);\n");
+                    "  inst = Instruction::Create(address, arch_state_);\n");
     // Generate calls to each of the top level bundle Decode methods.
     for (auto const& bundle_name : bundle_->bundle_names()) {
       absl::StrAppend(&output, "  tmp_inst = ", bundle_name,
@@ -2421,7 +2421,8 @@ std::string InstructionSetVisitor::GenerateHdrFileProlog(
                   "using ResourceSetter = void(*)(Instruction *, ",
                   encoding_base_name,
                   "*, SlotEnum, int);\n"
-                  "using SemFuncSetter = std::vector<SemFunc>;\n"
+                  "using SemFuncSetter = std::vector<"
+                  "::mpact::sim::generic::PreboundSemanticFunction>;\n"
                   "using AttributeSetter = void(*)(Instruction *);\n"
                   "struct InstructionInfo {\n"
                   "  OperandSetter operand_setter;\n"
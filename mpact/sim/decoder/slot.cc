@@ -1387,7 +1387,7 @@ std::string Slot::GenerateClassDefinition(absl::string_view encoding_type) {
       "  OpcodeEnum opcode = isa_encoding->GetOpcode(slot, entry);\n"
       "  int indx = static_cast<int>(opcode);\n"
       "  auto &inst_info = instruction_info_.at(indx);\n"
-      "  Instruction *inst = new Instruction(address, arch_state_);\n"
+      "  Instruction *inst = Instruction::Create(address, arch_state_);\n"
       "  inst->set_size(inst_info.instruction_size);\n"
       "  inst->set_opcode(static_cast<int>(opcode));\n"
       "  inst->set_semantic_function(inst_info.semfunc[0]);\n"
@@ -1395,7 +1395,7 @@ std::string Slot::GenerateClassDefinition(absl::string_view encoding_type) {
       "entry);\n"
       "  Instruction *parent = inst;\n"
       "  for (size_t i = 1; i < inst_info.operand_setter.size(); i++) {\n"
-      "    Instruction *child = new Instruction(address, arch_state_);\n"
+      "    Instruction *child = Instruction::Create(address, arch_state_);\n"
       "    child->set_semantic_function(inst_info.semfunc[i]);\n"
       "    inst_info.operand_setter[i](child, isa_encoding, opcode, slot, "
       "entry);\n"
@@ -1404,7 +1404,7 @@ std::string Slot::GenerateClassDefinition(absl::string_view encoding_type) {
       "    parent = child;\n"
       "  }\n"
       "  inst_info.resource_setter(inst, isa_encoding, slot, entry);\n"
-      "  inst_info.disassembly_setter(inst);\n"
+      "  inst->SetDisassemblyFunction(inst_info.disassembly_setter);\n"
       "  inst_info.attribute_setter(inst);\n"
       "  return inst;\n"
       "}\n");
@@ -14,6 +14,8 @@
 
 #include "mpact/sim/generic/arch_state.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <string>
 #include <utility>
 
@@ -22,6 +24,7 @@
 #include "absl/strings/string_view.h"
 #include "mpact/sim/generic/component.h"
 #include "mpact/sim/generic/data_buffer.h"
+#include "mpact/sim/generic/delay_line_interface.h"
 #include "mpact/sim/generic/fifo.h"
 #include "mpact/sim/generic/function_delay_line.h"
 #include "mpact/sim/generic/operand_interface.h"
@@ -100,6 +103,43 @@ ArchState::~ArchState() {
   delete program_error_controller_;
 }
 
+void ArchState::AdvanceTo(uint64_t cycle) {
+  while (cycle_ < cycle) {
+    uint64_t remaining = cycle - cycle_;
+    int next = CyclesToNextEvent();
+    if (next == DelayLineInterface::kNoEvent) {
+      cycle_ = cycle;
+      return;
+    }
+    // Skip the idle cycles before the next event (or the target cycle).
+    uint64_t idle = std::min<uint64_t>(next - 1, remaining);
+    if (idle > 0) {
+      for (auto dl : delay_lines_) {
+        if (!dl->IsEmpty()) dl->AdvanceBy(idle);
+      }
+      cycle_ += idle;
+    }
+    // Perform the actions of the next event, which may add new records to the
+    // delay lines.
+    if (cycle_ < cycle) AdvanceDelayLines();
+  }
+}
+
+uint64_t ArchState::SkipIdleCycles() {
+  int next = CyclesToNextEvent();
+  if (next == DelayLineInterface::kNoEvent) return 0;
+  AdvanceTo(cycle_ + next);
+  return next;
+}
+
+int ArchState::CyclesToNextEvent() const {
+  int next = DelayLineInterface::kNoEvent;
+  for (auto dl : delay_lines_) {
+    next = std::min(next, dl->CyclesToNextEvent());
+  }
+  return next;
+}
+
 }  // namespace generic
 }  // namespace sim
 }  // namespace mpact
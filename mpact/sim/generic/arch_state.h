@@ -35,6 +35,7 @@ namespace generic {
 
 class RegisterBase;
 class FifoBase;
+class InstructionArena;
 
 // The ArchState class is a "glue" class for the simulated architecture state.
 // It is intended that it be used to derive a class for each specific
@@ -109,6 +110,22 @@ class ArchState : public Component {
     }
   }
 
+  // Advances the cycle count and all registered delay lines to the given
+  // cycle. This has the same effect as calling AdvanceDelayLines() once per
+  // cycle, but runs of cycles in which none of the delay lines perform any
+  // actions are skipped over in one step. State that tracks time relative to
+  // the cycle count, such as ComplexResource, catches up on its next access.
+  // Does nothing if the cycle is not greater than the current cycle.
+  void AdvanceTo(uint64_t cycle);
+  // Advances to the next cycle in which a delay line performs an action, and
+  // performs the actions for that cycle. Returns the number of cycles
+  // advanced, or zero if all the delay lines are empty.
+  uint64_t SkipIdleCycles();
+  // Returns the number of cycles until the next cycle in which a delay line
+  // performs an action, or DelayLineInterface::kNoEvent if all the delay lines
+  // are empty.
+  int CyclesToNextEvent() const;
+
   // Create and add a delay line of the given type. This provides a mechanism
   // to add additional delay lines for types other than data buffer instances
   // and void() function objects that will be advanced when the ArchState
@@ -145,6 +162,13 @@ class ArchState : public Component {
   FunctionDelayLine* function_delay_line() const {
     return function_delay_line_;
   }
+  // The optional arena used to allocate decoded instructions (see
+  // Instruction::Create()). The arena is not owned by the ArchState instance,
+  // and must outlive all instructions allocated from it.
+  InstructionArena* instruction_arena() const { return instruction_arena_; }
+  void set_instruction_arena(InstructionArena* arena) {
+    instruction_arena_ = arena;
+  }
   // Returns the PC operand interface (read only)
   SourceOperandInterface* pc_operand() const { return pc_operand_; }
   // Used to report program error (or even internal simulator errors).
@@ -164,6 +188,7 @@ class ArchState : public Component {
   uint64_t cycle_ = 0;
   SourceOperandInterface* pc_operand_;
   DataBufferFactory* db_factory_;
+  InstructionArena* instruction_arena_ = nullptr;
   RegisterMap registers_;
   FifoMap fifos_;
   DataBufferDelayLine* data_buffer_delay_line_;
@@ -0,0 +1,144 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mpact/sim/generic/block_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "absl/numeric/bits.h"
+#include "mpact/sim/generic/decode_cache.h"
+#include "mpact/sim/generic/instruction.h"
+
+namespace mpact {
+namespace sim {
+namespace generic {
+
+void InstructionBlock::Clear() {
+  for (auto* inst : instructions_) {
+    inst->DecRef();
+  }
+  instructions_.clear();
+  start_address_ = 0;
+  end_address_ = 0;
+}
+
+BlockCache::BlockCache(const BlockCacheProperties& props,
+                       DecodeCache* decode_cache)
+    : decode_cache_(decode_cache),
+      max_block_size_(props.max_block_size),
+      terminator_attribute_(props.terminator_attribute) {
+  num_entries_ = absl::bit_ceil(props.num_entries);
+  address_shift_ = decode_cache_->address_shift();
+  address_mask_ = static_cast<uint64_t>(num_entries_ - 1) << address_shift_;
+  blocks_ = new InstructionBlock[num_entries_];
+}
+
+BlockCache::~BlockCache() {
+  delete[] blocks_;
+  blocks_ = nullptr;
+}
+
+BlockCache* BlockCache::Create(const BlockCacheProperties& props,
+                               DecodeCache* decode_cache) {
+  if ((decode_cache == nullptr) || (props.num_entries == 0) ||
+      (props.max_block_size == 0)) {
+    return nullptr;
+  }
+  return new BlockCache(props, decode_cache);
+}
+
+const InstructionBlock* BlockCache::GetBlock(uint64_t address) {
+  uint64_t indx = (address & address_mask_) >> address_shift_;
+  InstructionBlock* block = &blocks_[indx];
+  if (!block->empty() && (block->start_address_ == address)) {
+    return block;
+  }
+  block->Clear();
+  BuildBlock(address, block);
+  if (block->empty()) return nullptr;
+  return block;
+}
+
+bool BlockCache::IsTerminator(const Instruction* inst) const {
+  if (terminator_attribute_ < 0) return false;
+  auto attributes = inst->Attributes();
+  if (terminator_attribute_ >= static_cast<int>(attributes.size())) {
+    return false;
+  }
+  return attributes[terminator_attribute_] != 0;
+}
+
+void BlockCache::BuildBlock(uint64_t address, InstructionBlock* block) {
+  uint64_t pc = address;
+  block->start_address_ = address;
+  while (static_cast<int>(block->instructions_.size()) < max_block_size_) {
+    Instruction* inst = decode_cache_->GetDecodedInstruction(pc);
+    if (inst == nullptr) break;
+    // The decode cache may evict the instruction while the rest of the block
+    // is decoded, so the block holds its own reference.
+    inst->IncRef();
+    block->instructions_.push_back(inst);
+    // An instruction without a size does not have a well defined successor.
+    if (inst->size() <= 0) {
+      pc += decode_cache_->address_inc();
+      break;
+    }
+    pc += inst->size();
+    if (IsTerminator(inst)) break;
+  }
+  if (block->instructions_.empty()) {
+    block->start_address_ = 0;
+    return;
+  }
+  block->end_address_ = pc;
+  low_address_ = std::min(low_address_, block->start_address_);
+  high_address_ = std::max(high_address_, block->end_address_);
+}
+
+void BlockCache::InvalidateBlocks(uint64_t start_address,
+                                  uint64_t end_address) {
+  if ((start_address >= high_address_) || (end_address <= low_address_)) {
+    return;
+  }
+  for (int entry = 0; entry < num_entries_; ++entry) {
+    if (blocks_[entry].Overlaps(start_address, end_address)) {
+      blocks_[entry].Clear();
+    }
+  }
+}
+
+void BlockCache::Invalidate(uint64_t address) {
+  InvalidateBlocks(address, address + 1);
+  decode_cache_->Invalidate(address);
+}
+
+void BlockCache::InvalidateRange(uint64_t start_address,
+                                 uint64_t end_address) {
+  InvalidateBlocks(start_address, end_address);
+  decode_cache_->InvalidateRange(start_address, end_address);
+}
+
+void BlockCache::InvalidateAll() {
+  for (int entry = 0; entry < num_entries_; ++entry) {
+    blocks_[entry].Clear();
+  }
+  low_address_ = ~0ULL;
+  high_address_ = 0;
+  decode_cache_->InvalidateAll();
+}
+
+}  // namespace generic
+}  // namespace sim
+}  // namespace mpact
@@ -0,0 +1,152 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MPACT_SIM_GENERIC_BLOCK_CACHE_H_
+#define MPACT_SIM_GENERIC_BLOCK_CACHE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "mpact/sim/generic/decode_cache.h"
+#include "mpact/sim/generic/instruction.h"
+
+// The block cache is layered on top of the decode cache. It chains decoded
+// instructions into straight-line blocks, so that a simulator top level loop
+// can execute a whole block of instructions after a single lookup, instead of
+// looking up each instruction in the decode cache before executing it.
+
+namespace mpact {
+namespace sim {
+namespace generic {
+
+// This structure contains properties used to configure the block cache. The
+// actual number of cached blocks will be the smallest power of two that is
+// greater or equal to num_entries. A block ends at the first instruction for
+// which the attribute at index terminator_attribute is non-zero (e.g., a
+// branch), or when it reaches max_block_size instructions. If the index is
+// negative, or the instruction has fewer attributes, only the block size
+// limits the length of the block.
+struct BlockCacheProperties {
+  // Actual size will be the power of two that is >= num_entries.
+  uint32_t num_entries;
+  // Maximum number of instructions in a block.
+  uint32_t max_block_size;
+  // Index of the instruction attribute that marks the end of a block.
+  int terminator_attribute;
+};
+
+// A straight-line sequence of decoded instructions. The block holds a
+// reference to each of its instructions. Only the last instruction in the
+// block can be a control flow instruction, so unless an instruction raises an
+// exception (or an interrupt is taken), each instruction's successor is the
+// next instruction in the block.
+class InstructionBlock {
+ public:
+  InstructionBlock() = default;
+  InstructionBlock(const InstructionBlock&) = delete;
+  InstructionBlock& operator=(const InstructionBlock&) = delete;
+  ~InstructionBlock() { Clear(); }
+
+  // Address of the first instruction in the block.
+  uint64_t start_address() const { return start_address_; }
+  // Address following the last byte of the last instruction in the block.
+  uint64_t end_address() const { return end_address_; }
+  // The instructions in the block in program order.
+  absl::Span<Instruction* const> instructions() const { return instructions_; }
+  int size() const { return instructions_.size(); }
+  bool empty() const { return instructions_.empty(); }
+
+ private:
+  friend class BlockCache;
+
+  // Returns true if the block overlaps the address range [start, end).
+  bool Overlaps(uint64_t start, uint64_t end) const {
+    return !empty() && (start < end_address_) && (end > start_address_);
+  }
+  // Releases the instructions held by the block.
+  void Clear();
+
+  uint64_t start_address_ = 0;
+  uint64_t end_address_ = 0;
+  std::vector<Instruction*> instructions_;
+};
+
+// The block cache is a direct mapped cache of instruction blocks, indexed by
+// the address of the first instruction in the block. Blocks are built using
+// the instructions returned by the decode cache. As blocks hold references to
+// decoded instructions, invalidations must be performed through the block
+// cache, which forwards them to the decode cache after invalidating any
+// overlapping blocks.
+class BlockCache {
+ private:
+  // Constructed using static factory method.
+  BlockCache(const BlockCacheProperties& props, DecodeCache* decode_cache);
+
+ public:
+  BlockCache() = delete;
+  BlockCache(const BlockCache&) = delete;
+  BlockCache& operator=(const BlockCache&) = delete;
+  virtual ~BlockCache();
+  // The BlockCache factory method takes the property struct and the decode
+  // cache used to obtain the decoded instructions. It returns nullptr if the
+  // properties are invalid. The decode cache is not owned by the block cache.
+  static BlockCache* Create(const BlockCacheProperties& props,
+                            DecodeCache* decode_cache);
+  // Returns the block that starts at the given address. If there is no such
+  // block in the cache, a new block is built from the decode cache. Returns
+  // nullptr if the first instruction cannot be decoded. The block remains
+  // valid until the next call to GetBlock() or any of the invalidation
+  // methods. If executing an instruction may invalidate the cache (e.g., an
+  // instruction fetch fence), the caller must stop iterating over the block
+  // after that instruction.
+  const InstructionBlock* GetBlock(uint64_t address);
+  // Invalidation operations. These methods remove every block that contains
+  // an instruction in the address range [start, end), or at the given address,
+  // or every block, then perform the same invalidation on the decode cache.
+  void Invalidate(uint64_t address);
+  void InvalidateRange(uint64_t start_address, uint64_t end_address);
+  void InvalidateAll();
+
+  // Accessors.
+  int num_entries() const { return num_entries_; }
+  int max_block_size() const { return max_block_size_; }
+  DecodeCache* decode_cache() const { return decode_cache_; }
+
+ private:
+  // Returns true if the instruction ends a block.
+  bool IsTerminator(const Instruction* inst) const;
+  // Fills the block with the instructions starting at address.
+  void BuildBlock(uint64_t address, InstructionBlock* block);
+  // Clears all blocks that overlap the address range [start, end).
+  void InvalidateBlocks(uint64_t start_address, uint64_t end_address);
+
+  DecodeCache* decode_cache_;
+  int num_entries_;
+  int max_block_size_;
+  int terminator_attribute_;
+  int address_shift_;
+  uint64_t address_mask_;
+  // The address range covered by blocks built since the last InvalidateAll().
+  // Used to avoid scanning the cache for invalidations outside of that range.
+  uint64_t low_address_ = ~0ULL;
+  uint64_t high_address_ = 0;
+  InstructionBlock* blocks_ = nullptr;
+};
+
+}  // namespace generic
+}  // namespace sim
+}  // namespace mpact
+
+#endif  // MPACT_SIM_GENERIC_BLOCK_CACHE_H_
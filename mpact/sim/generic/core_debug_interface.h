@@ -19,11 +19,17 @@
 #include <cstdint>
 #include <string>
 #include <type_traits>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "mpact/sim/generic/arch_state.h"
 #include "mpact/sim/generic/data_buffer.h"
 #include "mpact/sim/generic/instruction.h"
+#include "mpact/sim/generic/register.h"
 
 namespace mpact {
 namespace sim {
@@ -70,6 +76,11 @@ class CoreDebugInterface {
   // Underlying integer value type for HaltReason.
   using HaltReasonValueType = std::underlying_type_t<HaltReason>;
 
+  // Handle used to access a register without looking it up by name. Handles
+  // are obtained from GetRegisterHandle(), and are only valid for the
+  // interface instance that returned them.
+  using RegisterHandle = uint64_t;
+
   virtual ~CoreDebugInterface() = default;
 
   // Request that core stop running.
@@ -109,6 +120,31 @@ class CoreDebugInterface {
   virtual absl::StatusOr<DataBuffer*> GetRegisterDataBuffer(
       const std::string& name) = 0;
 
+  // Indexed register access. The register names are resolved to handles once,
+  // after which any number of registers can be read or written in a single
+  // call without name lookups. The default implementations return
+  // UnimplementedError, in which case the named register accessors above have
+  // to be used. Implementations that have no faster way of accessing registers
+  // can implement these methods using RegisterHandleTable (below), which
+  // accesses plain registers of an ArchState through their data buffers.
+
+  // Returns the handle for the named register.
+  virtual absl::StatusOr<RegisterHandle> GetRegisterHandle(
+      const std::string& name) {
+    return absl::UnimplementedError("GetRegisterHandle not implemented");
+  }
+  // Read/write the registers with the given handles. The values span must be
+  // at least as large as the handles span. Values are read or written in the
+  // order of the handles, stopping at the first error.
+  virtual absl::Status ReadRegisters(absl::Span<const RegisterHandle> handles,
+                                     absl::Span<uint64_t> values) {
+    return absl::UnimplementedError("ReadRegisters not implemented");
+  }
+  virtual absl::Status WriteRegisters(absl::Span<const RegisterHandle> handles,
+                                      absl::Span<const uint64_t> values) {
+    return absl::UnimplementedError("WriteRegisters not implemented");
+  }
+
   // Read/write the buffers to memory.
   virtual absl::StatusOr<size_t> ReadMemory(uint64_t address, void* buf,
                                             size_t length) = 0;
@@ -155,6 +191,136 @@ class CoreDebugInterface {
   virtual std::string GetExecutableFileName() { return ""; };
 };
 
+// Helper for implementing the indexed register access of CoreDebugInterface.
+// The handles index a table of the registers that have been resolved. If the
+// table is constructed with the ArchState of the core, registers in its
+// register map with a data buffer of 1, 2, 4 or 8 bytes are read and written
+// directly through their data buffers, without a name lookup per access. This
+// matches cores whose named accessors read and write such registers through
+// their data buffers without any side effects. Other registers are accessed
+// using the named register accessors of the core.
+class RegisterHandleTable {
+ public:
+  using RegisterHandle = CoreDebugInterface::RegisterHandle;
+
+  explicit RegisterHandleTable(CoreDebugInterface* core)
+      : RegisterHandleTable(core, nullptr) {}
+  RegisterHandleTable(CoreDebugInterface* core, ArchState* state)
+      : core_(core), state_(state) {}
+
+  // Returns the handle for the named register, or NotFoundError if the
+  // register can't be read.
+  absl::StatusOr<RegisterHandle> GetRegisterHandle(const std::string& name) {
+    auto iter = register_handles_.find(name);
+    if (iter != register_handles_.end()) return iter->second;
+    if (!core_->ReadRegister(name).ok()) {
+      return absl::NotFoundError(
+          absl::StrCat("Register '", name, "' not found"));
+    }
+    RegisterHandle handle = register_names_.size();
+    register_handles_.emplace(name, handle);
+    register_names_.push_back(name);
+    registers_.push_back(GetDirectRegister(name));
+    return handle;
+  }
+  absl::Status ReadRegisters(absl::Span<const RegisterHandle> handles,
+                             absl::Span<uint64_t> values) {
+    if (values.size() < handles.size()) {
+      return absl::InvalidArgumentError("Values span is too small");
+    }
+    for (size_t i = 0; i < handles.size(); ++i) {
+      if (handles[i] >= register_names_.size()) {
+        return absl::NotFoundError("Invalid register handle");
+      }
+      if (auto* reg = registers_[handles[i]]; reg != nullptr) {
+        values[i] = ReadDataBuffer(reg->data_buffer());
+        continue;
+      }
+      auto result = core_->ReadRegister(register_names_[handles[i]]);
+      if (!result.ok()) return result.status();
+      values[i] = result.value();
+    }
+    return absl::OkStatus();
+  }
+  absl::Status WriteRegisters(absl::Span<const RegisterHandle> handles,
+                              absl::Span<const uint64_t> values) {
+    if (values.size() < handles.size()) {
+      return absl::InvalidArgumentError("Values span is too small");
+    }
+    for (size_t i = 0; i < handles.size(); ++i) {
+      if (handles[i] >= register_names_.size()) {
+        return absl::NotFoundError("Invalid register handle");
+      }
+      if (auto* reg = registers_[handles[i]]; reg != nullptr) {
+        WriteDataBuffer(reg->data_buffer(), values[i]);
+        continue;
+      }
+      auto status =
+          core_->WriteRegister(register_names_[handles[i]], values[i]);
+      if (!status.ok()) return status;
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  // Returns the named register if it can be accessed through its data buffer,
+  // nullptr otherwise.
+  RegisterBase* GetDirectRegister(const std::string& name) const {
+    if (state_ == nullptr) return nullptr;
+    auto iter = state_->registers()->find(name);
+    if (iter == state_->registers()->end()) return nullptr;
+    auto* db = iter->second->data_buffer();
+    if (db == nullptr) return nullptr;
+    switch (db->size<uint8_t>()) {
+      case 1:
+      case 2:
+      case 4:
+      case 8:
+        return iter->second;
+      default:
+        return nullptr;
+    }
+  }
+  // The data buffer of a register may be replaced when it is written, so it
+  // is obtained from the register on each access.
+  static uint64_t ReadDataBuffer(const DataBuffer* db) {
+    switch (db->size<uint8_t>()) {
+      case 1:
+        return db->Get<uint8_t>(0);
+      case 2:
+        return db->Get<uint16_t>(0);
+      case 4:
+        return db->Get<uint32_t>(0);
+      default:
+        return db->Get<uint64_t>(0);
+    }
+  }
+  static void WriteDataBuffer(DataBuffer* db, uint64_t value) {
+    switch (db->size<uint8_t>()) {
+      case 1:
+        db->Set<uint8_t>(0, static_cast<uint8_t>(value));
+        break;
+      case 2:
+        db->Set<uint16_t>(0, static_cast<uint16_t>(value));
+        break;
+      case 4:
+        db->Set<uint32_t>(0, static_cast<uint32_t>(value));
+        break;
+      default:
+        db->Set<uint64_t>(0, value);
+        break;
+    }
+  }
+
+  CoreDebugInterface* core_;
+  ArchState* state_;
+  absl::flat_hash_map<std::string, RegisterHandle> register_handles_;
+  std::vector<std::string> register_names_;
+  // The register accessed directly for each handle, or nullptr if the handle
+  // is accessed by name.
+  std::vector<RegisterBase*> registers_;
+};
+
 }  // namespace generic
 }  // namespace sim
 }  // namespace mpact
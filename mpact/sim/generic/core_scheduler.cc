@@ -0,0 +1,146 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mpact/sim/generic/core_scheduler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "mpact/sim/generic/core_debug_interface.h"
+
+namespace mpact {
+namespace sim {
+namespace generic {
+
+CoreScheduler::CoreScheduler(const CoreSchedulerProperties& props)
+    : quantum_(props.quantum), mode_(props.mode) {
+  num_threads_ =
+      mode_ == CoreSchedulerProperties::Mode::kParallel ? props.num_threads : 1;
+  // The thread calling Run() also steps cores, so one fewer worker is needed.
+  for (int i = 1; i < num_threads_; i++) {
+    workers_.emplace_back(&CoreScheduler::WorkerLoop, this);
+  }
+}
+
+CoreScheduler::~CoreScheduler() {
+  {
+    absl::MutexLock lock(&mutex_);
+    shutdown_ = true;
+  }
+  for (auto& worker : workers_) worker.join();
+}
+
+CoreScheduler* CoreScheduler::Create(const CoreSchedulerProperties& props) {
+  if ((props.quantum == 0) ||
+      ((props.mode == CoreSchedulerProperties::Mode::kParallel) &&
+       (props.num_threads < 1))) {
+    return nullptr;
+  }
+  return new CoreScheduler(props);
+}
+
+int CoreScheduler::AddCore(StepFunction step_function) {
+  cores_.push_back({std::move(step_function)});
+  return cores_.size() - 1;
+}
+
+int CoreScheduler::AddCore(CoreDebugInterface* core) {
+  return AddCore([core](uint64_t num) -> absl::StatusOr<uint64_t> {
+    int steps = std::min<uint64_t>(num, std::numeric_limits<int>::max());
+    auto res = core->Step(steps);
+    if (!res.ok()) return res.status();
+    return res.value();
+  });
+}
+
+absl::Status CoreScheduler::Run(uint64_t max_quanta) {
+  stop_requested_ = false;
+  for (uint64_t count = 0; count < max_quanta; count++) {
+    if (stop_requested_) break;
+    if (std::none_of(cores_.begin(), cores_.end(),
+                     [](const Core& core) { return core.active; })) {
+      break;
+    }
+    RunQuantum();
+    num_quanta_++;
+    for (auto& core : cores_) {
+      if (!core.status.ok()) return std::exchange(core.status, absl::Status());
+    }
+    if (quantum_callback_) quantum_callback_(num_quanta_);
+  }
+  return absl::OkStatus();
+}
+
+void CoreScheduler::RunQuantum() {
+  next_core_ = 0;
+  if (workers_.empty()) {
+    StepCores();
+    return;
+  }
+  {
+    absl::MutexLock lock(&mutex_);
+    generation_++;
+    num_busy_workers_ = workers_.size();
+  }
+  StepCores();
+  // Wait for the workers to finish the cores they claimed.
+  mutex_.LockWhen(absl::Condition(
+      +[](int* num_busy) { return *num_busy == 0; }, &num_busy_workers_));
+  mutex_.Unlock();
+}
+
+void CoreScheduler::StepCores() {
+  int num_cores = cores_.size();
+  for (int index = next_core_++; index < num_cores; index = next_core_++) {
+    StepCore(cores_[index]);
+  }
+}
+
+void CoreScheduler::StepCore(Core& core) {
+  if (!core.active) return;
+  auto res = core.step_function(quantum_);
+  if (!res.ok()) {
+    core.status = res.status();
+    core.active = false;
+    return;
+  }
+  if (res.value() < quantum_) core.active = false;
+}
+
+void CoreScheduler::WorkerLoop() {
+  uint64_t generation = 0;
+  while (true) {
+    {
+      absl::MutexLock lock(&mutex_);
+      auto ready = [this, &generation]() {
+        return shutdown_ || (generation_ != generation);
+      };
+      mutex_.Await(absl::Condition(&ready));
+      if (shutdown_) return;
+      generation = generation_;
+    }
+    StepCores();
+    absl::MutexLock lock(&mutex_);
+    num_busy_workers_--;
+  }
+}
+
+}  // namespace generic
+}  // namespace sim
+}  // namespace mpact
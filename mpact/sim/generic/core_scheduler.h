@@ -0,0 +1,155 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MPACT_SIM_GENERIC_CORE_SCHEDULER_H_
+#define MPACT_SIM_GENERIC_CORE_SCHEDULER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "mpact/sim/generic/core_debug_interface.h"
+
+// The core scheduler runs the simulation of multiple cores in time quanta. In
+// each quantum, every active core is advanced by the same number of time units
+// (instructions or cycles, as interpreted by the core), after which all cores
+// synchronize before the next quantum starts. Interactions between cores that
+// are more fine grained than the quantum (e.g., through shared memory) are not
+// ordered in time within a quantum.
+
+namespace mpact {
+namespace sim {
+namespace generic {
+
+// This structure contains properties used to configure the core scheduler.
+struct CoreSchedulerProperties {
+  enum class Mode {
+    // The cores are run one after the other, in the order they were added, on
+    // the thread calling Run(). The interleaving of the cores is fixed, so the
+    // simulation is deterministic.
+    kSequential,
+    // The cores are run concurrently on a pool of num_threads host threads
+    // (including the thread calling Run()). The cores run freely within each
+    // quantum, so accesses to shared state are not deterministically ordered.
+    kParallel,
+  };
+  // Number of time units each core is advanced by in each quantum.
+  uint64_t quantum;
+  Mode mode;
+  // Number of host threads used in parallel mode.
+  int num_threads;
+};
+
+class CoreScheduler {
+ private:
+  // Constructed using static factory method.
+  explicit CoreScheduler(const CoreSchedulerProperties& props);
+
+ public:
+  // The step function advances a core by up to the given number of time units
+  // and returns the number of units it advanced. If it advances fewer units
+  // than requested, the core is considered halted, and it is not scheduled
+  // again until it is reactivated.
+  using StepFunction = absl::AnyInvocable<absl::StatusOr<uint64_t>(uint64_t)>;
+  // Function called on the thread calling Run() at the end of each quantum,
+  // with the number of quanta completed.
+  using QuantumCallback = absl::AnyInvocable<void(uint64_t)>;
+
+  CoreScheduler() = delete;
+  CoreScheduler(const CoreScheduler&) = delete;
+  CoreScheduler& operator=(const CoreScheduler&) = delete;
+  ~CoreScheduler();
+
+  // The factory method returns nullptr if the properties are invalid.
+  static CoreScheduler* Create(const CoreSchedulerProperties& props);
+
+  // Adds a core to the scheduler and returns its index. Cores cannot be added
+  // while Run() is executing.
+  int AddCore(StepFunction step_function);
+  // Adds a core that is stepped by instructions through its debug interface.
+  // The core is not owned by the scheduler.
+  int AddCore(CoreDebugInterface* core);
+
+  // Runs quanta until all cores are halted, max_quanta quanta have been run,
+  // or a stop is requested. Returns the first error returned by a step
+  // function, in which case the scheduler stops at the end of that quantum.
+  absl::Status Run(uint64_t max_quanta);
+  absl::Status Run() { return Run(~0ULL); }
+  // Requests that Run() returns at the end of the current quantum. This may be
+  // called from any thread, including from the step functions.
+  void RequestStop() { stop_requested_ = true; }
+
+  // Reactivates a halted core, or deactivates a core, so that it is (not)
+  // scheduled in the following quanta. Must not be called from a step
+  // function in parallel mode, but may be called from the quantum callback.
+  void SetActive(int core, bool active) { cores_[core].active = active; }
+  bool IsActive(int core) const { return cores_[core].active; }
+
+  void set_quantum_callback(QuantumCallback callback) {
+    quantum_callback_ = std::move(callback);
+  }
+
+  // Accessors.
+  uint64_t quantum() const { return quantum_; }
+  CoreSchedulerProperties::Mode mode() const { return mode_; }
+  int num_threads() const { return num_threads_; }
+  int num_cores() const { return cores_.size(); }
+  // Number of quanta run since the scheduler was created.
+  uint64_t num_quanta() const { return num_quanta_; }
+
+ private:
+  struct Core {
+    StepFunction step_function;
+    bool active = true;
+    absl::Status status;
+  };
+
+  // Runs one quantum for all active cores.
+  void RunQuantum();
+  // Steps the cores that have not yet been claimed by another thread.
+  void StepCores();
+  // Steps a single core for one quantum.
+  void StepCore(Core& core);
+  // The loop executed by the worker threads.
+  void WorkerLoop();
+
+  uint64_t quantum_;
+  CoreSchedulerProperties::Mode mode_;
+  int num_threads_;
+  uint64_t num_quanta_ = 0;
+  std::vector<Core> cores_;
+  QuantumCallback quantum_callback_;
+  std::atomic<bool> stop_requested_ = false;
+  // Index of the next core to be stepped in the current quantum.
+  std::atomic<int> next_core_ = 0;
+  // Worker thread synchronization. The generation is incremented at the start
+  // of each parallel quantum.
+  absl::Mutex mutex_;
+  uint64_t generation_ = 0;
+  int num_busy_workers_ = 0;
+  bool shutdown_ = false;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace generic
+}  // namespace sim
+}  // namespace mpact
+
+#endif  // MPACT_SIM_GENERIC_CORE_SCHEDULER_H_
@@ -26,7 +26,14 @@ namespace generic {
 
 DecodeCache::DecodeCache(const DecodeCacheProperties& props,
                          DecoderInterface* decoder)
-    : decoder_(decoder), instruction_cache_(nullptr) {
+    : decoder_(decoder),
+      replacement_(props.replacement),
+      instruction_cache_(nullptr),
+      num_victim_entries_(props.num_victim_entries),
+      hit_counter_("decode_cache_hit", 0ULL),
+      miss_counter_("decode_cache_miss", 0ULL),
+      conflict_counter_("decode_cache_conflict", 0ULL),
+      victim_hit_counter_("decode_cache_victim_hit", 0ULL) {
   num_entries_ = absl::bit_ceil(props.num_entries);
   address_shift_ =
       (absl::bit_width(static_cast<uint32_t>(props.minimum_pc_increment)) - 1);
@@ -36,7 +43,16 @@ DecodeCache::DecodeCache(const DecodeCacheProperties& props,
     instruction_cache_ = nullptr;
     return;
   }
-  address_mask_ = (num_entries_ - 1) << address_shift_;
+  num_ways_ = props.num_ways;
+  if ((num_ways_ <= 0) || !absl::has_single_bit(props.num_ways) ||
+      (num_ways_ > num_entries_)) {
+    // Number of ways not a power of 2, or larger than the cache.
+    instruction_cache_ = nullptr;
+    return;
+  }
+  way_shift_ = absl::bit_width(props.num_ways) - 1;
+  num_sets_ = num_entries_ >> way_shift_;
+  address_mask_ = static_cast<uint64_t>(num_sets_ - 1) << address_shift_;
 
   instruction_cache_ = new Instruction*[num_entries_];
   if (nullptr == instruction_cache_) {
@@ -47,12 +63,34 @@ DecodeCache::DecodeCache(const DecodeCacheProperties& props,
   for (int entry = 0; entry < num_entries_; ++entry) {
     instruction_cache_[entry] = nullptr;
   }
+  if ((num_ways_ > 1) && (replacement_ == DecodeCacheReplacement::kClock)) {
+    reference_bits_ = new bool[num_entries_];
+    for (int entry = 0; entry < num_entries_; ++entry) {
+      reference_bits_[entry] = false;
+    }
+    clock_hands_ = new int[num_sets_];
+    for (int set = 0; set < num_sets_; ++set) {
+      clock_hands_[set] = 0;
+    }
+  }
+  if (num_victim_entries_ > 0) {
+    victim_buffer_ = new Instruction*[num_victim_entries_];
+    for (int entry = 0; entry < num_victim_entries_; ++entry) {
+      victim_buffer_[entry] = nullptr;
+    }
+  }
 }
 
 DecodeCache::~DecodeCache() {
-  InvalidateAll();
+  if (instruction_cache_ != nullptr) InvalidateAll();
   delete[] instruction_cache_;
   instruction_cache_ = nullptr;
+  delete[] reference_bits_;
+  reference_bits_ = nullptr;
+  delete[] clock_hands_;
+  clock_hands_ = nullptr;
+  delete[] victim_buffer_;
+  victim_buffer_ = nullptr;
 }
 
 DecodeCache* DecodeCache::Create(const DecodeCacheProperties& props,
@@ -65,40 +103,139 @@ DecodeCache* DecodeCache::Create(const DecodeCacheProperties& props,
   return dc;
 }
 
+Instruction* DecodeCache::LookupSet(uint64_t base, uint64_t address) {
+  Instruction** set = &instruction_cache_[base];
+  for (int way = 0; way < num_ways_; ++way) {
+    Instruction* inst = set[way];
+    if ((nullptr == inst) || (inst->address() != address)) continue;
+    if (reference_bits_ != nullptr) {
+      // Clock: mark the entry as recently used.
+      reference_bits_[base + way] = true;
+    } else if (way > 0) {
+      // LRU: the ways are kept in most to least recently used order, so move
+      // the entry to the front of the set.
+      for (int i = way; i > 0; --i) set[i] = set[i - 1];
+      set[0] = inst;
+    }
+    return inst;
+  }
+  return nullptr;
+}
+
+Instruction* DecodeCache::TakeVictim(uint64_t address) {
+  for (int entry = 0; entry < num_victim_entries_; ++entry) {
+    Instruction* inst = victim_buffer_[entry];
+    if ((nullptr != inst) && (inst->address() == address)) {
+      victim_buffer_[entry] = nullptr;
+      return inst;
+    }
+  }
+  return nullptr;
+}
+
+void DecodeCache::AddVictim(Instruction* inst) {
+  if (num_victim_entries_ == 0) {
+    inst->DecRef();
+    return;
+  }
+  Instruction* old_inst = victim_buffer_[victim_next_];
+  if (nullptr != old_inst) old_inst->DecRef();
+  victim_buffer_[victim_next_] = inst;
+  victim_next_ = (victim_next_ + 1) % num_victim_entries_;
+}
+
+void DecodeCache::InsertIntoSet(uint64_t base, Instruction* inst) {
+  Instruction** set = &instruction_cache_[base];
+  Instruction* old_inst = nullptr;
+  if (reference_bits_ != nullptr) {
+    // Clock: advance the hand until an entry is found that is either empty
+    // or has not been referenced since the hand last passed it.
+    int set_index = base >> way_shift_;
+    int hand = clock_hands_[set_index];
+    while ((nullptr != set[hand]) && reference_bits_[base + hand]) {
+      reference_bits_[base + hand] = false;
+      hand = (hand + 1) & (num_ways_ - 1);
+    }
+    old_inst = set[hand];
+    set[hand] = inst;
+    reference_bits_[base + hand] = true;
+    clock_hands_[set_index] = (hand + 1) & (num_ways_ - 1);
+  } else {
+    // LRU: the least recently used entry is the last way, unless there is an
+    // empty (invalidated) way. Shift the more recently used entries down and
+    // insert the new instruction at the front of the set.
+    int way = num_ways_ - 1;
+    for (int i = 0; i < num_ways_ - 1; ++i) {
+      if (nullptr == set[i]) {
+        way = i;
+        break;
+      }
+    }
+    old_inst = set[way];
+    for (int i = way; i > 0; --i) set[i] = set[i - 1];
+    set[0] = inst;
+  }
+  if (nullptr != old_inst) {
+    conflict_counter_.Increment(1ULL);
+    AddVictim(old_inst);
+  }
+}
+
 Instruction* DecodeCache::GetDecodedInstruction(uint64_t address) {
   // Verify that the instruction_cache_ was allocated
   if (nullptr == instruction_cache_) {
     return nullptr;
   }
 
-  uint64_t indx = (address & address_mask_) >> address_shift_;
-  Instruction* inst = instruction_cache_[indx];
-
+  uint64_t base = SetBase(address);
+  // Fast path for the most recently used (or only) way.
+  Instruction* inst = instruction_cache_[base];
   if ((nullptr != inst) && (inst->address() == address)) {
+    if (reference_bits_ != nullptr) reference_bits_[base] = true;
+    pending_hits_++;
     return inst;
   }
 
-  Instruction* new_inst = decoder_->DecodeInstruction(address);
+  if (num_ways_ > 1) {
+    inst = LookupSet(base, address);
+    if (nullptr != inst) {
+      pending_hits_++;
+      return inst;
+    }
+  }
 
-  if (nullptr == new_inst) {
-    return nullptr;
+  Instruction* new_inst = nullptr;
+  if (num_victim_entries_ > 0) {
+    new_inst = TakeVictim(address);
+    if (nullptr != new_inst) victim_hit_counter_.Increment(1ULL);
   }
 
-  if (nullptr != inst) {
-    inst->DecRef();
+  PublishHits();
+  if (nullptr == new_inst) {
+    miss_counter_.Increment(1ULL);
+    new_inst = decoder_->DecodeInstruction(address);
+    if (nullptr == new_inst) {
+      return nullptr;
+    }
   }
 
-  instruction_cache_[indx] = new_inst;
+  InsertIntoSet(base, new_inst);
 
   return new_inst;
 }
 
 void DecodeCache::Invalidate(uint64_t address) {
-  uint64_t entry = (address & address_mask_) >> address_shift_;
-  Instruction* inst = instruction_cache_[entry];
-  if ((nullptr != inst) && (inst->address() == address)) {
-    instruction_cache_[entry]->DecRef();
-    instruction_cache_[entry] = nullptr;
+  uint64_t base = SetBase(address);
+  for (int way = 0; way < num_ways_; ++way) {
+    Instruction* inst = instruction_cache_[base + way];
+    if ((nullptr != inst) && (inst->address() == address)) {
+      inst->DecRef();
+      instruction_cache_[base + way] = nullptr;
+    }
+  }
+  if (num_victim_entries_ > 0) {
+    Instruction* inst = TakeVictim(address);
+    if (nullptr != inst) inst->DecRef();
   }
 }
 
@@ -116,6 +253,12 @@ void DecodeCache::InvalidateAll() {
       instruction_cache_[entry] = nullptr;
     }
   }
+  for (int entry = 0; entry < num_victim_entries_; ++entry) {
+    if (victim_buffer_[entry] != nullptr) {
+      victim_buffer_[entry]->DecRef();
+      victim_buffer_[entry] = nullptr;
+    }
+  }
 }
 
 }  // namespace generic
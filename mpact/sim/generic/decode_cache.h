@@ -17,6 +17,7 @@
 
 #include <cstdint>
 
+#include "mpact/sim/generic/counters.h"
 #include "mpact/sim/generic/decoder_interface.h"
 #include "mpact/sim/generic/instruction.h"
 
@@ -30,17 +31,34 @@ namespace mpact {
 namespace sim {
 namespace generic {
 
+// Replacement policy used when a set of the decode cache is full.
+enum class DecodeCacheReplacement {
+  // Least recently used entry in the set is replaced.
+  kLru,
+  // Clock (second chance) approximation of LRU.
+  kClock,
+};
+
 // This structure contains properties used to configure the decode cache. The
 // minimum number of cached instructions and the minimum possible pc increment.
 // The actual size of the decode cache will be the smallest power of two that
-// is greater or equal to the minimum number of entries. The decode cache is
-// currently only direct mapped, but different organizations may be permitted
-// in the future.
+// is greater or equal to the minimum number of entries. By default the decode
+// cache is direct mapped. It can be made set associative by setting num_ways
+// to a power of two greater than one, in which case the replacement policy is
+// used to select the entry to replace in a set. Optionally, instructions that
+// are replaced can be kept in a small fully associative victim buffer, from
+// which they are moved back into the cache on a subsequent access.
 struct DecodeCacheProperties {
   // Actual size will be the power of two that is >= num_entries.
   uint32_t num_entries;
   // Minimum pc increment should be a power of two.
   uint32_t minimum_pc_increment;
+  // Number of ways per set. Must be a power of two that is <= num_entries.
+  uint32_t num_ways = 1;
+  // Replacement policy used when num_ways is greater than one.
+  DecodeCacheReplacement replacement = DecodeCacheReplacement::kLru;
+  // Number of entries in the victim buffer (0 disables the victim buffer).
+  uint32_t num_victim_entries = 0;
 };
 
 // Instructions are decoded into an internal representation for the simulator.
@@ -55,6 +73,14 @@ struct DecodeCacheProperties {
 // The instructions are reference counted, so while an instruction may be in
 // the process of being executed, its internal representation will not be
 // deleted until the execution completes with a DecRef.
+//
+// The decode cache maintains counters for the number of hits, misses (calls
+// to the decoder), conflicts (misses that replace a valid instruction), and
+// victim buffer hits. These can be added to a Component to be exported with
+// the other simulator statistics, or disabled to remove the (small) overhead
+// of counting. To keep the lookup fast, hits are accumulated in a plain
+// integer and added to the hit counter on the next miss, or when the hit
+// counter is accessed through hit_counter().
 class DecodeCache {
  private:
   // Constructed using static factory method.
@@ -83,17 +109,70 @@ class DecodeCache {
 
   // Accessors.
   int num_entries() const { return num_entries_; }
+  int num_ways() const { return num_ways_; }
+  int num_sets() const { return num_sets_; }
+  int num_victim_entries() const { return num_victim_entries_; }
   uint64_t address_mask() const { return address_mask_; }
   int address_shift() const { return address_shift_; }
   int address_inc() const { return address_inc_; }
 
+  // Statistics counters.
+  SimpleCounter<uint64_t>* hit_counter() {
+    PublishHits();
+    return &hit_counter_;
+  }
+  SimpleCounter<uint64_t>* miss_counter() { return &miss_counter_; }
+  SimpleCounter<uint64_t>* conflict_counter() { return &conflict_counter_; }
+  SimpleCounter<uint64_t>* victim_hit_counter() {
+    return &victim_hit_counter_;
+  }
+
  private:
+  // Returns the index of the first entry of the set for the address.
+  uint64_t SetBase(uint64_t address) const {
+    return ((address & address_mask_) >> address_shift_) << way_shift_;
+  }
+  // Looks up the address in the ways of the set starting at base. Returns the
+  // instruction or nullptr on a miss.
+  Instruction* LookupSet(uint64_t base, uint64_t address);
+  // Looks up the address in the victim buffer, and if found, removes it from
+  // the victim buffer and returns it.
+  Instruction* TakeVictim(uint64_t address);
+  // Inserts the instruction into the set starting at base, replacing an
+  // existing entry if necessary.
+  void InsertIntoSet(uint64_t base, Instruction* inst);
+  // Adds an instruction that was replaced in the cache to the victim buffer.
+  void AddVictim(Instruction* inst);
+  // Adds the hits accumulated since the last call to the hit counter.
+  void PublishHits() {
+    if (pending_hits_ == 0) return;
+    hit_counter_.Increment(pending_hits_);
+    pending_hits_ = 0;
+  }
+
   DecoderInterface* decoder_;
   int num_entries_;
+  int num_ways_;
+  int way_shift_;
+  int num_sets_;
   int address_shift_;
   uint32_t address_inc_;
   uint64_t address_mask_;
+  DecodeCacheReplacement replacement_;
   Instruction** instruction_cache_;
+  // Clock replacement state: reference bits per entry and hand per set.
+  bool* reference_bits_ = nullptr;
+  int* clock_hands_ = nullptr;
+  // Victim buffer managed as a circular FIFO.
+  int num_victim_entries_;
+  int victim_next_ = 0;
+  Instruction** victim_buffer_ = nullptr;
+  // Counters.
+  uint64_t pending_hits_ = 0;
+  SimpleCounter<uint64_t> hit_counter_;
+  SimpleCounter<uint64_t> miss_counter_;
+  SimpleCounter<uint64_t> conflict_counter_;
+  SimpleCounter<uint64_t> victim_hit_counter_;
 };
 
 }  // namespace generic
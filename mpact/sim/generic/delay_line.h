@@ -16,12 +16,11 @@
 #define MPACT_SIM_GENERIC_DELAY_LINE_H_
 
 #include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
 #include <vector>
 
-/* Commented out for now. Not currently using threads.
-#include "absl/base/thread_annotations.h"
-#include "absl/synchronization/mutex.h"
-*/
 #include "absl/numeric/bits.h"
 #include "mpact/sim/generic/delay_line_interface.h"
 
@@ -34,11 +33,14 @@ namespace generic {
 // be scheduled to be performed a number of cycles (calls to Advance()) in
 // the future. The exact action to be performed is determined by the template
 // parameter type DelayRecord. Abstractly, the DelayLine class is a circular
-// buffer of lists of DelayRecords. It is implemented as a vector
-// of vectors of DelayRecord instances. A given index into the first dimension
-// contains a vector of the set of DelayRecord instances that specifies the
+// buffer of lists of DelayRecords (a timing wheel). Each slot of the wheel
+// holds an intrusive singly linked list of the records that specify the
 // "actions" that are performed for a given cycle in the future (based on its
-// distance from the current_ index (mod vector size).
+// distance from the current_ index (mod wheel size). The records are
+// constructed in place in nodes that are taken from a pool owned by the delay
+// line, and returned to the pool once they have been applied, so adding a
+// record does not allocate memory once the pool has grown to cover the
+// maximum number of outstanding records.
 //
 // The DelayLine circular buffer is always a power of two to make the
 // mod operator cheap.
@@ -47,7 +49,8 @@ namespace generic {
 // type as a template argument. The DelayRecord must have a void Apply()
 // method that performs the actions intended once the delay line has advanced
 // to that record. Additionally, the DelayRecord type must have a constructor
-// that can be called by std::vector::emplace_back().
+// that accepts the arguments passed to Add(). Records are never copied or
+// moved once they have been added to the delay line.
 //
 // For instance, if the DelayRecord consists of a pointer and a value (with the
 // intent that after a delay, the value gets written to the object pointed to
@@ -62,7 +65,7 @@ namespace generic {
 //   MyDelayRecord(int *dest, int val) : destination(dest), value(val) {}
 // };
 //
-// This class is thread safe.
+// This class is not thread safe.
 template <typename DelayRecord>
 class DelayLine : public DelayLineInterface {
  public:
@@ -75,21 +78,39 @@ class DelayLine : public DelayLineInterface {
 
   // Default constructor and destructors
   DelayLine() : DelayLine(kDefaultDelayLineDepth) {}
-  ~DelayLine() override = default;
+  DelayLine(const DelayLine&) = delete;
+  DelayLine& operator=(const DelayLine&) = delete;
+  ~DelayLine() override {
+    // Destroy the records that have not been applied.
+    for (auto& slot : delay_line_) {
+      for (Node* node = slot.head; node != nullptr; node = node->next) {
+        node->record()->~DelayRecord();
+      }
+    }
+  }
 
   // Add an item to the delay line with the given latency. The Ts... argument
   // pack is the set of arguments to the constructor of the DelayRecord which
   // is the value record type for the DelayLine. Returns the total number of
   // valid elements.
   template <typename... Ts>
-  int Add(int latency, Ts... args) /*ABSL_LOCKS_EXCLUDED(delay_line_lock_)*/ {
-    // absl::MutexLock dl(&delay_line_lock_);
+  int Add(int latency, Ts&&... args) {
     // If the latency is longer than the delay line, resize the delay line.
     if (latency >= static_cast<int>(delay_line_.size())) {
       Resize(latency);
     }
-    int pos = (latency + current_) & mask_;
-    delay_line_[pos].emplace_back(args...);
+    Node* node = AllocateNode();
+    new (node->storage) DelayRecord(std::forward<Ts>(args)...);
+    node->next = nullptr;
+    // Append the record to preserve the order in which records with the same
+    // latency are applied.
+    Slot& slot = delay_line_[(latency + current_) & mask_];
+    if (slot.head == nullptr) {
+      slot.head = node;
+    } else {
+      slot.tail->next = node;
+    }
+    slot.tail = node;
     return ++num_entries_;
   }
 
@@ -99,55 +120,135 @@ class DelayLine : public DelayLineInterface {
   // instance and calling a function. Additional actions can be created by
   // deriving new delay lines as needed. Returns the number of valid entries
   // left in the delay line.
-  int Advance() override /*ABSL_LOCKS_EXCLUDED(delay_line_lock_)*/ {
-    // absl::MutexLock dl(&delay_line_lock_);
+  int Advance() override {
     current_ = (current_ + 1) & mask_;
-    for (auto& rec : delay_line_[current_]) {
-      rec.Apply();
+    // Detach the list from the slot before applying the records, as applying
+    // a record may add new records to the delay line.
+    Node* node = delay_line_[current_].head;
+    delay_line_[current_].head = nullptr;
+    delay_line_[current_].tail = nullptr;
+    while (node != nullptr) {
+      Node* next = node->next;
+      DelayRecord* record = node->record();
+      record->Apply();
+      record->~DelayRecord();
+      FreeNode(node);
       num_entries_--;
+      node = next;
     }
-    delay_line_[current_].clear();
     return num_entries_;
   }
 
+  // Advances the delay line by the given number of cycles. The cycles between
+  // the slots that contain records are skipped without being visited.
+  void AdvanceBy(int cycles) override {
+    while (cycles > 0) {
+      int next = CyclesToNextEvent();
+      if (next > cycles) {
+        current_ = (current_ + (cycles & mask_)) & mask_;
+        return;
+      }
+      current_ = (current_ + next - 1) & mask_;
+      Advance();
+      cycles -= next;
+    }
+  }
+
+  // Returns the distance to the first non-empty slot following the current
+  // one, or kNoEvent if the delay line is empty.
+  int CyclesToNextEvent() const override {
+    if (num_entries_ == 0) return kNoEvent;
+    int size = delay_line_.size();
+    for (int offset = 1; offset <= size; ++offset) {
+      if (delay_line_[(current_ + offset) & mask_].head != nullptr) {
+        return offset;
+      }
+    }
+    return kNoEvent;
+  }
+
   // Returns true if the delay line is empty.
   bool IsEmpty() const override { return num_entries_ == 0; }
 
  private:
+  // Pool allocated list node with in place storage for a record.
+  struct Node {
+    Node* next;
+    alignas(DelayRecord) unsigned char storage[sizeof(DelayRecord)];
+
+    DelayRecord* record() {
+      return std::launder(reinterpret_cast<DelayRecord*>(storage));
+    }
+  };
+
+  // A slot in the timing wheel.
+  struct Slot {
+    Node* head = nullptr;
+    Node* tail = nullptr;
+  };
+
+  // Number of nodes allocated at a time when the pool is empty.
+  static constexpr int kNodesPerChunk = 64;
+
+  Node* AllocateNode() {
+    if (free_list_ == nullptr) {
+      auto chunk = std::make_unique<Node[]>(kNodesPerChunk);
+      for (int i = 0; i < kNodesPerChunk; ++i) {
+        chunk[i].next = free_list_;
+        free_list_ = &chunk[i];
+      }
+      chunks_.push_back(std::move(chunk));
+    }
+    Node* node = free_list_;
+    free_list_ = node->next;
+    return node;
+  }
+
+  void FreeNode(Node* node) {
+    node->next = free_list_;
+    free_list_ = node;
+  }
+
   // If the latency is >= the delay line length, the delay line has to be
   // resized so the latency is covered.
-  void Resize(
-      uint32_t min_size) /*ABSL_EXCLUSIVE_LOCKS_REQUIRED(delay_line_lock_)*/ {
-    // Compute a new size that's >= min_size and is a power of 2
-    // Given that the initial size is a power of two, multiplying the
-    // current size by two until it's greater or equal to min_size is
-    // sufficient.
+  void Resize(uint32_t min_size) {
     uint32_t prev_size = delay_line_.size();
 
     if (min_size < prev_size) {
       return;
     }
 
-    uint32_t new_size = absl::bit_ceil(min_size);
+    // The new size has to be strictly greater than min_size. Otherwise a
+    // min_size equal to prev_size (Add() resizes when the latency is equal to
+    // the length) wouldn't grow the delay line. Since min_size is at least
+    // prev_size, the size is at least doubled, which leaves room to move the
+    // slots below.
+    uint32_t new_size = absl::bit_ceil(min_size + 1);
 
     mask_ = new_size - 1;
     delay_line_.resize(new_size);
 
-    // now need to move elements from 0 to current-1 to new locations.
-    for (int index = 0; index < current_; ++index) {
-      if (!delay_line_[index].empty()) {
+    // The slots from 0 to current_ hold the records that wrapped around the
+    // end of the previous delay line, so they are moved by prev_size to keep
+    // their distance from current_. This includes the current slot, which
+    // holds records that are applied prev_size cycles from now (i.e., records
+    // added with zero latency after the slot was processed). Only the list
+    // heads and tails are moved, not the records.
+    for (int index = 0; index <= current_; ++index) {
+      if (delay_line_[index].head != nullptr) {
         delay_line_[prev_size + index] = delay_line_[index];
-        delay_line_[index].clear();
+        delay_line_[index] = Slot();
       }
     }
   }
 
-  std::vector<std::vector<DelayRecord>> delay_line_;
-  /*ABSL_GUARDED_BY(delay_line_lock_)*/
-  int current_ /*ABSL_GUARDED_BY(delay_line_lock_)*/;
-  int mask_ /*ABSL_GUARDED_BY(delay_line_lock_)*/;
-  /*absl::Mutex delay_line_lock_;*/
+  std::vector<Slot> delay_line_;
+  int current_;
+  int mask_;
   uint32_t num_entries_;
+  // Pool of list nodes.
+  Node* free_list_ = nullptr;
+  std::vector<std::unique_ptr<Node[]>> chunks_;
 };
 
 }  // namespace generic
@@ -19,15 +19,30 @@
 // all the created (and registered) delay lines without regards to the
 // records in the delay line or the actual Apply() action.
 
+#include <limits>
+
 namespace mpact {
 namespace sim {
 namespace generic {
 
 class DelayLineInterface {
  public:
+  // Value returned by CyclesToNextEvent() when the delay line is empty.
+  static constexpr int kNoEvent = std::numeric_limits<int>::max();
+
   virtual ~DelayLineInterface() = default;
   // Advances the delay line and returns the number of valid elements remaining.
   virtual int Advance() = 0;
+  // Advances the delay line by the given number of cycles, performing any
+  // actions that become due in order. The default implementation calls
+  // Advance() once per cycle until the delay line is empty.
+  virtual void AdvanceBy(int cycles) {
+    for (int i = 0; (i < cycles) && !IsEmpty(); i++) Advance();
+  }
+  // Returns the number of calls to Advance() until the next call that performs
+  // an action, or kNoEvent if the delay line is empty. The default
+  // implementation returns 1 if the delay line is not empty.
+  virtual int CyclesToNextEvent() const { return IsEmpty() ? kNoEvent : 1; }
   // Return true if the delay line is empty.
   virtual bool IsEmpty() const = 0;
 };
@@ -73,6 +73,7 @@ class DevNullOperand : public DestinationOperandInterface {
   std::any GetObject() const override { return std::any(); }
   // Accessor.
   std::vector<int> shape() const override { return shape_; }
+  int extent(int dimension) const override { return shape_[dimension]; }
 
   std::string AsString() const override { return string_value_; }
 
@@ -0,0 +1,251 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mpact/sim/generic/external_event_log.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+
+namespace mpact {
+namespace sim {
+namespace generic {
+
+namespace {
+
+// Magic number and version at the start of the log.
+constexpr char kHeader[] = {'M', 'P', 'E', 'V', 1};
+// Largest data size accepted when reading a record.
+constexpr uint64_t kMaxDataSize = 1ULL << 32;
+
+}  // namespace
+
+ExternalEventWriter::ExternalEventWriter(std::ostream* out) : out_(out) {
+  out_->write(kHeader, sizeof(kHeader));
+}
+
+void ExternalEventWriter::Write(const ExternalEvent& event) {
+  out_->put(static_cast<char>(event.type));
+  if (event.type != ExternalEventType::kLoad) {
+    WriteVarint(event.time - last_time_);
+    last_time_ = event.time;
+  }
+  WriteVarint(event.address);
+  WriteVarint(event.value);
+  WriteVarint(event.data.size());
+  out_->write(event.data.data(), event.data.size());
+}
+
+void ExternalEventWriter::WriteLoad(uint64_t address, const void* data,
+                                    size_t size) {
+  ExternalEvent event;
+  event.type = ExternalEventType::kLoad;
+  event.address = address;
+  event.data.assign(static_cast<const char*>(data), size);
+  Write(event);
+}
+
+void ExternalEventWriter::WriteIrq(uint64_t time, int32_t irq_number,
+                                   bool value) {
+  ExternalEvent event;
+  event.type = ExternalEventType::kIrq;
+  event.time = time;
+  event.address = static_cast<uint32_t>(irq_number);
+  event.value = value;
+  Write(event);
+}
+
+void ExternalEventWriter::WriteMemoryWrite(uint64_t time, uint64_t address,
+                                           const void* data, size_t size) {
+  ExternalEvent event;
+  event.type = ExternalEventType::kMemoryWrite;
+  event.time = time;
+  event.address = address;
+  event.data.assign(static_cast<const char*>(data), size);
+  Write(event);
+}
+
+void ExternalEventWriter::WriteRegisterWrite(uint64_t time, uint32_t reg_id,
+                                             uint64_t value) {
+  ExternalEvent event;
+  event.type = ExternalEventType::kRegisterWrite;
+  event.time = time;
+  event.address = reg_id;
+  event.value = value;
+  Write(event);
+}
+
+void ExternalEventWriter::WriteAddCachedRange(uint64_t time, uint64_t base,
+                                              uint64_t size, bool write_back) {
+  ExternalEvent event;
+  event.type = ExternalEventType::kAddCachedRange;
+  event.time = time;
+  event.address = base;
+  event.value = size;
+  event.data.assign(1, write_back ? 1 : 0);
+  Write(event);
+}
+
+void ExternalEventWriter::WriteFlushMemory(uint64_t time, uint64_t address,
+                                           uint64_t length) {
+  ExternalEvent event;
+  event.type = ExternalEventType::kFlushMemory;
+  event.time = time;
+  event.address = address;
+  event.value = length;
+  Write(event);
+}
+
+void ExternalEventWriter::WriteInvalidateMemory(uint64_t time, uint64_t address,
+                                                uint64_t length) {
+  ExternalEvent event;
+  event.type = ExternalEventType::kInvalidateMemory;
+  event.time = time;
+  event.address = address;
+  event.value = length;
+  Write(event);
+}
+
+// LEB128 encoding: 7 bits per byte, least significant first, with the top bit
+// set in all but the last byte.
+void ExternalEventWriter::WriteVarint(uint64_t value) {
+  char buffer[10];
+  int len = 0;
+  while (value >= 0x80) {
+    buffer[len++] = static_cast<char>((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  buffer[len++] = static_cast<char>(value);
+  out_->write(buffer, len);
+}
+
+ExternalEventReader::ExternalEventReader(std::istream* in) : in_(in) {}
+
+absl::StatusOr<ExternalEvent> ExternalEventReader::NextLoad() {
+  ExternalEvent event;
+  auto res = ReadRecord(Cursor::kLoad, event);
+  if (!res.ok()) return res.status();
+  if (!res.value()) return absl::NotFoundError("No more loads in the log");
+  return event;
+}
+
+absl::StatusOr<const ExternalEvent*> ExternalEventReader::PeekEvent() {
+  if (!next_event_.has_value()) {
+    ExternalEvent event;
+    auto res = ReadRecord(Cursor::kEvent, event);
+    if (!res.ok()) return res.status();
+    if (!res.value()) return nullptr;
+    next_event_ = std::move(event);
+  }
+  return &next_event_.value();
+}
+
+void ExternalEventReader::PopEvent() { next_event_.reset(); }
+
+absl::Status ExternalEventReader::SetCursor(Cursor cursor) {
+  if (!header_read_) {
+    char header[sizeof(kHeader)];
+    in_->read(header, sizeof(header));
+    if ((static_cast<size_t>(in_->gcount()) != sizeof(header)) ||
+        !std::equal(header, header + sizeof(header), kHeader)) {
+      return absl::InvalidArgumentError("Invalid external event log header");
+    }
+    other_pos_ = in_->tellg();
+    if (other_pos_ == std::istream::pos_type(-1)) {
+      return absl::InvalidArgumentError("External event log is not seekable");
+    }
+    header_read_ = true;
+  }
+  if (cursor == cursor_) return absl::OkStatus();
+  // Clear any end of file state before saving the position.
+  in_->clear();
+  auto pos = in_->tellg();
+  in_->seekg(other_pos_);
+  if ((pos == std::istream::pos_type(-1)) || !in_->good()) {
+    return absl::InternalError("Failed to reposition external event log");
+  }
+  other_pos_ = pos;
+  cursor_ = cursor;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<bool> ExternalEventReader::ReadRecord(Cursor cursor,
+                                                     ExternalEvent& event) {
+  auto status = SetCursor(cursor);
+  if (!status.ok()) return status;
+  while (true) {
+    int type = in_->get();
+    if (type == std::istream::traits_type::eof()) return false;
+    if (type > static_cast<int>(ExternalEventType::kInvalidateMemory)) {
+      return absl::InternalError("Invalid external event type");
+    }
+    bool is_load = static_cast<ExternalEventType>(type) ==
+                   ExternalEventType::kLoad;
+    bool wanted = is_load == (cursor == Cursor::kLoad);
+    uint64_t time = 0;
+    if (!is_load) {
+      uint64_t delta;
+      if (!ReadVarint(delta)) return absl::InternalError("Truncated event");
+      time = last_time_ + delta;
+    }
+    uint64_t address;
+    uint64_t value;
+    uint64_t size;
+    if (!ReadVarint(address) || !ReadVarint(value) || !ReadVarint(size)) {
+      return absl::InternalError("Truncated event");
+    }
+    if (size > kMaxDataSize) return absl::InternalError("Invalid data size");
+    if (!wanted) {
+      // Skip the data of records read by the other cursor.
+      in_->ignore(size);
+      if (static_cast<uint64_t>(in_->gcount()) != size) {
+        return absl::InternalError("Truncated event");
+      }
+      continue;
+    }
+    event.type = static_cast<ExternalEventType>(type);
+    event.time = time;
+    event.address = address;
+    event.value = value;
+    event.data.resize(size);
+    in_->read(event.data.data(), size);
+    if (static_cast<uint64_t>(in_->gcount()) != size) {
+      return absl::InternalError("Truncated event");
+    }
+    if (!is_load) last_time_ = time;
+    return true;
+  }
+}
+
+bool ExternalEventReader::ReadVarint(uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int byte = in_->get();
+    if (byte == std::istream::traits_type::eof()) return false;
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) return true;
+  }
+  return false;
+}
+
+}  // namespace generic
+}  // namespace sim
+}  // namespace mpact
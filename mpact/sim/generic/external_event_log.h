@@ -0,0 +1,158 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MPACT_SIM_GENERIC_EXTERNAL_EVENT_LOG_H_
+#define MPACT_SIM_GENERIC_EXTERNAL_EVENT_LOG_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+
+// This file declares classes used to record the external inputs of a
+// simulation, i.e., data and events that originate outside the simulated core,
+// into a compact binary log, and to read them back, so that the simulation can
+// be replayed deterministically without the external environment.
+//
+// There are two kinds of events. Loads record the data returned from memory or
+// devices outside the simulator. They are replayed in program order, so no time
+// is recorded for them. All other events (interrupts, debug writes, memory
+// cache operations) occur between steps of the simulated core, and are
+// recorded with the number of instructions executed at the time, so that they
+// can be reapplied at the same point of execution.
+//
+// The log starts with a header, followed by a sequence of records:
+//   type:    1 byte.
+//   time:    varint, delta from the time of the previous timed event. Not
+//            present for loads.
+//   address: varint.
+//   value:   varint.
+//   size:    varint, followed by size bytes of data.
+
+namespace mpact {
+namespace sim {
+namespace generic {
+
+enum class ExternalEventType : uint8_t {
+  // Data returned by a load from outside the simulator.
+  kLoad = 0,
+  // Interrupt line value change. The address is the irq number.
+  kIrq = 1,
+  // Memory write through the debug interface.
+  kMemoryWrite = 2,
+  // Register write through the debug interface. The address is the register
+  // id.
+  kRegisterWrite = 3,
+  // Caching enabled for an address range. The value is the size of the range,
+  // and the data is a single byte that is non-zero for write back caching.
+  kAddCachedRange = 4,
+  // Modified cached data written back. The value is the length of the range.
+  kFlushMemory = 5,
+  // Cached data dropped. The value is the length of the range.
+  kInvalidateMemory = 6,
+};
+
+struct ExternalEvent {
+  ExternalEventType type = ExternalEventType::kLoad;
+  // Instruction count at which the event occurred. Unused for loads.
+  uint64_t time = 0;
+  uint64_t address = 0;
+  uint64_t value = 0;
+  // Load or memory write data.
+  std::string data;
+};
+
+class ExternalEventWriter {
+ public:
+  // The output stream is not owned, and must outlive the writer.
+  explicit ExternalEventWriter(std::ostream* out);
+  ExternalEventWriter(const ExternalEventWriter&) = delete;
+  ExternalEventWriter& operator=(const ExternalEventWriter&) = delete;
+
+  // Append the event to the log. Timed events must be written in time order.
+  void Write(const ExternalEvent& event);
+  // Convenience methods.
+  void WriteLoad(uint64_t address, const void* data, size_t size);
+  void WriteIrq(uint64_t time, int32_t irq_number, bool value);
+  void WriteMemoryWrite(uint64_t time, uint64_t address, const void* data,
+                        size_t size);
+  void WriteRegisterWrite(uint64_t time, uint32_t reg_id, uint64_t value);
+  void WriteAddCachedRange(uint64_t time, uint64_t base, uint64_t size,
+                           bool write_back);
+  void WriteFlushMemory(uint64_t time, uint64_t address, uint64_t length);
+  void WriteInvalidateMemory(uint64_t time, uint64_t address, uint64_t length);
+  void Flush() { out_->flush(); }
+
+ private:
+  void WriteVarint(uint64_t value);
+
+  std::ostream* out_;
+  uint64_t last_time_ = 0;
+};
+
+// Loads and timed events are read from the log through two independent read
+// positions, so that peeking at the next timed event does not buffer the loads
+// that precede it, and vice versa. The stream is only repositioned when
+// switching between reading loads and reading timed events.
+class ExternalEventReader {
+ public:
+  // The input stream is not owned, must outlive the reader, and must be
+  // seekable.
+  explicit ExternalEventReader(std::istream* in);
+  ExternalEventReader(const ExternalEventReader&) = delete;
+  ExternalEventReader& operator=(const ExternalEventReader&) = delete;
+
+  // Returns the next load event. Returns a NotFound error at the end of the
+  // log.
+  absl::StatusOr<ExternalEvent> NextLoad();
+  // Returns the next timed event without consuming it, or nullptr at the end of
+  // the log. The pointer is valid until the next call to the reader.
+  absl::StatusOr<const ExternalEvent*> PeekEvent();
+  // Consumes the event returned by PeekEvent().
+  void PopEvent();
+
+ private:
+  enum class Cursor { kLoad, kEvent };
+
+  // Reads the header if needed, and positions the stream at the read position
+  // of the given cursor.
+  absl::Status SetCursor(Cursor cursor);
+  // Reads the next load (if cursor is kLoad) or timed event into event,
+  // skipping over the records of the other kind. Returns false at the end of
+  // the log.
+  absl::StatusOr<bool> ReadRecord(Cursor cursor, ExternalEvent& event);
+  bool ReadVarint(uint64_t& value);
+
+  std::istream* in_;
+  bool header_read_ = false;
+  // The cursor that the stream is positioned for, and the saved read position
+  // of the other one.
+  Cursor cursor_ = Cursor::kLoad;
+  std::istream::pos_type other_pos_;
+  // Time of the most recent timed event read.
+  uint64_t last_time_ = 0;
+  // The timed event returned by PeekEvent(), if not yet consumed.
+  std::optional<ExternalEvent> next_event_;
+};
+
+}  // namespace generic
+}  // namespace sim
+}  // namespace mpact
+
+#endif  // MPACT_SIM_GENERIC_EXTERNAL_EVENT_LOG_H_
@@ -76,6 +76,7 @@ class FifoSourceOperand : public SourceOperandInterface {
 
   // Returns the shape of the fifo elements.
   std::vector<int> shape() const override;
+  int extent(int dimension) const override;
 
   std::string AsString() const override { return op_name_; }
 
@@ -118,6 +119,7 @@ class FifoDestinationOperand : public DestinationOperandInterface {
   // each dimension). For instance {0} indicates a scalar quantity, whereas
   // {128} indicates an 128 element vector quantity.
   std::vector<int> shape() const override;
+  int extent(int dimension) const override;
 
   std::string AsString() const override { return op_name_; }
 
@@ -250,6 +252,11 @@ std::vector<int> FifoSourceOperand<T, Enable>::shape() const {
   return fifo_->shape();
 }
 
+template <typename T, typename Enable>
+int FifoSourceOperand<T, Enable>::extent(int dimension) const {
+  return fifo_->shape()[dimension];
+}
+
 // Helper templates for the partial specialiations below.
 template <typename T>
 using EnableIfIntegral =
@@ -326,6 +333,7 @@ class FifoSourceOperand<T, EnableIfIntegral<T>>
 
   // Returns the shape of the fifo elements.
   std::vector<int> shape() const override { return fifo_->shape(); }
+  int extent(int dimension) const override { return fifo_->shape()[dimension]; }
 
   std::string AsString() const override { return op_name_; }
 
@@ -370,6 +378,7 @@ class FifoSourceOperand<T, EnableIfNotIntegral<T>>
 
   // Returns the shape of the fifo elements.
   std::vector<int> shape() const override { return fifo_->shape(); }
+  int extent(int dimension) const override { return fifo_->shape()[dimension]; }
 
  private:
   FifoBase* fifo_;
@@ -408,6 +417,11 @@ std::vector<int> FifoDestinationOperand<T>::shape() const {
   return fifo_->shape();
 }
 
+template <typename T>
+int FifoDestinationOperand<T>::extent(int dimension) const {
+  return fifo_->shape()[dimension];
+}
+
 }  // namespace generic
 }  // namespace sim
 }  // namespace mpact
@@ -19,7 +19,9 @@
 // function a number of cycles (advances of the delay line) into the future. See
 // delay_line_base.h for the interface to the delay line.
 
-#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 #include "mpact/sim/generic/delay_line.h"
 
@@ -27,21 +29,51 @@ namespace mpact {
 namespace sim {
 namespace generic {
 
-// The delay record stores the handle to the function to be executed in the
-// delay line and implements an Apply() method used by the DelayLine to
-// call the stored function.
+// The delay record stores the function to be executed in the delay line and
+// implements an Apply() method used by the DelayLine to call the stored
+// function. Callables of up to kInlineSize bytes (e.g., lambdas capturing a
+// few pointers) are stored in the record itself, so that adding a function to
+// the delay line does not allocate memory. Larger callables are stored on the
+// heap.
 
 class FunctionDelayRecord {
  public:
-  void Apply() { fcn_(); }
+  // The inline storage size is chosen so that the record and the delay line
+  // list pointer fit in a 64 byte cache line.
+  static constexpr int kInlineSize = 40;
+
+  void Apply() { invoke_(storage_); }
   // No default constructor - only use constructor that initializes the record
   FunctionDelayRecord() = delete;
+  FunctionDelayRecord(const FunctionDelayRecord&) = delete;
+  FunctionDelayRecord& operator=(const FunctionDelayRecord&) = delete;
+
+  template <typename F>
+  explicit FunctionDelayRecord(F&& fcn) {
+    using Fcn = std::decay_t<F>;
+    if constexpr (IsInline<Fcn>()) {
+      new (storage_) Fcn(std::forward<F>(fcn));
+      invoke_ = [](void* storage) { (*static_cast<Fcn*>(storage))(); };
+      destroy_ = [](void* storage) { static_cast<Fcn*>(storage)->~Fcn(); };
+    } else {
+      *reinterpret_cast<Fcn**>(storage_) = new Fcn(std::forward<F>(fcn));
+      invoke_ = [](void* storage) { (**static_cast<Fcn**>(storage))(); };
+      destroy_ = [](void* storage) { delete *static_cast<Fcn**>(storage); };
+    }
+  }
+
+  ~FunctionDelayRecord() { destroy_(storage_); }
 
+  // Returns true if a callable of type F is stored in the record itself.
   template <typename F>
-  explicit FunctionDelayRecord(F fcn) : fcn_(fcn) {}
+  static constexpr bool IsInline() {
+    return (sizeof(F) <= kInlineSize) && (alignof(F) <= alignof(void*));
+  }
 
  private:
-  std::function<void()> fcn_;
+  void (*invoke_)(void*);
+  void (*destroy_)(void*);
+  alignas(void*) unsigned char storage_[kInlineSize];
 };
 
 using FunctionDelayLine = DelayLine<FunctionDelayRecord>;
@@ -67,6 +67,7 @@ class ImmediateOperand : public SourceOperandInterface {
   // simplified by not allowing an empty vector. Therefore, a 1 dimensional
   // vector shape with dimension size 1 used for a scalar shape.
   std::vector<int> shape() const override { return shape_; }
+  int extent(int dimension) const override { return shape_[dimension]; }
 
   std::string AsString() const override { return as_string_; }
 
@@ -108,6 +109,7 @@ class VectorImmediateOperand : public SourceOperandInterface {
   // For instance {1} indicates a scalar quantity, whereas {128} indicates an
   // 128 element vector quantity.
   std::vector<int> shape() const override { return shape_; }
+  int extent(int dimension) const override { return shape_[dimension]; }
 
   std::string AsString() const override {
     return absl::StrCat("[", value_[0], "...", value_.back(), "]");
@@ -20,6 +20,7 @@
 
 #include "absl/types/span.h"
 #include "mpact/sim/generic/arch_state.h"
+#include "mpact/sim/generic/instruction_arena.h"
 #include "mpact/sim/generic/operand_interface.h"
 #include "mpact/sim/generic/resource_operand_interface.h"  // IWYU pragma: keep
 
@@ -66,7 +67,9 @@ int Instruction::DestinationsSize() const { return dests_.size(); }
 
 Instruction::Instruction(uint64_t address, ArchState* state)
     : predicate_(nullptr),
+      size_(0),
       address_(address),
+      opcode_(0),
       state_(state),
       context_(nullptr),
       child_(nullptr),
@@ -75,9 +78,29 @@ Instruction::Instruction(uint64_t address, ArchState* state)
 
 Instruction::Instruction(ArchState* state) : Instruction(0, state) {}
 
-Instruction::~Instruction() {
+Instruction::~Instruction() { Release(); }
+
+Instruction* Instruction::Create(uint64_t address, ArchState* state) {
+  if ((state != nullptr) && (state->instruction_arena() != nullptr)) {
+    return state->instruction_arena()->Allocate(address, state);
+  }
+  return new Instruction(address, state);
+}
+
+void Instruction::OnRefCountIsZero() {
+  if (arena_ != nullptr) {
+    arena_->Recycle(this);
+    return;
+  }
+  delete this;
+}
+
+void Instruction::Release() {
   delete[] attribute_array_;
+  attribute_array_ = nullptr;
+  attributes_ = absl::MakeConstSpan(static_cast<int*>(nullptr), 0);
   delete predicate_;
+  predicate_ = nullptr;
   for (auto* op : sources_) {
     delete op;
   }
@@ -97,6 +120,7 @@ Instruction::~Instruction() {
   if (parent_ != nullptr) {
     // remove reference to this from the parent
     parent_->child_ = nullptr;
+    parent_ = nullptr;
   }
   if (next_ != nullptr) {
     next_->DecRef();
@@ -109,10 +133,43 @@ Instruction::~Instruction() {
   }
 }
 
-std::string Instruction::AsString() const { return disasm_string_; }
+void Instruction::Reset(uint64_t address, ArchState* state) {
+  // The operand vectors were cleared when the instruction was released.
+  size_ = 0;
+  address_ = address;
+  opcode_ = 0;
+  disasm_string_.clear();
+  disasm_fcn_ = nullptr;
+  state_ = state;
+  context_ = nullptr;
+  semantic_fcn_ptr_ = &Instruction::CallSemanticFunction;
+  semantic_fcn_ = nullptr;
+  ResetCounts();
+}
+
+void Instruction::set_semantic_function(
+    const PreboundSemanticFunction& semantic_fcn) {
+  if (semantic_fcn.function_ptr() != nullptr) {
+    semantic_fcn_ptr_ = semantic_fcn.function_ptr();
+    semantic_fcn_ = nullptr;
+    return;
+  }
+  semantic_fcn_ptr_ = &Instruction::CallSemanticFunction;
+  semantic_fcn_ = semantic_fcn.function();
+}
+
+std::string Instruction::AsString() const {
+  if (disasm_fcn_ != nullptr) {
+    auto disasm_fcn = disasm_fcn_;
+    disasm_fcn_ = nullptr;
+    // The disassembly function only sets the disassembly string.
+    disasm_fcn(const_cast<Instruction*>(this));
+  }
+  return disasm_string_;
+}
 
 void Instruction::SetAttributes(absl::Span<const int> attributes) {
-  delete attribute_array_;
+  delete[] attribute_array_;
   attribute_array_ = new int[attributes.size()];
   std::memcpy(attribute_array_, attributes.data(),
               attributes.size() * sizeof(int));
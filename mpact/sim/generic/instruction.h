@@ -18,9 +18,10 @@
 #include <cstdint>
 #include <functional>
 #include <string>
+#include <type_traits>
 #include <utility>
-#include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/numeric/int128.h"
 #include "absl/types/span.h"
 #include "mpact/sim/generic/arch_state.h"
@@ -32,8 +33,55 @@ namespace mpact {
 namespace sim {
 namespace generic {
 
+class Instruction;
+class InstructionArena;
 class ResourceOperandInterface;
 
+// Holder for an instruction semantic function as it is stored by a decoder
+// before being bound to an Instruction instance. Plain function pointers and
+// captureless lambdas (as well as std::function objects that wrap a plain
+// function pointer) are kept as raw function pointers, so that the instruction
+// dispatches to them without going through the std::function type erasure.
+// Any other callable (e.g., absl::bind_front results, lambdas with captures) is
+// stored in a std::function.
+class PreboundSemanticFunction {
+ public:
+  using FunctionPtr = void (*)(Instruction*);
+  using Function = std::function<void(Instruction*)>;
+
+  PreboundSemanticFunction() = default;
+  // Implicit conversion from any callable that is convertible to
+  // std::function<void(Instruction *)>. This allows initializer lists of
+  // semantic functions to be written the same way as for std::function.
+  template <typename F,
+            typename = std::enable_if_t<
+                !std::is_same_v<std::decay_t<F>, PreboundSemanticFunction>>>
+  PreboundSemanticFunction(F callable) {  // NOLINT: implicit by design.
+    if constexpr (std::is_convertible_v<F, FunctionPtr>) {
+      function_ptr_ = static_cast<FunctionPtr>(callable);
+    } else if constexpr (std::is_same_v<std::decay_t<F>, Function>) {
+      auto* target = callable.template target<FunctionPtr>();
+      if ((target != nullptr) && (*target != nullptr)) {
+        function_ptr_ = *target;
+      } else {
+        function_ = std::move(callable);
+      }
+    } else {
+      function_ = Function(std::move(callable));
+    }
+  }
+
+  // Returns the function pointer if the callable is a plain function,
+  // nullptr otherwise.
+  FunctionPtr function_ptr() const { return function_ptr_; }
+  // Returns the type erased callable. Empty if function_ptr() is not nullptr.
+  const Function& function() const { return function_; }
+
+ private:
+  FunctionPtr function_ptr_ = nullptr;
+  Function function_;
+};
+
 // This is the class used to as the internal simulator representation of a
 // target architecture instruction or a component operation of such an
 // instruction. An example would be the individual operations of a VLIW
@@ -88,12 +136,37 @@ class Instruction : public ReferenceCount {
  public:
   // Type Alias for the semantic function.
   using SemanticFunction = std::function<void(Instruction*)>;
+  // Type alias for a semantic function that is a plain function pointer.
+  using SemanticFunctionPtr = void (*)(Instruction*);
+  // Type alias for the function that sets the disassembly string.
+  using DisassemblyFunction = void (*)(Instruction*);
+  // Operand storage. Most instructions have only a few operands of each kind,
+  // so these are stored inline in the instruction, avoiding heap allocations
+  // and extra pointer indirections when operands are accessed.
+  static constexpr int kInlineSources = 4;
+  static constexpr int kInlineDestinations = 2;
+  static constexpr int kInlineResources = 2;
+  using SourceVector =
+      absl::InlinedVector<SourceOperandInterface*, kInlineSources>;
+  using DestinationVector =
+      absl::InlinedVector<DestinationOperandInterface*, kInlineDestinations>;
+  using ResourceVector =
+      absl::InlinedVector<ResourceOperandInterface*, kInlineResources>;
 
   // Constructors and Destructors.
   explicit Instruction(ArchState* state);
   Instruction(uint64_t address, ArchState* state);
   ~Instruction() override;
 
+  // Returns a new instruction. If the state has an instruction arena, the
+  // instruction is allocated from the arena, otherwise it is allocated with
+  // new. Either way, the instruction is released by DecRef().
+  static Instruction* Create(uint64_t address, ArchState* state);
+
+  // When the reference count is zero, the instruction is recycled by the arena
+  // it was allocated from, if any, otherwise it is deleted.
+  void OnRefCountIsZero() override;
+
   // Appends the instruction to the "next" list of instructions.
   void Append(Instruction* inst);
   // Appends the instruction the "child" list of instructions.
@@ -115,11 +188,11 @@ class Instruction : public ReferenceCount {
   // modifying the interface for all operands.
   void Execute(ReferenceCount* context) {
     context_ = context;
-    semantic_fcn_(this);
+    semantic_fcn_ptr_(this);
     context_ = nullptr;
   }
   // Execute the instruction without context (context_ remains nullptr).
-  void Execute() { semantic_fcn_(this); }
+  void Execute() { semantic_fcn_ptr_(this); }
 
   // Accessors (getters/setters).
   ReferenceCount* context() const { return context_; }
@@ -137,9 +210,18 @@ class Instruction : public ReferenceCount {
   void set_size(int sz) { size_ = sz; }
   // Sets the semantic function callable - typically only used by the decoder.
   // The callable must be convertible to std::function<void(Instruction *)>.
+  // Plain functions and captureless lambdas are called directly through a
+  // function pointer when the instruction is executed, other callables are
+  // called through a std::function.
   template <typename F>
   void set_semantic_function(F callable) {
-    semantic_fcn_ = SemanticFunction(callable);
+    set_semantic_function(PreboundSemanticFunction(std::move(callable)));
+  }
+  void set_semantic_function(const PreboundSemanticFunction& semantic_fcn);
+  // Returns true if the semantic function is called directly through a
+  // function pointer.
+  bool has_direct_semantic_function() const {
+    return semantic_fcn_ptr_ != &Instruction::CallSemanticFunction;
   }
 
   // PredicateOperand interface used for those ISAs that implement
@@ -158,7 +240,7 @@ class Instruction : public ReferenceCount {
   int DestinationsSize() const;
 
   // Hold ResourceOperand interfaces for the instruction.
-  inline std::vector<ResourceOperandInterface*>& ResourceHold() {
+  inline ResourceVector& ResourceHold() {
     return resource_hold_;
   }
   inline void AppendResourceHold(ResourceOperandInterface* op) {
@@ -166,7 +248,7 @@ class Instruction : public ReferenceCount {
   }
 
   // Acquire ResourceOperand interfaces for the instruction.
-  inline std::vector<ResourceOperandInterface*>& ResourceAcquire() {
+  inline ResourceVector& ResourceAcquire() {
     return resource_acquire_;
   }
   inline void AppendResourceAcquire(ResourceOperandInterface* op) {
@@ -175,6 +257,14 @@ class Instruction : public ReferenceCount {
 
   void SetDisassemblyString(std::string disasm) {
     disasm_string_ = std::move(disasm);
+    disasm_fcn_ = nullptr;
+  }
+  // Sets a function that produces the disassembly string (by calling
+  // SetDisassemblyString()). The function is called on the first call to
+  // AsString(), so that the cost of generating the disassembly string is only
+  // incurred for instructions that are traced or inspected.
+  void SetDisassemblyFunction(DisassemblyFunction disasm_fcn) {
+    disasm_fcn_ = disasm_fcn;
   }
 
   virtual std::string AsString() const;
@@ -187,26 +277,29 @@ class Instruction : public ReferenceCount {
  private:
   // Instruction operands.
   PredicateOperandInterface* predicate_ = nullptr;
-  std::vector<SourceOperandInterface*> sources_;
-  std::vector<DestinationOperandInterface*> dests_;
+  SourceVector sources_;
+  DestinationVector dests_;
 
   // The resources that must be available in order to issue the instruction.
   // This includes any registers that are read.
-  std::vector<ResourceOperandInterface*> resource_hold_;
+  ResourceVector resource_hold_;
   // The resources that must be reserved/acquired by the instruction. Each
   // vector element is a set of resources that are acquired when the instruction
   // issues. The method Acquire() should be called on each element of the
   // vector. The operands should contain all registers and other resources that
   // that need to be reserved for writing.
-  std::vector<ResourceOperandInterface*> resource_acquire_;
+  ResourceVector resource_acquire_;
   // Simulated instruction size.
   int size_;
   // Simulated instruction address.
   uint64_t address_;
   // Integer value of the opcode enum.
   int opcode_;
-  // Text string of disassembly of the instruction.
-  std::string disasm_string_;
+  // Text string of disassembly of the instruction. It is mutable as it may be
+  // generated lazily by AsString().
+  mutable std::string disasm_string_;
+  // Function used to generate the disassembly string on demand.
+  mutable DisassemblyFunction disasm_fcn_ = nullptr;
   // Optional integer attribute array. This allows the decoder to create and
   // store a set of different attributes in the instruction. This is implemented
   // as absl::Span<int> so it can be used as an array of integer attributes
@@ -221,7 +314,26 @@ class Instruction : public ReferenceCount {
   ArchState* state_;
   // Instruction execution context (this is usually nullptr).
   ReferenceCount* context_;
-  // Semantic function that implements the instruction semantics.
+  friend class InstructionArena;
+
+  // Releases the operands and the references to other instructions held by
+  // the instruction. Called by the destructor and when the instruction is
+  // recycled.
+  void Release();
+  // Reinitializes a recycled instruction.
+  void Reset(uint64_t address, ArchState* state);
+
+  // Trampoline used to call semantic_fcn_ when the semantic function is not a
+  // plain function pointer.
+  static void CallSemanticFunction(Instruction* inst) {
+    inst->semantic_fcn_(inst);
+  }
+
+  // Function called by Execute(). This is either the semantic function itself,
+  // or CallSemanticFunction, which in turn calls semantic_fcn_.
+  SemanticFunctionPtr semantic_fcn_ptr_ = &Instruction::CallSemanticFunction;
+  // Semantic function that implements the instruction semantics when it is not
+  // a plain function pointer.
   SemanticFunction semantic_fcn_;
   // Pointer to the child (or sub) instruction. Used to break an instruction
   // up into multiple semantic actions, such as a VLIW instruction.
@@ -232,12 +344,27 @@ class Instruction : public ReferenceCount {
   // of instructions), such as those instances that make up the instructions in
   // a VLIW instruction word.
   Instruction* next_;
+  // The arena that the instruction was allocated from, or nullptr.
+  InstructionArena* arena_ = nullptr;
 };
 
 // Templated inline helper functions for operand access. These are intended to
 // provide access to instruction operands from instruction semantic functions
 // that are themselves templated on the operand types.
 
+namespace internal {
+
+// Reads the given element of the source operand. If the operand provides
+// direct access to its storage for values of type T, the value is read from the
+// storage directly, otherwise it is read using the virtual method as_fcn.
+template <typename T, T (SourceOperandInterface::*as_fcn)(int)>
+inline T ReadSource(SourceOperandInterface* op, int element) {
+  if (op->HasDirectAccess<T>()) return op->GetDirect<T>(element);
+  return (op->*as_fcn)(element);
+}
+
+}  // namespace internal
+
 // The base case shouldn't be matched. No return statement is provided.
 template <typename T>
 inline T GetInstructionSource(const Instruction* inst, int index) { /*empty */ }
@@ -251,55 +378,69 @@ inline bool GetInstructionSource<bool>(const Instruction* inst, int index) {
 template <>
 inline uint8_t GetInstructionSource<uint8_t>(const Instruction* inst,
                                              int index) {
-  return inst->Source(index)->AsUint8(0);
+  return internal::ReadSource<uint8_t, &SourceOperandInterface::AsUint8>(
+      inst->Source(index), 0);
 }
 template <>
 inline int8_t GetInstructionSource<int8_t>(const Instruction* inst, int index) {
-  return inst->Source(index)->AsInt8(0);
+  return internal::ReadSource<int8_t, &SourceOperandInterface::AsInt8>(
+      inst->Source(index), 0);
 }
 template <>
 inline uint16_t GetInstructionSource<uint16_t>(const Instruction* inst,
                                                int index) {
-  return inst->Source(index)->AsUint16(0);
+  return internal::ReadSource<uint16_t, &SourceOperandInterface::AsUint16>(
+      inst->Source(index), 0);
 }
 template <>
 inline int16_t GetInstructionSource<int16_t>(const Instruction* inst,
                                              int index) {
-  return inst->Source(index)->AsInt16(0);
+  return internal::ReadSource<int16_t, &SourceOperandInterface::AsInt16>(
+      inst->Source(index), 0);
 }
 template <>
 inline HalfFP GetInstructionSource<HalfFP>(const Instruction* inst, int index) {
-  auto value = inst->Source(index)->AsUint16(0);
+  auto value =
+      internal::ReadSource<uint16_t, &SourceOperandInterface::AsUint16>(
+          inst->Source(index), 0);
   return HalfFP{.value = value};
 }
 template <>
 inline uint32_t GetInstructionSource<uint32_t>(const Instruction* inst,
                                                int index) {
-  return inst->Source(index)->AsUint32(0);
+  return internal::ReadSource<uint32_t, &SourceOperandInterface::AsUint32>(
+      inst->Source(index), 0);
 }
 template <>
 inline int32_t GetInstructionSource<int32_t>(const Instruction* inst,
                                              int index) {
-  return inst->Source(index)->AsInt32(0);
+  return internal::ReadSource<int32_t, &SourceOperandInterface::AsInt32>(
+      inst->Source(index), 0);
 }
 template <>
 inline float GetInstructionSource<float>(const Instruction* inst, int index) {
-  auto value = inst->Source(index)->AsUint32(0);
+  auto value =
+      internal::ReadSource<uint32_t, &SourceOperandInterface::AsUint32>(
+          inst->Source(index), 0);
   return *reinterpret_cast<float*>(&value);
 }
 template <>
 inline uint64_t GetInstructionSource<uint64_t>(const Instruction* inst,
                                                int index) {
-  return inst->Source(index)->AsUint64(0);
+  return internal::ReadSource<uint64_t, &SourceOperandInterface::AsUint64>(
+      inst->Source(index), 0);
 }
 template <>
 inline int64_t GetInstructionSource<int64_t>(const Instruction* inst,
                                              int index) {
-  return inst->Source(index)->AsInt64(0);
+  return internal::ReadSource<int64_t, &SourceOperandInterface::AsInt64>(
+      inst->Source(index), 0);
 }
 template <>
 inline double GetInstructionSource<double>(const Instruction* inst, int index) {
-  auto value = inst->Source(index)->AsUint64(0);
+  auto value =
+      internal::ReadSource<uint64_t, &SourceOperandInterface::AsUint64>(
+          inst->Source(index), 0);
   return *reinterpret_cast<double*>(&value);
 }
 template <>
@@ -328,53 +469,65 @@ inline bool GetInstructionSource<bool>(const Instruction* inst, int index,
 template <>
 inline uint8_t GetInstructionSource<uint8_t>(const Instruction* inst, int index,
                                              int element) {
-  return inst->Source(index)->AsUint8(element);
+  return internal::ReadSource<uint8_t, &SourceOperandInterface::AsUint8>(
+      inst->Source(index), element);
 }
 template <>
 inline int8_t GetInstructionSource<int8_t>(const Instruction* inst, int index,
                                            int element) {
-  return inst->Source(index)->AsInt8(element);
+  return internal::ReadSource<int8_t, &SourceOperandInterface::AsInt8>(
+      inst->Source(index), element);
 }
 template <>
 inline uint16_t GetInstructionSource<uint16_t>(const Instruction* inst,
                                                int index, int element) {
-  return inst->Source(index)->AsUint16(element);
+  return internal::ReadSource<uint16_t, &SourceOperandInterface::AsUint16>(
+      inst->Source(index), element);
 }
 template <>
 inline int16_t GetInstructionSource<int16_t>(const Instruction* inst, int index,
                                              int element) {
-  return inst->Source(index)->AsInt16(element);
+  return internal::ReadSource<int16_t, &SourceOperandInterface::AsInt16>(
+      inst->Source(index), element);
 }
 template <>
 inline uint32_t GetInstructionSource<uint32_t>(const Instruction* inst,
                                                int index, int element) {
-  return inst->Source(index)->AsUint32(element);
+  return internal::ReadSource<uint32_t, &SourceOperandInterface::AsUint32>(
+      inst->Source(index), element);
 }
 template <>
 inline int32_t GetInstructionSource<int32_t>(const Instruction* inst, int index,
                                              int element) {
-  return inst->Source(index)->AsInt32(element);
+  return internal::ReadSource<int32_t, &SourceOperandInterface::AsInt32>(
+      inst->Source(index), element);
 }
 template <>
 inline float GetInstructionSource<float>(const Instruction* inst, int index,
                                          int element) {
-  auto value = inst->Source(index)->AsUint32(element);
+  auto value =
+      internal::ReadSource<uint32_t, &SourceOperandInterface::AsUint32>(
+          inst->Source(index), element);
   return *reinterpret_cast<float*>(&value);
 }
 template <>
 inline uint64_t GetInstructionSource<uint64_t>(const Instruction* inst,
                                                int index, int element) {
-  return inst->Source(index)->AsUint64(element);
+  return internal::ReadSource<uint64_t, &SourceOperandInterface::AsUint64>(
+      inst->Source(index), element);
 }
 template <>
 inline int64_t GetInstructionSource<int64_t>(const Instruction* inst, int index,
                                              int element) {
-  return inst->Source(index)->AsInt64(element);
+  return internal::ReadSource<int64_t, &SourceOperandInterface::AsInt64>(
+      inst->Source(index), element);
 }
 template <>
 inline double GetInstructionSource<double>(const Instruction* inst, int index,
                                            int element) {
-  auto value = inst->Source(index)->AsUint64(element);
+  auto value =
+      internal::ReadSource<uint64_t, &SourceOperandInterface::AsUint64>(
+          inst->Source(index), element);
   return *reinterpret_cast<double*>(&value);
 }
 
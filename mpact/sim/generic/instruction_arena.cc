@@ -0,0 +1,65 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mpact/sim/generic/instruction_arena.h"
+
+#include <cstdint>
+#include <new>
+
+#include "mpact/sim/generic/arch_state.h"
+#include "mpact/sim/generic/instruction.h"
+
+namespace mpact {
+namespace sim {
+namespace generic {
+
+InstructionArena::~InstructionArena() {
+  // Only the instructions on the free list are destroyed. Any instruction
+  // that is still referenced at this point has outlived its arena.
+  for (auto* inst : free_list_) {
+    inst->~Instruction();
+  }
+  free_list_.clear();
+  for (auto* slab : slabs_) {
+    ::operator delete(static_cast<void*>(slab));
+  }
+  slabs_.clear();
+}
+
+Instruction* InstructionArena::Allocate(uint64_t address, ArchState* state) {
+  if (!free_list_.empty()) {
+    Instruction* inst = free_list_.back();
+    free_list_.pop_back();
+    inst->Reset(address, state);
+    return inst;
+  }
+  if (slab_used_ == kSlabSize) {
+    slabs_.push_back(static_cast<Instruction*>(
+        ::operator new(sizeof(Instruction) * kSlabSize)));
+    slab_used_ = 0;
+  }
+  Instruction* inst = new (&slabs_.back()[slab_used_++])
+      Instruction(address, state);
+  inst->arena_ = this;
+  return inst;
+}
+
+void InstructionArena::Recycle(Instruction* inst) {
+  inst->Release();
+  free_list_.push_back(inst);
+}
+
+}  // namespace generic
+}  // namespace sim
+}  // namespace mpact
@@ -0,0 +1,74 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MPACT_SIM_GENERIC_INSTRUCTION_ARENA_H_
+#define MPACT_SIM_GENERIC_INSTRUCTION_ARENA_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "mpact/sim/generic/arch_state.h"
+#include "mpact/sim/generic/instruction.h"
+
+namespace mpact {
+namespace sim {
+namespace generic {
+
+// The InstructionArena allocates Instruction objects from contiguous slabs
+// and recycles them when their reference count reaches zero, in the same way
+// that the DataBufferFactory recycles DataBuffer objects. This reduces
+// allocator traffic when instructions are decoded repeatedly, e.g., due to
+// decode cache replacements or invalidations, and improves the locality of the
+// decoded instructions.
+//
+// The arena is typically registered with the ArchState instance (see
+// ArchState::set_instruction_arena()), so that instructions created by the
+// decoder using Instruction::Create() are allocated from it. The arena must
+// outlive all the instructions allocated from it.
+class InstructionArena {
+ public:
+  // Number of instructions per slab.
+  static constexpr int kSlabSize = 256;
+
+  InstructionArena() = default;
+  InstructionArena(const InstructionArena&) = delete;
+  InstructionArena& operator=(const InstructionArena&) = delete;
+  ~InstructionArena();
+
+  // Returns an instruction with the given address and state, and a reference
+  // count of one. The free list is searched before a new slab entry is used.
+  Instruction* Allocate(uint64_t address, ArchState* state);
+
+  // Accessors.
+  int num_slabs() const { return slabs_.size(); }
+  int num_free() const { return free_list_.size(); }
+
+ private:
+  friend class Instruction;
+
+  // Releases the operands of the instruction and adds it to the free list.
+  // Only called from Instruction::OnRefCountIsZero().
+  void Recycle(Instruction* inst);
+
+  std::vector<Instruction*> slabs_;
+  // Number of entries used in the last slab.
+  int slab_used_ = kSlabSize;
+  std::vector<Instruction*> free_list_;
+};
+
+}  // namespace generic
+}  // namespace sim
+}  // namespace mpact
+
+#endif  // MPACT_SIM_GENERIC_INSTRUCTION_ARENA_H_
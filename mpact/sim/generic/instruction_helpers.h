@@ -16,7 +16,10 @@
 #define MPACT_SIM_GENERIC_INSTRUCTION_HELPERS_H_
 
 #include <functional>
+#include <type_traits>
+#include <utility>
 
+#include "absl/types/span.h"
 #include "mpact/sim/generic/instruction.h"
 
 // This file contains a set of inline templated functions that can be used to
@@ -28,49 +31,50 @@ namespace mpact {
 namespace sim {
 namespace generic {
 
+// The helpers below come in two forms. The primary form takes the operation as
+// a template parameter of any callable type (lambda, function pointer, functor
+// etc.), so that the operation can be inlined into the helper. The argument
+// types default to the result type, and trailing argument types default to the
+// preceding argument type, e.g., BinaryOp<uint64_t, uint32_t>(inst, op) reads
+// both source operands as uint32_t. The second form takes the operation as a
+// std::function and is kept for source compatibility. It forwards to the
+// primary form.
+
 // This is a templated helper function used to factor out common code in
 // two operand instruction semantic functions. It reads two source operands
 // and applies the function argument to them, storing the result to the
 // destination operand. This version supports different types for the result and
 // each of the two source operands.
-template <typename Result, typename Argument1, typename Argument2>
-inline void BinaryOp(const Instruction* instruction,
-                     std::function<Result(Argument1, Argument2)> operation) {
+template <typename Result, typename Argument1 = Result,
+          typename Argument2 = Argument1, typename Operation>
+inline void BinaryOp(const Instruction* instruction, Operation operation) {
   Argument1 lhs = generic::GetInstructionSource<Argument1>(instruction, 0);
   Argument2 rhs = generic::GetInstructionSource<Argument2>(instruction, 1);
   Result dest_value = operation(lhs, rhs);
-  auto* db = instruction->Destination(0)->AllocateDataBuffer();
-  db->SetSubmit<Result>(0, dest_value);
+  instruction->Destination(0)->SetValue<Result>(0, dest_value);
+}
+
+template <typename Result, typename Argument1, typename Argument2>
+inline void BinaryOp(const Instruction* instruction,
+                     std::function<Result(Argument1, Argument2)> operation) {
+  BinaryOp<Result, Argument1, Argument2,
+           std::function<Result(Argument1, Argument2)>>(instruction,
+                                                        std::move(operation));
 }
 
-// This is a templated helper function used to factor out common code in
-// two operand instruction semantic functions. It reads two source operands
-// and applies the function argument to them, storing the result to the
-// destination operand. This version supports different types for the result
-// and the operands, but the two source operands must have the same type.
 template <typename Result, typename Argument>
 inline void BinaryOp(const Instruction* instruction,
                      std::function<Result(Argument, Argument)> operation) {
-  Argument lhs = generic::GetInstructionSource<Argument>(instruction, 0);
-  Argument rhs = generic::GetInstructionSource<Argument>(instruction, 1);
-  Result dest_value = operation(lhs, rhs);
-  auto* db = instruction->Destination(0)->AllocateDataBuffer();
-  db->SetSubmit<Result>(0, dest_value);
+  BinaryOp<Result, Argument, Argument,
+           std::function<Result(Argument, Argument)>>(instruction,
+                                                      std::move(operation));
 }
 
-// This is a templated helper function used to factor out common code in
-// two operand instruction semantic functions. It reads two source operands
-// and applies the function argument to them, storing the result to the
-// destination operand. This version requires both result and source operands
-// to have the same type.
 template <typename Result>
 inline void BinaryOp(const Instruction* instruction,
                      std::function<Result(Result, Result)> operation) {
-  Result lhs = generic::GetInstructionSource<Result>(instruction, 0);
-  Result rhs = generic::GetInstructionSource<Result>(instruction, 1);
-  Result dest_value = operation(lhs, rhs);
-  auto* db = instruction->Destination(0)->AllocateDataBuffer();
-  db->SetSubmit<Result>(0, dest_value);
+  BinaryOp<Result, Result, Result, std::function<Result(Result, Result)>>(
+      instruction, std::move(operation));
 }
 
 // This is a templated helper function used to factor out common code in
@@ -78,40 +82,83 @@ inline void BinaryOp(const Instruction* instruction,
 // and applies the function argument to it, storing the result to the
 // destination operand. This version supports the result and argument having
 // different types.
+template <typename Result, typename Argument = Result, typename Operation>
+inline void UnaryOp(const Instruction* instruction, Operation operation) {
+  Argument lhs = generic::GetInstructionSource<Argument>(instruction, 0);
+  Result dest_value = operation(lhs);
+  instruction->Destination(0)->SetValue<Result>(0, dest_value);
+}
+
 template <typename Result, typename Argument>
 inline void UnaryOp(const Instruction* instruction,
                     std::function<Result(Argument)> operation) {
-  Argument lhs = generic::GetInstructionSource<Argument>(instruction, 0);
-  Result dest_value = operation(lhs);
-  auto* db = instruction->Destination(0)->AllocateDataBuffer();
-  db->SetSubmit<Result>(0, dest_value);
+  UnaryOp<Result, Argument, std::function<Result(Argument)>>(
+      instruction, std::move(operation));
 }
 
-// This is a templated helper function used to factor out common code in
-// single operand instruction semantic functions. It reads one source operand
-// and applies the function argument to it, storing the result to the
-// destination operand. This version requires that the result and argument have
-// the same type.
 template <typename Result>
 inline void UnaryOp(const Instruction* instruction,
                     std::function<Result(Result)> operation) {
-  Result lhs = generic::GetInstructionSource<Result>(instruction, 0);
-  Result dest_value = operation(lhs);
-  auto* db = instruction->Destination(0)->AllocateDataBuffer();
-  db->SetSubmit<Result>(0, dest_value);
+  UnaryOp<Result, Result, std::function<Result(Result)>>(instruction,
+                                                         std::move(operation));
 }
 
+namespace internal {
+
+// Returns a span of the first size elements of the source operand if the
+// operand provides direct access to at least size elements of type T.
+// Otherwise returns an empty span. Direct access is only used for integral
+// (other than bool) and floating point types, for which reading the storage
+// directly is equivalent to GetInstructionSource. Other types, even if they
+// have the same size as the elements, are converted by GetInstructionSource.
+template <typename T>
+inline absl::Span<const T> GetSourceSpan(const Instruction* instruction,
+                                         int index, int size) {
+  if constexpr (!std::is_arithmetic_v<T> || std::is_same_v<T, bool>) {
+    return {};
+  } else {
+    auto* op = instruction->Source(index);
+    if (!op->HasDirectAccess<T>()) return {};
+    auto span = op->GetDirectSpan<T>();
+    if (static_cast<int>(span.size()) < size) return {};
+    return span.first(size);
+  }
+}
+
+}  // namespace internal
+
+// The vector helpers below read all elements of the source operands directly
+// from the underlying data buffers when all the source operands provide direct
+// access (e.g., vector registers with the same element sizes as the argument
+// types). The operation is then applied in a simple loop over contiguous
+// arrays that the compiler can vectorize. Otherwise the source operand
+// elements are read one at a time using GetInstructionSource.
+
 // This is a templated helper function used to factor out common code in
 // three operand vector instruction semantic functions. This version
 // allows for different types for the result and each argument.
-template <typename Result, typename Argument1, typename Argument2,
-          typename Argument3>
-inline void TernaryVectorOp(
-    const Instruction* instruction,
-    std::function<Result(Argument1, Argument2, Argument3)> operation) {
+template <typename Result, typename Argument1 = Result,
+          typename Argument2 = Argument1, typename Argument3 = Argument2,
+          typename Operation>
+inline void TernaryVectorOp(const Instruction* instruction,
+                            Operation operation) {
   auto* dst = instruction->Destination(0);
   auto* db = dst->AllocateDataBuffer();
-  int size = dst->shape()[0];
+  int size = dst->extent(0);
+  auto x_span = internal::GetSourceSpan<Argument1>(instruction, 0, size);
+  auto y_span = internal::GetSourceSpan<Argument2>(instruction, 1, size);
+  auto z_span = internal::GetSourceSpan<Argument3>(instruction, 2, size);
+  if (!x_span.empty() && !y_span.empty() && !z_span.empty()) {
+    Result* result = db->Get<Result>().data();
+    const Argument1* x = x_span.data();
+    const Argument2* y = y_span.data();
+    const Argument3* z = z_span.data();
+    for (int i = 0; i < size; i++) {
+      result[i] = operation(x[i], y[i], z[i]);
+    }
+    db->Submit();
+    return;
+  }
   for (int i = 0; i < size; i++) {
     Argument1 x_val =
         generic::GetInstructionSource<Argument1>(instruction, 0, i);
@@ -125,57 +172,56 @@ inline void TernaryVectorOp(
   db->Submit();
 }
 
-// This is a templated helper function used to factor out common code in
-// three operand vector instruction semantic functions. This version
-// allows for different types for the result and the three arguments, though
-// the arguments have to all have the same type.
+template <typename Result, typename Argument1, typename Argument2,
+          typename Argument3>
+inline void TernaryVectorOp(
+    const Instruction* instruction,
+    std::function<Result(Argument1, Argument2, Argument3)> operation) {
+  TernaryVectorOp<Result, Argument1, Argument2, Argument3,
+                  std::function<Result(Argument1, Argument2, Argument3)>>(
+      instruction, std::move(operation));
+}
+
 template <typename Result, typename Argument>
 inline void TernaryVectorOp(
     const Instruction* instruction,
     std::function<Result(Argument, Argument, Argument)> operation) {
-  auto* dst = instruction->Destination(0);
-  auto* db = dst->AllocateDataBuffer();
-  int size = dst->shape()[0];
-  for (int i = 0; i < size; i++) {
-    Argument x_val = generic::GetInstructionSource<Argument>(instruction, 0, i);
-    Argument y_val = generic::GetInstructionSource<Argument>(instruction, 1, i);
-    Argument z_val = generic::GetInstructionSource<Argument>(instruction, 2, i);
-    Result value = operation(x_val, y_val, z_val);
-    db->Set<Result>(i, value);
-  }
-  db->Submit();
+  TernaryVectorOp<Result, Argument, Argument, Argument,
+                  std::function<Result(Argument, Argument, Argument)>>(
+      instruction, std::move(operation));
 }
 
-// This is a templated helper function used to factor out common code in
-// three operand vector instruction semantic functions. This version
-// requires the result and arguments to have the same type.
 template <typename Result>
 inline void TernaryVectorOp(
     const Instruction* instruction,
     std::function<Result(Result, Result, Result)> operation) {
-  auto* dst = instruction->Destination(0);
-  auto* db = dst->AllocateDataBuffer();
-  int size = dst->shape()[0];
-  for (int i = 0; i < size; i++) {
-    Result x_val = generic::GetInstructionSource<Result>(instruction, 0, i);
-    Result y_val = generic::GetInstructionSource<Result>(instruction, 1, i);
-    Result z_val = generic::GetInstructionSource<Result>(instruction, 2, i);
-    Result value = operation(x_val, y_val, z_val);
-    db->Set<Result>(i, value);
-  }
-  db->Submit();
+  TernaryVectorOp<Result, Result, Result, Result,
+                  std::function<Result(Result, Result, Result)>>(
+      instruction, std::move(operation));
 }
 
 // This is a templated helper function used to factor out common code in
 // two operand vector instruction semantic functions. This version
 // allows for different types for the result and each argument.
-template <typename Result, typename Argument1, typename Argument2>
-inline void BinaryVectorOp(
-    const Instruction* instruction,
-    std::function<Result(Argument1, Argument2)> operation) {
+template <typename Result, typename Argument1 = Result,
+          typename Argument2 = Argument1, typename Operation>
+inline void BinaryVectorOp(const Instruction* instruction,
+                           Operation operation) {
   auto* dst = instruction->Destination(0);
   auto* db = dst->AllocateDataBuffer();
-  int size = dst->shape()[0];
+  int size = dst->extent(0);
+  auto lhs_span = internal::GetSourceSpan<Argument1>(instruction, 0, size);
+  auto rhs_span = internal::GetSourceSpan<Argument2>(instruction, 1, size);
+  if (!lhs_span.empty() && !rhs_span.empty()) {
+    Result* result = db->Get<Result>().data();
+    const Argument1* lhs = lhs_span.data();
+    const Argument2* rhs = rhs_span.data();
+    for (int i = 0; i < size; i++) {
+      result[i] = operation(lhs[i], rhs[i]);
+    }
+    db->Submit();
+    return;
+  }
   for (int i = 0; i < size; i++) {
     Argument1 lhs = generic::GetInstructionSource<Argument1>(instruction, 0, i);
     Argument2 rhs = generic::GetInstructionSource<Argument2>(instruction, 1, i);
@@ -185,53 +231,51 @@ inline void BinaryVectorOp(
   db->Submit();
 }
 
-// This is a templated helper function used to factor out common code in
-// two operand vector instruction semantic functions. This version
-// allows for different types for the result and the three arguments, though
-// the arguments have to have the same type.
+template <typename Result, typename Argument1, typename Argument2>
+inline void BinaryVectorOp(
+    const Instruction* instruction,
+    std::function<Result(Argument1, Argument2)> operation) {
+  BinaryVectorOp<Result, Argument1, Argument2,
+                 std::function<Result(Argument1, Argument2)>>(
+      instruction, std::move(operation));
+}
+
 template <typename Result, typename Argument>
 inline void BinaryVectorOp(
     const Instruction* instruction,
     std::function<Result(Argument, Argument)> operation) {
-  auto* dst = instruction->Destination(0);
-  auto* db = dst->AllocateDataBuffer();
-  int size = dst->shape()[0];
-  for (int i = 0; i < size; i++) {
-    Argument lhs = generic::GetInstructionSource<Argument>(instruction, 0, i);
-    Argument rhs = generic::GetInstructionSource<Argument>(instruction, 1, i);
-    Result value = operation(lhs, rhs);
-    db->Set<Result>(i, value);
-  }
-  db->Submit();
+  BinaryVectorOp<Result, Argument, Argument,
+                 std::function<Result(Argument, Argument)>>(
+      instruction, std::move(operation));
 }
 
-// This is a templated helper function used to factor out common code in
-// two operand vector instruction semantic functions. This version
-// requires the result and arguments to have the same type.
 template <typename Result>
 inline void BinaryVectorOp(const Instruction* instruction,
                            std::function<Result(Result, Result)> operation) {
-  auto* dst = instruction->Destination(0);
-  auto* db = dst->AllocateDataBuffer();
-  int size = dst->shape()[0];
-  for (int i = 0; i < size; i++) {
-    Result lhs = generic::GetInstructionSource<Result>(instruction, 0, i);
-    Result rhs = generic::GetInstructionSource<Result>(instruction, 1, i);
-    Result value = operation(lhs, rhs);
-    db->Set<Result>(i, value);
-  }
-  db->Submit();
+  BinaryVectorOp<Result, Result, Result,
+                 std::function<Result(Result, Result)>>(instruction,
+                                                        std::move(operation));
 }
 
 // This is a templated helper function used to factor out common code in
 // single operand vector instruction semantic functions. This version
 // allows the result and argument to have different types.
-template <typename Result, typename Argument>
+template <typename Result, typename Argument = Result, typename Operation>
 inline void UnaryVectorOp(const Instruction* instruction,
-                          std::function<Result(Argument)> operation) {
+                          Operation operation) {
   auto* dst = instruction->Destination(0);
   auto* db = dst->AllocateDataBuffer();
-  int size = dst->shape()[0];
+  int size = dst->extent(0);
+  auto lhs_span = internal::GetSourceSpan<Argument>(instruction, 0, size);
+  if (!lhs_span.empty()) {
+    Result* result = db->Get<Result>().data();
+    const Argument* lhs = lhs_span.data();
+    for (int i = 0; i < size; i++) {
+      result[i] = operation(lhs[i]);
+    }
+    db->Submit();
+    return;
+  }
   for (int i = 0; i < size; i++) {
     Argument lhs = generic::GetInstructionSource<Argument>(instruction, 0, i);
     Result value = operation(lhs);
@@ -240,21 +284,18 @@ inline void UnaryVectorOp(const Instruction* instruction,
   db->Submit();
 }
 
-// This is a templated helper function used to factor out common code in
-// single operand vector instruction semantic functions. This version
-// requires the result and argument to have the same type.
+template <typename Result, typename Argument>
+inline void UnaryVectorOp(const Instruction* instruction,
+                          std::function<Result(Argument)> operation) {
+  UnaryVectorOp<Result, Argument, std::function<Result(Argument)>>(
+      instruction, std::move(operation));
+}
+
 template <typename Result>
 inline void UnaryVectorOp(const Instruction* instruction,
                           std::function<Result(Result)> operation) {
-  auto* dst = instruction->Destination(0);
-  auto* db = dst->AllocateDataBuffer();
-  int size = dst->shape()[0];
-  for (int i = 0; i < size; i++) {
-    Result lhs = generic::GetInstructionSource<Result>(instruction, 0, i);
-    Result value = operation(lhs);
-    db->Set<Result>(i, value);
-  }
-  db->Submit();
+  UnaryVectorOp<Result, Result, std::function<Result(Result)>>(
+      instruction, std::move(operation));
 }
 
 }  // namespace generic
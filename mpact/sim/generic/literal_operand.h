@@ -81,6 +81,7 @@ class BoolLiteralOperand : public SourceOperandInterface {
   // For instance {0} indicates a scalar quantity, whereas {128} indicates an
   // 128 element vector quantity.
   std::vector<int> shape() const override { return shape_; }
+  int extent(int dimension) const override { return shape_[dimension]; }
 
   std::string AsString() const override { return as_string_; }
 
@@ -120,6 +121,7 @@ class IntLiteralOperand : public SourceOperandInterface {
   // For instance {0} indicates a scalar quantity, whereas {128} indicates an
   // 128 element vector quantity.
   std::vector<int> shape() const override { return shape_; }
+  int extent(int dimension) const override { return shape_[dimension]; }
 
   std::string AsString() const override { return as_string_; }
 
@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "absl/types/any.h"
+#include "absl/types/span.h"
 #include "mpact/sim/generic/data_buffer.h"
 
 namespace mpact {
@@ -50,6 +51,12 @@ class PredicateOperandInterface {
 // of those values (eg., register, fifo, immediate, predicate, etc).
 class SourceOperandInterface {
  public:
+  // The kind of the operand. Operands of kind kRegister provide direct access
+  // to the data buffer that holds the value of the underlying register, which
+  // allows the inline operand access helpers to read the value without going
+  // through the virtual methods below. All other operands are kOther.
+  enum class Kind : uint8_t { kOther = 0, kRegister };
+
   // Methods for accessing the nth value element.
   virtual bool AsBool(int index) = 0;
   virtual int8_t AsInt8(int index) = 0;
@@ -72,12 +79,59 @@ class SourceOperandInterface {
   // For instance {1} indicates a scalar quantity, whereas {128} indicates an
   // 128 element vector quantity.
   virtual std::vector<int> shape() const = 0;
+  // Returns the number of elements in the given dimension of the operand, i.e.,
+  // shape()[dimension], without allocating a vector. The default
+  // implementation calls shape(), so derived classes should override it.
+  virtual int extent(int dimension) const { return shape()[dimension]; }
 
   // Return a string representation of the operand suitable for display in
   // disassembly.
   virtual std::string AsString() const = 0;
 
   virtual ~SourceOperandInterface() = default;
+
+  Kind kind() const { return kind_; }
+  // Returns true if the operand value can be read using GetDirect<T>(), i.e.,
+  // the operand provides direct access and its element type has the same size
+  // as T. Reading a same size value of a different type is equivalent to the
+  // value cast returned by the corresponding virtual As* method.
+  template <typename T>
+  bool HasDirectAccess() const {
+    // The element size is only non-zero if direct access is enabled.
+    return element_size_ == sizeof(T);
+  }
+  // Returns the nth value element of the operand. Only valid if
+  // HasDirectAccess<T>() returns true.
+  template <typename T>
+  T GetDirect(int index) const {
+    return (*data_buffer_ref_)->Get<T>(index);
+  }
+  // Returns the value of the operand as a span of elements. Only valid if
+  // HasDirectAccess<T>() returns true. The span is invalidated when the
+  // underlying state is updated.
+  template <typename T>
+  absl::Span<const T> GetDirectSpan() const {
+    return (*data_buffer_ref_)->Get<T>();
+  }
+
+ protected:
+  // Called by derived classes to enable direct access. The data_buffer_ref
+  // points to the location that holds the pointer to the current data buffer
+  // of the underlying state, which has elements of size element_size. Direct
+  // reads bypass the As* methods, so this may only be called by classes that
+  // declare the As* methods final, and implement them as plain reads of the
+  // same data buffer.
+  void SetDirectAccess(Kind kind, DataBuffer* const* data_buffer_ref,
+                       int element_size) {
+    kind_ = kind;
+    data_buffer_ref_ = data_buffer_ref;
+    element_size_ = element_size;
+  }
+
+ private:
+  DataBuffer* const* data_buffer_ref_ = nullptr;
+  int element_size_ = 0;
+  Kind kind_ = Kind::kOther;
 };
 
 // The destination operand interface is used by instruction semantic functions
@@ -103,9 +157,54 @@ class DestinationOperandInterface {
   virtual std::any GetObject() const = 0;
   // Returns the order of the destination operand (size in each dimension).
   virtual std::vector<int> shape() const = 0;
+  // Returns the number of elements in the given dimension of the operand, i.e.,
+  // shape()[dimension], without allocating a vector. The default
+  // implementation calls shape(), so derived classes should override it.
+  virtual int extent(int dimension) const { return shape()[dimension]; }
   // Return a string representation of the operand suitable for display in
   // disassembly.
   virtual std::string AsString() const = 0;
+
+  // Returns true if a value of type T can be written in place using
+  // SetValue<T>(), i.e., the operand supports in-place updates, its element
+  // type has the same size as T, and the data buffer that holds the current
+  // value of the destination is not shared.
+  template <typename T>
+  bool CanSetValueInPlace() const {
+    // The element size is only non-zero if in-place updates are enabled.
+    return (element_size_ == sizeof(T)) &&
+           ((*data_buffer_ref_)->ref_count() == 1);
+  }
+  // Writes the value to the given element of the destination. This has the
+  // same effect as allocating a data buffer, setting the element, and
+  // submitting the data buffer, except that if CanSetValueInPlace<T>() is true,
+  // the value is written directly to the current value of the destination
+  // without allocating a data buffer. The value of the other elements of the
+  // destination is undefined after the call.
+  template <typename T>
+  void SetValue(int index, T value) {
+    if (CanSetValueInPlace<T>()) {
+      (*data_buffer_ref_)->Set<T>(index, value);
+      return;
+    }
+    AllocateDataBuffer()->SetSubmit<T>(index, value);
+  }
+
+ protected:
+  // Called by derived classes to enable in-place updates. The data_buffer_ref
+  // points to the location that holds the pointer to the current data buffer
+  // of the underlying state, which has elements of size element_size. This
+  // should only be enabled for zero latency writes to state for which
+  // replacing the data buffer has no side effects.
+  void EnableInPlaceUpdate(DataBuffer* const* data_buffer_ref,
+                           int element_size) {
+    data_buffer_ref_ = data_buffer_ref;
+    element_size_ = element_size;
+  }
+
+ private:
+  DataBuffer* const* data_buffer_ref_ = nullptr;
+  int element_size_ = 0;
 };
 
 }  // namespace generic
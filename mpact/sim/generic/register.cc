@@ -56,6 +56,14 @@ void RegisterBase::SetDataBuffer(DataBuffer* db) {
   data_buffer_ = db;
 }
 
+InPlaceRegisterBase::InPlaceRegisterBase(ArchState* state,
+                                         absl::string_view name,
+                                         const std::vector<int>& shape,
+                                         int unit_size)
+    : RegisterBase(state, name, shape, unit_size) {
+  set_in_place_update(true);
+}
+
 ReservedRegisterBase::ReservedRegisterBase(ArchState* state,
                                            absl::string_view name,
                                            const std::vector<int>& shape,
@@ -60,6 +60,8 @@ class RegisterSourceOperand : public SourceOperandInterface {
   // In order to properly cast signed values, an internal helper template
   // is used to get the signed type equivalent of any unsigned register unit
   // value type.
+  // These methods are final, as GetInstructionSource() bypasses them by
+  // reading the register data buffer directly.
   bool AsBool(int i) final;
   int8_t AsInt8(int i) final;
   uint8_t AsUint8(int i) final;
@@ -75,6 +77,7 @@ class RegisterSourceOperand : public SourceOperandInterface {
   RegisterBase* GetRegister() const { return register_; }
   // Returns the shape of the register.
   std::vector<int> shape() const override;
+  int extent(int dimension) const override;
 
   std::string AsString() const override { return op_name_; }
 
@@ -124,6 +127,7 @@ class RegisterDestinationOperand : public DestinationOperandInterface {
   // each dimension). For instance {0} indicates a scalar quantity, whereas
   // {128} indicates an 128 element vector quantity.
   std::vector<int> shape() const override;
+  int extent(int dimension) const override;
 
   std::string AsString() const override { return op_name_; }
 
@@ -154,16 +158,43 @@ class RegisterBase : public StateItemBase {
   // Returns a pointer to the DataBuffer that contains the current value of
   // the register.
   DataBuffer* data_buffer() const { return data_buffer_; }
+  // Returns a pointer to the location that holds the current data buffer
+  // pointer. The location does not change for the lifetime of the register.
+  DataBuffer* const* data_buffer_ref() const { return &data_buffer_; }
+  // Returns true if zero latency writes may update the current data buffer in
+  // place instead of replacing it using SetDataBuffer(). This is only the case
+  // for registers derived from InPlaceRegisterBase.
+  bool in_place_update() const { return in_place_update_; }
 
  protected:
   RegisterBase(ArchState* state, absl::string_view name,
                const std::vector<int>& shape, int unit_size);
 
+  void set_in_place_update(bool value) { in_place_update_ = value; }
+
  private:
   DataBuffer* data_buffer_;
+  bool in_place_update_ = false;
   std::vector<UpdateCallbackFunction> next_update_callbacks_;
 };
 
+// Base class for the plain register types. Since writes to these registers
+// have no side effects, zero latency writes update the current data buffer in
+// place. SetDataBuffer() is final, as it is bypassed by in-place updates.
+// Register types that need to act on writes must derive from RegisterBase.
+class InPlaceRegisterBase : public RegisterBase {
+ public:
+  InPlaceRegisterBase() = delete;
+  InPlaceRegisterBase(const InPlaceRegisterBase&) = delete;
+  InPlaceRegisterBase& operator=(const InPlaceRegisterBase&) = delete;
+
+  void SetDataBuffer(DataBuffer* db) final { RegisterBase::SetDataBuffer(db); }
+
+ protected:
+  InPlaceRegisterBase(ArchState* state, absl::string_view name,
+                      const std::vector<int>& shape, int unit_size);
+};
+
 // A register class that frees a SimpleResource instance when written to. This
 // is intended to be used in modeling dynamic stalls/hold issue due to data
 // dependencies on long latency operations with a protected pipeline.
@@ -192,21 +223,21 @@ class ReservedRegisterBase : public RegisterBase {
 
 // Scalar register type with value type ElementType.
 template <typename ElementType>
-using Register =
-    StateItem<RegisterBase, ElementType, RegisterSourceOperand<ElementType>,
-              RegisterDestinationOperand<ElementType>>;
+using Register = StateItem<InPlaceRegisterBase, ElementType,
+                           RegisterSourceOperand<ElementType>,
+                           RegisterDestinationOperand<ElementType>>;
 
 // N long vector register type with element value type ElementType.
 template <typename ElementType, int N>
-using VectorRegister =
-    StateItem<RegisterBase, ElementType, RegisterSourceOperand<ElementType>,
-              RegisterDestinationOperand<ElementType>, N>;
+using VectorRegister = StateItem<InPlaceRegisterBase, ElementType,
+                                 RegisterSourceOperand<ElementType>,
+                                 RegisterDestinationOperand<ElementType>, N>;
 
 // MxN matrix register type with element value type ElementType.
 template <typename ElementType, int M, int N>
-using MatrixRegister =
-    StateItem<RegisterBase, ElementType, RegisterSourceOperand<ElementType>,
-              RegisterDestinationOperand<ElementType>, M, N>;
+using MatrixRegister = StateItem<InPlaceRegisterBase, ElementType,
+                                 RegisterSourceOperand<ElementType>,
+                                 RegisterDestinationOperand<ElementType>, M, N>;
 
 // Scalar register type with value type ElementType.
 template <typename ElementType>
@@ -231,7 +262,9 @@ using ReservedMatrixRegister =
 template <typename T>
 RegisterSourceOperand<T>::RegisterSourceOperand(RegisterBase* reg,
                                                 const std::string op_name)
-    : register_(reg), op_name_(op_name) {}
+    : register_(reg), op_name_(op_name) {
+  SetDirectAccess(Kind::kRegister, reg->data_buffer_ref(), sizeof(T));
+}
 
 template <typename T>
 RegisterSourceOperand<T>::RegisterSourceOperand(RegisterBase* reg)
@@ -283,6 +316,11 @@ std::vector<int> RegisterSourceOperand<T>::shape() const {
   return register_->shape();
 }
 
+template <typename T>
+int RegisterSourceOperand<T>::extent(int dimension) const {
+  return register_->shape()[dimension];
+}
+
 template <typename T>
 RegisterDestinationOperand<T>::RegisterDestinationOperand(RegisterBase* reg,
                                                           int latency)
@@ -309,7 +347,11 @@ RegisterDestinationOperand<T>::RegisterDestinationOperand(
       db_factory_(reg->arch_state()->db_factory()),
       latency_(latency),
       delay_line_(delay_line),
-      op_name_(op_name) {}
+      op_name_(op_name) {
+  if ((latency_ == 0) && reg->in_place_update()) {
+    EnableInPlaceUpdate(reg->data_buffer_ref(), sizeof(T));
+  }
+}
 
 template <typename T>
 void RegisterDestinationOperand<T>::InitializeDataBuffer(DataBuffer* db) {
@@ -336,6 +378,11 @@ template <typename T>
 std::vector<int> RegisterDestinationOperand<T>::shape() const {
   return register_->shape();
 }
+
+template <typename T>
+int RegisterDestinationOperand<T>::extent(int dimension) const {
+  return register_->shape()[dimension];
+}
 }  // namespace generic
 }  // namespace sim
 }  // namespace mpact
@@ -48,7 +48,7 @@ class StateItemBase : public DataBufferDestination {
   // Returns the size vector of the state item. A scalar element has size
   // vector {1}, an N element vector item has size vector {N}, and
   // an MxN array item element has size vector {M,N}.
-  std::vector<int> shape() const { return shape_; }
+  const std::vector<int>& shape() const { return shape_; }
 
   // Returns the size in bytes of the state item.
   int size() const { return size_; }
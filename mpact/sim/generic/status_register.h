@@ -162,6 +162,9 @@ class StatusRegisterSourceOperand : public SourceOperandInterface {
 
   // Returns the shape of the register.
   std::vector<int> shape() const override { return status_register_->shape(); }
+  int extent(int dimension) const override {
+    return status_register_->shape()[dimension];
+  }
 
   std::string AsString() const override { return op_name_; }
 
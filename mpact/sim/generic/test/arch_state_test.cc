@@ -24,6 +24,7 @@
 #include "googlemock/include/gmock/gmock.h"
 #include "googletest/include/gtest/gtest.h"
 #include "mpact/sim/generic/delay_line.h"
+#include "mpact/sim/generic/delay_line_interface.h"
 #include "mpact/sim/generic/fifo.h"
 #include "mpact/sim/generic/operand_interface.h"
 #include "mpact/sim/generic/register.h"
@@ -227,6 +228,45 @@ TEST_F(ArchStateTest, AddFifo) {
   EXPECT_EQ(fifo2, nullptr);
 }
 
+// Test advancing to a cycle and skipping idle cycles.
+TEST_F(ArchStateTest, AdvanceTo) {
+  IntDelayLine* int_delay_line =
+      arch_state_->CreateAndAddDelayLine<IntDelayLine>();
+  int my_value = 0;
+  int fcn_value = 0;
+  EXPECT_EQ(arch_state_->CyclesToNextEvent(), DelayLineInterface::kNoEvent);
+  EXPECT_EQ(arch_state_->SkipIdleCycles(), 0);
+  EXPECT_EQ(arch_state_->cycle(), 0);
+  int_delay_line->Add(10, &my_value, 1);
+  // The function schedules another function call when it is called.
+  arch_state_->function_delay_line()->Add(100, [&]() {
+    fcn_value = 1;
+    arch_state_->function_delay_line()->Add(50, [&]() { fcn_value = 2; });
+  });
+  EXPECT_EQ(arch_state_->CyclesToNextEvent(), 10);
+  arch_state_->AdvanceTo(5);
+  EXPECT_EQ(arch_state_->cycle(), 5);
+  EXPECT_EQ(my_value, 0);
+  arch_state_->AdvanceTo(60);
+  EXPECT_EQ(arch_state_->cycle(), 60);
+  EXPECT_EQ(my_value, 1);
+  EXPECT_EQ(fcn_value, 0);
+  EXPECT_EQ(arch_state_->CyclesToNextEvent(), 40);
+  EXPECT_EQ(arch_state_->SkipIdleCycles(), 40);
+  EXPECT_EQ(arch_state_->cycle(), 100);
+  EXPECT_EQ(fcn_value, 1);
+  EXPECT_EQ(arch_state_->SkipIdleCycles(), 50);
+  EXPECT_EQ(arch_state_->cycle(), 150);
+  EXPECT_EQ(fcn_value, 2);
+  EXPECT_EQ(arch_state_->SkipIdleCycles(), 0);
+  EXPECT_EQ(arch_state_->cycle(), 150);
+  arch_state_->AdvanceTo(1'000'000);
+  EXPECT_EQ(arch_state_->cycle(), 1'000'000);
+  // Advancing to an earlier cycle does nothing.
+  arch_state_->AdvanceTo(10);
+  EXPECT_EQ(arch_state_->cycle(), 1'000'000);
+}
+
 }  // namespace
 }  // namespace generic
 }  // namespace sim
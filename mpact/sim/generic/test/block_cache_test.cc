@@ -0,0 +1,192 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mpact/sim/generic/block_cache.h"
+
+#include <cstdint>
+
+#include "googlemock/include/gmock/gmock.h"  // IWYU pragma: keep
+#include "googletest/include/gtest/gtest.h"
+#include "mpact/sim/generic/decode_cache.h"
+#include "mpact/sim/generic/decoder_interface.h"
+#include "mpact/sim/generic/instruction.h"
+
+namespace mpact {
+namespace sim {
+namespace generic {
+namespace {
+
+constexpr int kBranchAttribute = 0;
+
+// Simple decoder class. Every instruction is 4 bytes, and every instruction
+// at an address that ends in 0xc is a branch.
+class MockDecoder : public DecoderInterface {
+ public:
+  MockDecoder() : num_decoded_(0) {}
+  ~MockDecoder() override {}
+  Instruction* DecodeInstruction(uint64_t address) override {
+    num_decoded_++;
+    Instruction* inst = new Instruction(address, nullptr);
+    inst->set_size(4);
+    int is_branch = (address & 0xf) == 0xc ? 1 : 0;
+    inst->SetAttributes({is_branch});
+    return inst;
+  }
+  int GetNumOpcodes() const override { return 0; }
+  const char* GetOpcodeName(int index) const override { return ""; }
+  int num_decoded() const { return num_decoded_; }
+
+ private:
+  int num_decoded_;
+};
+
+// Test fixture for BlockCacheTest.
+class BlockCacheTest : public testing::Test {
+ protected:
+  BlockCacheTest() {
+    decoder_ = new MockDecoder();
+    DecodeCacheProperties dc_props;
+    dc_props.num_entries = 1024;
+    dc_props.minimum_pc_increment = 4;
+    decode_cache_ = DecodeCache::Create(dc_props, decoder_);
+    BlockCacheProperties props;
+    props.num_entries = 100;
+    props.max_block_size = 8;
+    props.terminator_attribute = kBranchAttribute;
+    block_cache_ = BlockCache::Create(props, decode_cache_);
+  }
+
+  ~BlockCacheTest() override {
+    delete block_cache_;
+    delete decode_cache_;
+    delete decoder_;
+  }
+
+  MockDecoder* decoder_;
+  DecodeCache* decode_cache_;
+  BlockCache* block_cache_;
+};
+
+// Test creation and verify basic properties.
+TEST_F(BlockCacheTest, BasicProperties) {
+  EXPECT_EQ(block_cache_->num_entries(), 128);
+  EXPECT_EQ(block_cache_->max_block_size(), 8);
+  EXPECT_EQ(block_cache_->decode_cache(), decode_cache_);
+  BlockCacheProperties props;
+  props.num_entries = 0;
+  props.max_block_size = 8;
+  props.terminator_attribute = kBranchAttribute;
+  EXPECT_EQ(BlockCache::Create(props, decode_cache_), nullptr);
+  props.num_entries = 16;
+  EXPECT_EQ(BlockCache::Create(props, nullptr), nullptr);
+}
+
+// Blocks end at the branch instruction.
+TEST_F(BlockCacheTest, BlockEndsAtBranch) {
+  auto* block = block_cache_->GetBlock(0x1000);
+  ASSERT_NE(block, nullptr);
+  EXPECT_EQ(block->start_address(), 0x1000);
+  EXPECT_EQ(block->end_address(), 0x1010);
+  ASSERT_EQ(block->size(), 4);
+  for (int i = 0; i < block->size(); i++) {
+    EXPECT_EQ(block->instructions()[i]->address(), 0x1000 + i * 4);
+  }
+  EXPECT_EQ(decoder_->num_decoded(), 4);
+  // Blocks can start in the middle of another block.
+  block = block_cache_->GetBlock(0x1008);
+  ASSERT_NE(block, nullptr);
+  EXPECT_EQ(block->size(), 2);
+  // The instructions come from the decode cache.
+  EXPECT_EQ(decoder_->num_decoded(), 4);
+}
+
+// Blocks without a branch end at the maximum block size.
+TEST_F(BlockCacheTest, BlockEndsAtMaxSize) {
+  BlockCacheProperties props;
+  props.num_entries = 16;
+  props.max_block_size = 8;
+  props.terminator_attribute = -1;
+  auto* block_cache = BlockCache::Create(props, decode_cache_);
+  auto* block = block_cache->GetBlock(0x1000);
+  ASSERT_NE(block, nullptr);
+  EXPECT_EQ(block->size(), 8);
+  EXPECT_EQ(block->end_address(), 0x1020);
+  delete block_cache;
+}
+
+// Cached blocks are returned without decoding.
+TEST_F(BlockCacheTest, CacheHit) {
+  auto* block = block_cache_->GetBlock(0x1000);
+  EXPECT_EQ(decoder_->num_decoded(), 4);
+  EXPECT_EQ(block_cache_->GetBlock(0x1000), block);
+  EXPECT_EQ(decoder_->num_decoded(), 4);
+  // Evict the instructions from the decode cache. The block keeps its own
+  // references, so it remains valid.
+  for (uint64_t address = 0x2000; address < 0x2010; address += 4) {
+    decode_cache_->GetDecodedInstruction(address);
+  }
+  EXPECT_EQ(decoder_->num_decoded(), 8);
+  block = block_cache_->GetBlock(0x1000);
+  EXPECT_EQ(decoder_->num_decoded(), 8);
+  EXPECT_EQ(block->instructions()[3]->address(), 0x100c);
+}
+
+// Invalidation of a single address invalidates the blocks containing it.
+TEST_F(BlockCacheTest, Invalidate) {
+  auto* block0 = block_cache_->GetBlock(0x1000);
+  auto* block1 = block_cache_->GetBlock(0x1010);
+  EXPECT_EQ(decoder_->num_decoded(), 8);
+  block_cache_->Invalidate(0x1008);
+  EXPECT_TRUE(block0->empty());
+  EXPECT_FALSE(block1->empty());
+  // Only the invalidated instruction is decoded again.
+  block0 = block_cache_->GetBlock(0x1000);
+  EXPECT_EQ(block0->size(), 4);
+  EXPECT_EQ(decoder_->num_decoded(), 9);
+  block1 = block_cache_->GetBlock(0x1010);
+  EXPECT_EQ(decoder_->num_decoded(), 9);
+}
+
+// Invalidation of a range invalidates all overlapping blocks.
+TEST_F(BlockCacheTest, InvalidateRange) {
+  auto* block0 = block_cache_->GetBlock(0x1000);
+  auto* block1 = block_cache_->GetBlock(0x1010);
+  auto* block2 = block_cache_->GetBlock(0x1020);
+  EXPECT_EQ(decoder_->num_decoded(), 12);
+  block_cache_->InvalidateRange(0x100c, 0x1014);
+  EXPECT_TRUE(block0->empty());
+  EXPECT_TRUE(block1->empty());
+  EXPECT_FALSE(block2->empty());
+  block_cache_->GetBlock(0x1000);
+  block_cache_->GetBlock(0x1010);
+  EXPECT_EQ(decoder_->num_decoded(), 14);
+}
+
+// Invalidate all blocks.
+TEST_F(BlockCacheTest, InvalidateAll) {
+  auto* block0 = block_cache_->GetBlock(0x1000);
+  auto* block1 = block_cache_->GetBlock(0x1010);
+  EXPECT_EQ(decoder_->num_decoded(), 8);
+  block_cache_->InvalidateAll();
+  EXPECT_TRUE(block0->empty());
+  EXPECT_TRUE(block1->empty());
+  block_cache_->GetBlock(0x1000);
+  block_cache_->GetBlock(0x1010);
+  EXPECT_EQ(decoder_->num_decoded(), 16);
+}
+
+}  // namespace
+}  // namespace generic
+}  // namespace sim
+}  // namespace mpact
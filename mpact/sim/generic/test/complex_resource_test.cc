@@ -278,4 +278,18 @@ TEST_F(ComplexResourceTest, ShiftGreaterThan64) {
   delete resource;
 }
 
+// Skipping cycles with AdvanceTo is consistent with the resource reservations.
+TEST_F(ComplexResourceTest, AdvanceTo) {
+  auto* resource = new ComplexResource(arch_state_, kResourceName, 256);
+  resource->Acquire(kAllOnes256);
+  EXPECT_FALSE(resource->IsFree(kAllOnes64));
+  arch_state_->AdvanceTo(96);
+  EXPECT_EQ(arch_state_->cycle(), 96);
+  EXPECT_TRUE(resource->IsFree(kAllOnes96));
+  EXPECT_FALSE(resource->IsFree(kAllOnes256));
+  arch_state_->AdvanceTo(300);
+  EXPECT_TRUE(resource->IsFree(kAllOnes256));
+  delete resource;
+}
+
 }  // namespace
@@ -0,0 +1,216 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mpact/sim/generic/core_debug_interface.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "googlemock/include/gmock/gmock.h"  // IWYU pragma: keep
+#include "googletest/include/gtest/gtest.h"
+#include "mpact/sim/generic/arch_state.h"
+#include "mpact/sim/generic/data_buffer.h"
+#include "mpact/sim/generic/instruction.h"
+#include "mpact/sim/generic/register.h"
+
+namespace mpact {
+namespace sim {
+namespace generic {
+namespace {
+
+// Tests for the RegisterHandleTable helper class.
+
+class TestArchState : public ArchState {
+ public:
+  explicit TestArchState(absl::string_view id) : ArchState(id, nullptr) {}
+};
+
+// Core debug interface that implements the named register accessors on top of
+// the registers of an ArchState, plus a register "pc" that is not in the
+// register map. The named accesses are counted.
+class TestCore : public CoreDebugInterface {
+ public:
+  explicit TestCore(ArchState* state) : state_(state) {}
+
+  absl::StatusOr<uint64_t> ReadRegister(const std::string& name) override {
+    read_count_++;
+    if (name == "pc") return pc_;
+    auto iter = state_->registers()->find(name);
+    if (iter == state_->registers()->end()) {
+      return absl::NotFoundError("Register not found");
+    }
+    return iter->second->data_buffer()->Get<uint32_t>(0);
+  }
+  absl::Status WriteRegister(const std::string& name, uint64_t value) override {
+    write_count_++;
+    if (name == "pc") {
+      pc_ = value;
+      return absl::OkStatus();
+    }
+    auto iter = state_->registers()->find(name);
+    if (iter == state_->registers()->end()) {
+      return absl::NotFoundError("Register not found");
+    }
+    iter->second->data_buffer()->Set<uint32_t>(0, value);
+    return absl::OkStatus();
+  }
+
+  absl::StatusOr<DataBuffer*> GetRegisterDataBuffer(
+      const std::string& name) override {
+    return absl::UnimplementedError("");
+  }
+  absl::Status Halt() override { return absl::UnimplementedError(""); }
+  absl::Status Halt(HaltReason) override {
+    return absl::UnimplementedError("");
+  }
+  absl::Status Halt(HaltReasonValueType) override {
+    return absl::UnimplementedError("");
+  }
+  absl::StatusOr<int> Step(int num) override {
+    return absl::UnimplementedError("");
+  }
+  absl::Status Run() override { return absl::UnimplementedError(""); }
+  absl::Status Wait() override { return absl::UnimplementedError(""); }
+  absl::StatusOr<RunStatus> GetRunStatus() override {
+    return absl::UnimplementedError("");
+  }
+  absl::StatusOr<HaltReasonValueType> GetLastHaltReason() override {
+    return absl::UnimplementedError("");
+  }
+  absl::StatusOr<size_t> ReadMemory(uint64_t address, void* buf,
+                                    size_t length) override {
+    return absl::UnimplementedError("");
+  }
+  absl::StatusOr<size_t> WriteMemory(uint64_t address, const void* buf,
+                                     size_t length) override {
+    return absl::UnimplementedError("");
+  }
+  bool HasBreakpoint(uint64_t address) override { return false; }
+  absl::Status SetSwBreakpoint(uint64_t address) override {
+    return absl::UnimplementedError("");
+  }
+  absl::Status ClearSwBreakpoint(uint64_t address) override {
+    return absl::UnimplementedError("");
+  }
+  absl::Status ClearAllSwBreakpoints() override {
+    return absl::UnimplementedError("");
+  }
+  absl::StatusOr<Instruction*> GetInstruction(uint64_t address) override {
+    return absl::UnimplementedError("");
+  }
+  absl::StatusOr<std::string> GetDisassembly(uint64_t address) override {
+    return absl::UnimplementedError("");
+  }
+
+  int read_count() const { return read_count_; }
+  int write_count() const { return write_count_; }
+  uint64_t pc() const { return pc_; }
+
+ private:
+  ArchState* state_;
+  uint64_t pc_ = 0;
+  int read_count_ = 0;
+  int write_count_ = 0;
+};
+
+class RegisterHandleTableTest : public ::testing::Test {
+ protected:
+  RegisterHandleTableTest() : state_("test"), core_(&state_) {
+    x1_ = state_.AddRegister<Register<uint32_t>>("x1");
+    x2_ = state_.AddRegister<Register<uint32_t>>("x2");
+    x1_->data_buffer()->Set<uint32_t>(0, 0x1111);
+    x2_->data_buffer()->Set<uint32_t>(0, 0x2222);
+  }
+
+  TestArchState state_;
+  TestCore core_;
+  Register<uint32_t>* x1_;
+  Register<uint32_t>* x2_;
+};
+
+// Without an ArchState, all accesses use the named register accessors.
+TEST_F(RegisterHandleTableTest, NamedAccess) {
+  RegisterHandleTable table(&core_);
+  auto x1 = table.GetRegisterHandle("x1");
+  auto x2 = table.GetRegisterHandle("x2");
+  ASSERT_TRUE(x1.ok());
+  ASSERT_TRUE(x2.ok());
+  EXPECT_EQ(table.GetRegisterHandle("x3").status().code(),
+            absl::StatusCode::kNotFound);
+  int reads = core_.read_count();
+  RegisterHandleTable::RegisterHandle handles[] = {x2.value(), x1.value()};
+  uint64_t values[2];
+  ASSERT_TRUE(table.ReadRegisters(handles, values).ok());
+  EXPECT_EQ(values[0], 0x2222);
+  EXPECT_EQ(values[1], 0x1111);
+  EXPECT_EQ(core_.read_count(), reads + 2);
+  values[0] = 0x3333;
+  values[1] = 0x4444;
+  ASSERT_TRUE(table.WriteRegisters(handles, values).ok());
+  EXPECT_EQ(x2_->data_buffer()->Get<uint32_t>(0), 0x3333);
+  EXPECT_EQ(x1_->data_buffer()->Get<uint32_t>(0), 0x4444);
+  EXPECT_EQ(core_.write_count(), 2);
+}
+
+// With an ArchState, registers in its register map are accessed through their
+// data buffers, other registers through the named register accessors.
+TEST_F(RegisterHandleTableTest, DirectAccess) {
+  RegisterHandleTable table(&core_, &state_);
+  auto x1 = table.GetRegisterHandle("x1");
+  auto pc = table.GetRegisterHandle("pc");
+  ASSERT_TRUE(x1.ok());
+  ASSERT_TRUE(pc.ok());
+  int reads = core_.read_count();
+  RegisterHandleTable::RegisterHandle handles[] = {x1.value(), pc.value()};
+  uint64_t values[2] = {0x5555, 0x1000};
+  ASSERT_TRUE(table.WriteRegisters(handles, values).ok());
+  EXPECT_EQ(x1_->data_buffer()->Get<uint32_t>(0), 0x5555);
+  EXPECT_EQ(core_.pc(), 0x1000);
+  EXPECT_EQ(core_.write_count(), 1);
+  // The data buffer of the register is looked up on each access, as it may
+  // be replaced by a write to the register.
+  auto* db = state_.db_factory()->Allocate<uint32_t>(1);
+  db->Set<uint32_t>(0, 0x6666);
+  x1_->SetDataBuffer(db);
+  db->DecRef();
+  ASSERT_TRUE(table.ReadRegisters(handles, values).ok());
+  EXPECT_EQ(values[0], 0x6666);
+  EXPECT_EQ(values[1], 0x1000);
+  EXPECT_EQ(core_.read_count(), reads + 1);
+}
+
+// Invalid handles and short value spans are rejected.
+TEST_F(RegisterHandleTableTest, Errors) {
+  RegisterHandleTable table(&core_, &state_);
+  auto x1 = table.GetRegisterHandle("x1");
+  ASSERT_TRUE(x1.ok());
+  RegisterHandleTable::RegisterHandle handles[] = {x1.value(), x1.value() + 1};
+  uint64_t values[2];
+  EXPECT_EQ(table.ReadRegisters(handles, values).code(),
+            absl::StatusCode::kNotFound);
+  EXPECT_EQ(table.WriteRegisters(handles, values).code(),
+            absl::StatusCode::kNotFound);
+  EXPECT_EQ(table.ReadRegisters(handles, absl::MakeSpan(values, 1)).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace generic
+}  // namespace sim
+}  // namespace mpact
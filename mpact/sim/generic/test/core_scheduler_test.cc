@@ -0,0 +1,191 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mpact/sim/generic/core_scheduler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "googlemock/include/gmock/gmock.h"
+#include "googletest/include/gtest/gtest.h"
+
+namespace mpact {
+namespace sim {
+namespace generic {
+namespace {
+
+using Mode = CoreSchedulerProperties::Mode;
+using ::testing::ElementsAre;
+
+// Simple core that executes a fixed number of time units, then halts.
+class TestCore {
+ public:
+  explicit TestCore(uint64_t length) : length_(length) {}
+
+  absl::StatusOr<uint64_t> Step(uint64_t num) {
+    uint64_t count = std::min(num, length_ - position_);
+    position_ += count;
+    return count;
+  }
+
+  uint64_t position() const { return position_; }
+
+ private:
+  uint64_t length_;
+  uint64_t position_ = 0;
+};
+
+TEST(CoreSchedulerTest, Create) {
+  std::unique_ptr<CoreScheduler> scheduler(
+      CoreScheduler::Create({/*quantum=*/0, Mode::kSequential, 1}));
+  EXPECT_EQ(scheduler, nullptr);
+  scheduler.reset(CoreScheduler::Create({100, Mode::kParallel, 0}));
+  EXPECT_EQ(scheduler, nullptr);
+  scheduler.reset(CoreScheduler::Create({100, Mode::kSequential, 0}));
+  ASSERT_NE(scheduler, nullptr);
+  EXPECT_EQ(scheduler->quantum(), 100);
+  EXPECT_EQ(scheduler->num_threads(), 1);
+  EXPECT_EQ(scheduler->num_cores(), 0);
+  scheduler.reset(CoreScheduler::Create({100, Mode::kParallel, 4}));
+  ASSERT_NE(scheduler, nullptr);
+  EXPECT_EQ(scheduler->mode(), Mode::kParallel);
+  EXPECT_EQ(scheduler->num_threads(), 4);
+  // With no cores, there is nothing to run.
+  EXPECT_TRUE(scheduler->Run().ok());
+  EXPECT_EQ(scheduler->num_quanta(), 0);
+}
+
+// In sequential mode the cores are run in a fixed order, and halted cores are
+// no longer scheduled.
+TEST(CoreSchedulerTest, Sequential) {
+  std::unique_ptr<CoreScheduler> scheduler(
+      CoreScheduler::Create({10, Mode::kSequential, 1}));
+  std::vector<int> order;
+  std::vector<uint64_t> lengths = {25, 40, 10};
+  std::vector<TestCore> cores(lengths.begin(), lengths.end());
+  int num_cores = cores.size();
+  for (int i = 0; i < num_cores; i++) {
+    int index = scheduler->AddCore([&, i](uint64_t num) {
+      order.push_back(i);
+      return cores[i].Step(num);
+    });
+    EXPECT_EQ(index, i);
+  }
+  std::vector<uint64_t> callbacks;
+  scheduler->set_quantum_callback(
+      [&callbacks](uint64_t quanta) { callbacks.push_back(quanta); });
+  // Run two quanta.
+  EXPECT_TRUE(scheduler->Run(2).ok());
+  EXPECT_THAT(order, ElementsAre(0, 1, 2, 0, 1, 2));
+  EXPECT_THAT(callbacks, ElementsAre(1, 2));
+  // Core 2 completed its 10 units in the first quantum, but is only found to
+  // be halted when it fails to complete the second one.
+  EXPECT_FALSE(scheduler->IsActive(2));
+  order.clear();
+  // Run to completion.
+  EXPECT_TRUE(scheduler->Run().ok());
+  EXPECT_THAT(order, ElementsAre(0, 1, 1, 1));
+  EXPECT_EQ(scheduler->num_quanta(), 5);
+  for (int i = 0; i < num_cores; i++) {
+    EXPECT_EQ(cores[i].position(), lengths[i]);
+    EXPECT_FALSE(scheduler->IsActive(i));
+  }
+  // Reactivate a core.
+  order.clear();
+  scheduler->SetActive(0, true);
+  EXPECT_TRUE(scheduler->Run().ok());
+  EXPECT_THAT(order, ElementsAre(0));
+}
+
+// Stop requests and errors end the run at the end of the quantum.
+TEST(CoreSchedulerTest, StopAndError) {
+  std::unique_ptr<CoreScheduler> scheduler(
+      CoreScheduler::Create({10, Mode::kSequential, 1}));
+  int count = 0;
+  scheduler->AddCore([&](uint64_t num) -> absl::StatusOr<uint64_t> {
+    if (++count == 5) return absl::InternalError("error");
+    return num;
+  });
+  scheduler->AddCore([](uint64_t num) -> absl::StatusOr<uint64_t> {
+    return num;
+  });
+  scheduler->set_quantum_callback([&](uint64_t quanta) {
+    if (quanta == 3) scheduler->RequestStop();
+  });
+  EXPECT_TRUE(scheduler->Run().ok());
+  EXPECT_EQ(scheduler->num_quanta(), 3);
+  auto status = scheduler->Run();
+  EXPECT_EQ(status.code(), absl::StatusCode::kInternal);
+  EXPECT_EQ(scheduler->num_quanta(), 5);
+  EXPECT_FALSE(scheduler->IsActive(0));
+  EXPECT_TRUE(scheduler->IsActive(1));
+  // The other core keeps running.
+  EXPECT_TRUE(scheduler->Run(2).ok());
+  EXPECT_EQ(scheduler->num_quanta(), 7);
+}
+
+// In parallel mode, each core is run for each quantum exactly once, and the
+// cores synchronize at the end of each quantum.
+TEST(CoreSchedulerTest, Parallel) {
+  constexpr int kNumCores = 16;
+  constexpr uint64_t kQuantum = 100;
+  std::unique_ptr<CoreScheduler> scheduler(
+      CoreScheduler::Create({kQuantum, Mode::kParallel, 4}));
+  std::vector<TestCore> cores;
+  for (int i = 0; i < kNumCores; i++) cores.emplace_back(1000 + i * 150);
+  // Number of steps per quantum, which is checked by the quantum callback.
+  absl::Mutex mutex;
+  int num_steps = 0;
+  for (int i = 0; i < kNumCores; i++) {
+    scheduler->AddCore([&, i](uint64_t num) {
+      {
+        absl::MutexLock lock(&mutex);
+        num_steps++;
+      }
+      return cores[i].Step(num);
+    });
+  }
+  std::vector<int> steps_per_quantum;
+  scheduler->set_quantum_callback([&](uint64_t) {
+    absl::MutexLock lock(&mutex);
+    steps_per_quantum.push_back(num_steps);
+    num_steps = 0;
+  });
+  EXPECT_TRUE(scheduler->Run().ok());
+  // The longest core needs 32.5 quanta, so it halts in the 33rd.
+  EXPECT_EQ(scheduler->num_quanta(), 33);
+  ASSERT_EQ(steps_per_quantum.size(), 33);
+  for (int q = 0; q < 33; q++) {
+    // A core is stepped in a quantum if it completed all previous quanta.
+    int expected = 0;
+    for (int i = 0; i < kNumCores; i++) {
+      uint64_t length = 1000 + i * 150;
+      if (q * kQuantum <= length) expected++;
+    }
+    EXPECT_EQ(steps_per_quantum[q], expected) << q;
+  }
+  for (int i = 0; i < kNumCores; i++) {
+    EXPECT_EQ(cores[i].position(), 1000 + i * 150);
+  }
+}
+
+}  // namespace
+}  // namespace generic
+}  // namespace sim
+}  // namespace mpact
@@ -18,6 +18,7 @@
 
 #include "googlemock/include/gmock/gmock.h"  // IWYU pragma: keep
 #include "googletest/include/gtest/gtest.h"
+#include "mpact/sim/generic/counters.h"
 #include "mpact/sim/generic/decoder_interface.h"
 #include "mpact/sim/generic/instruction.h"
 
@@ -180,6 +181,144 @@ TEST_F(DecodeCacheTest, InvalidateAll) {
   delete dc;
 }
 
+// Test properties of a set associative cache.
+TEST_F(DecodeCacheTest, SetAssociativeProperties) {
+  DecodeCacheProperties props;
+  props.num_entries = 1000;
+  props.minimum_pc_increment = 4;
+  props.num_ways = 4;
+  DecodeCache* dc = DecodeCache::Create(props, decoder_);
+  ASSERT_NE(dc, nullptr);
+  EXPECT_EQ(dc->num_entries(), 1024);
+  EXPECT_EQ(dc->num_ways(), 4);
+  EXPECT_EQ(dc->num_sets(), 256);
+  EXPECT_EQ(dc->address_mask(), 0x3FC);
+  delete dc;
+
+  // Number of ways must be a power of two.
+  props.num_ways = 3;
+  EXPECT_EQ(DecodeCache::Create(props, decoder_), nullptr);
+  // Number of ways must not exceed the number of entries.
+  props.num_ways = 2048;
+  EXPECT_EQ(DecodeCache::Create(props, decoder_), nullptr);
+}
+
+// Test that aliasing addresses do not thrash a set associative cache, and that
+// the least recently used entry is replaced.
+TEST_F(DecodeCacheTest, LruReplacement) {
+  DecodeCacheProperties props;
+  props.num_entries = 16;
+  props.minimum_pc_increment = 4;
+  props.num_ways = 2;
+  props.replacement = DecodeCacheReplacement::kLru;
+  DecodeCache* dc = DecodeCache::Create(props, decoder_);
+  // 0x1000, 0x2000 and 0x3000 map to the same set.
+  dc->GetDecodedInstruction(0x1000);
+  dc->GetDecodedInstruction(0x2000);
+  EXPECT_EQ(decoder_->num_decoded(), 2);
+  dc->GetDecodedInstruction(0x1000);
+  dc->GetDecodedInstruction(0x2000);
+  dc->GetDecodedInstruction(0x1000);
+  EXPECT_EQ(decoder_->num_decoded(), 2);
+  // This replaces 0x2000, the least recently used entry.
+  dc->GetDecodedInstruction(0x3000);
+  EXPECT_EQ(decoder_->num_decoded(), 3);
+  dc->GetDecodedInstruction(0x1000);
+  EXPECT_EQ(decoder_->num_decoded(), 3);
+  dc->GetDecodedInstruction(0x2000);
+  EXPECT_EQ(decoder_->num_decoded(), 4);
+  EXPECT_EQ(dc->hit_counter()->GetValue(), 4);
+  EXPECT_EQ(dc->miss_counter()->GetValue(), 4);
+  EXPECT_EQ(dc->conflict_counter()->GetValue(), 2);
+  // Invalidated entries are reused before valid entries are replaced.
+  dc->Invalidate(0x2000);
+  dc->GetDecodedInstruction(0x4000);
+  EXPECT_EQ(dc->conflict_counter()->GetValue(), 2);
+  dc->GetDecodedInstruction(0x1000);
+  EXPECT_EQ(decoder_->num_decoded(), 5);
+  delete dc;
+}
+
+// Test the clock replacement policy.
+TEST_F(DecodeCacheTest, ClockReplacement) {
+  DecodeCacheProperties props;
+  props.num_entries = 16;
+  props.minimum_pc_increment = 4;
+  props.num_ways = 2;
+  props.replacement = DecodeCacheReplacement::kClock;
+  DecodeCache* dc = DecodeCache::Create(props, decoder_);
+  dc->GetDecodedInstruction(0x1000);
+  dc->GetDecodedInstruction(0x2000);
+  dc->GetDecodedInstruction(0x1000);
+  dc->GetDecodedInstruction(0x2000);
+  EXPECT_EQ(decoder_->num_decoded(), 2);
+  // Both entries are referenced, so the hand clears both reference bits and
+  // replaces the entry for 0x1000.
+  dc->GetDecodedInstruction(0x3000);
+  EXPECT_EQ(decoder_->num_decoded(), 3);
+  dc->GetDecodedInstruction(0x2000);
+  dc->GetDecodedInstruction(0x3000);
+  EXPECT_EQ(decoder_->num_decoded(), 3);
+  dc->GetDecodedInstruction(0x1000);
+  EXPECT_EQ(decoder_->num_decoded(), 4);
+  EXPECT_EQ(dc->conflict_counter()->GetValue(), 2);
+  delete dc;
+}
+
+// Test that replaced instructions are recovered from the victim buffer.
+TEST_F(DecodeCacheTest, VictimBuffer) {
+  DecodeCacheProperties props;
+  props.num_entries = 16;
+  props.minimum_pc_increment = 4;
+  props.num_victim_entries = 2;
+  DecodeCache* dc = DecodeCache::Create(props, decoder_);
+  EXPECT_EQ(dc->num_victim_entries(), 2);
+  auto* inst0 = dc->GetDecodedInstruction(0x1000);
+  dc->GetDecodedInstruction(0x2000);
+  EXPECT_EQ(decoder_->num_decoded(), 2);
+  // 0x1000 is in the victim buffer and is swapped back into the cache.
+  EXPECT_EQ(dc->GetDecodedInstruction(0x1000), inst0);
+  EXPECT_EQ(decoder_->num_decoded(), 2);
+  EXPECT_EQ(dc->victim_hit_counter()->GetValue(), 1);
+  // Fill the victim buffer and push out 0x2000.
+  dc->GetDecodedInstruction(0x3000);
+  dc->GetDecodedInstruction(0x4000);
+  dc->GetDecodedInstruction(0x5000);
+  EXPECT_EQ(decoder_->num_decoded(), 5);
+  dc->GetDecodedInstruction(0x2000);
+  EXPECT_EQ(decoder_->num_decoded(), 6);
+  // Invalidation removes instructions from the victim buffer.
+  dc->Invalidate(0x5000);
+  dc->GetDecodedInstruction(0x5000);
+  EXPECT_EQ(decoder_->num_decoded(), 7);
+  delete dc;
+}
+
+// Hits are added to the hit counter on the next miss, or when the counter is
+// accessed.
+TEST_F(DecodeCacheTest, HitCounter) {
+  DecodeCacheProperties props;
+  props.num_entries = 16;
+  props.minimum_pc_increment = 4;
+  DecodeCache* dc = DecodeCache::Create(props, decoder_);
+  SimpleCounter<uint64_t>* hit_counter = dc->hit_counter();
+  dc->GetDecodedInstruction(0x1000);
+  dc->GetDecodedInstruction(0x1000);
+  dc->GetDecodedInstruction(0x1000);
+  EXPECT_EQ(hit_counter->GetValue(), 0);
+  dc->GetDecodedInstruction(0x1004);
+  EXPECT_EQ(hit_counter->GetValue(), 2);
+  dc->GetDecodedInstruction(0x1004);
+  EXPECT_EQ(dc->hit_counter()->GetValue(), 3);
+  // Hits are not counted while the counter is disabled.
+  hit_counter->SetIsEnabled(false);
+  dc->GetDecodedInstruction(0x1004);
+  dc->GetDecodedInstruction(0x1008);
+  hit_counter->SetIsEnabled(true);
+  EXPECT_EQ(dc->hit_counter()->GetValue(), 3);
+  delete dc;
+}
+
 }  // namespace
 }  // namespace generic
 }  // namespace sim
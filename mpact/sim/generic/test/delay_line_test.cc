@@ -14,8 +14,15 @@
 
 #include "mpact/sim/generic/delay_line.h"
 
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include "googlemock/include/gmock/gmock.h"  // IWYU pragma: keep
 #include "googletest/include/gtest/gtest.h"
+#include "mpact/sim/generic/delay_line_interface.h"
+#include "mpact/sim/generic/function_delay_line.h"
 
 namespace mpact {
 namespace sim {
@@ -134,6 +141,102 @@ TEST_F(DelayLineTest, WriteBackRequiringWrapAndResize) {
   EXPECT_TRUE(delay_line_->IsEmpty());
 }
 
+// Records in the current slot are applied a full delay line length after they
+// were added. They keep that delay when the delay line is resized, also when
+// the new latency is equal to the delay line length.
+TEST_F(DelayLineTest, ResizeWithCurrentSlotEntries) {
+  int dest1 = 0;
+  int dest2 = 0;
+  for (int cycle = 0; cycle < 3; cycle++) {
+    delay_line_->Advance();
+  }
+  // A zero latency record is added to the current slot.
+  delay_line_->Add(0, TestRecord(1, &dest1));
+  // The latency is equal to the delay line length, so it has to be resized.
+  delay_line_->Add(8, TestRecord(2, &dest2));
+  for (int cycle = 0; cycle < 7; cycle++) {
+    EXPECT_EQ(delay_line_->Advance(), 2);
+  }
+  EXPECT_EQ(dest1, 0);
+  EXPECT_EQ(dest2, 0);
+  EXPECT_EQ(delay_line_->Advance(), 0);
+  EXPECT_EQ(dest1, 1);
+  EXPECT_EQ(dest2, 2);
+}
+
+// Test the next event query and advancing by multiple cycles.
+TEST_F(DelayLineTest, AdvanceBy) {
+  int dest1 = 0;
+  int dest2 = 0;
+  EXPECT_EQ(delay_line_->CyclesToNextEvent(), DelayLineInterface::kNoEvent);
+  delay_line_->Add(3, TestRecord(1, &dest1));
+  delay_line_->Add(5, TestRecord(2, &dest2));
+  EXPECT_EQ(delay_line_->CyclesToNextEvent(), 3);
+  delay_line_->AdvanceBy(2);
+  EXPECT_EQ(dest1, 0);
+  EXPECT_EQ(delay_line_->CyclesToNextEvent(), 1);
+  delay_line_->AdvanceBy(2);
+  EXPECT_EQ(dest1, 1);
+  EXPECT_EQ(dest2, 0);
+  EXPECT_EQ(delay_line_->CyclesToNextEvent(), 1);
+  delay_line_->AdvanceBy(100);
+  EXPECT_EQ(dest2, 2);
+  EXPECT_TRUE(delay_line_->IsEmpty());
+  EXPECT_EQ(delay_line_->CyclesToNextEvent(), DelayLineInterface::kNoEvent);
+  // Advancing an empty delay line by any number of cycles is fine.
+  delay_line_->AdvanceBy(1'000'003);
+  delay_line_->Add(2, TestRecord(3, &dest1));
+  EXPECT_EQ(delay_line_->CyclesToNextEvent(), 2);
+  delay_line_->Advance();
+  EXPECT_EQ(dest1, 1);
+  delay_line_->Advance();
+  EXPECT_EQ(dest1, 3);
+}
+
+// Records added while the delay line is advanced are applied in later cycles,
+// and records with the same latency are applied in the order they were added.
+TEST_F(DelayLineTest, AddDuringAdvance) {
+  FunctionDelayLine delay_line(4);
+  std::vector<int> order;
+  delay_line.Add(1, [&]() {
+    order.push_back(1);
+    // This requires the delay line to be resized.
+    delay_line.Add(10, [&]() { order.push_back(3); });
+    delay_line.Add(1, [&]() { order.push_back(2); });
+  });
+  delay_line.Add(1, [&]() { order.push_back(0); });
+  delay_line.Advance();
+  EXPECT_THAT(order, testing::ElementsAre(1, 0));
+  delay_line.Advance();
+  EXPECT_THAT(order, testing::ElementsAre(1, 0, 2));
+  for (int i = 0; i < 9; i++) delay_line.Advance();
+  EXPECT_THAT(order, testing::ElementsAre(1, 0, 2, 3));
+  EXPECT_TRUE(delay_line.IsEmpty());
+}
+
+// Small callables are stored inline, larger ones on the heap. Callables that
+// have not been called are destroyed with the delay line.
+TEST_F(DelayLineTest, FunctionDelayRecordStorage) {
+  auto value = std::make_shared<int>(0);
+  std::array<uint64_t, 8> large = {1, 2, 3, 4, 5, 6, 7, 8};
+  auto small_fcn = [value]() { *value += 1; };
+  auto large_fcn = [value, large]() { *value += large[7]; };
+  EXPECT_TRUE(FunctionDelayRecord::IsInline<decltype(small_fcn)>());
+  EXPECT_FALSE(FunctionDelayRecord::IsInline<decltype(large_fcn)>());
+  auto* delay_line = new FunctionDelayLine(4);
+  delay_line->Add(1, small_fcn);
+  delay_line->Add(1, large_fcn);
+  delay_line->Add(2, small_fcn);
+  delay_line->Add(2, large_fcn);
+  EXPECT_EQ(value.use_count(), 7);
+  delay_line->Advance();
+  EXPECT_EQ(*value, 9);
+  EXPECT_EQ(value.use_count(), 5);
+  delete delay_line;
+  EXPECT_EQ(*value, 9);
+  EXPECT_EQ(value.use_count(), 3);
+}
+
 }  // namespace
 }  // namespace generic
 }  // namespace sim
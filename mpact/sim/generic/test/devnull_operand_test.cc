@@ -66,6 +66,7 @@ TEST_F(DevNullOperandTest, VectorDevNull) {
       arch_state_, std::vector<int>{8});
   EXPECT_EQ(operand->shape().size(), 1);
   EXPECT_EQ(operand->shape()[0], 8);
+  EXPECT_EQ(operand->extent(0), 8);
   auto db = operand->AllocateDataBuffer();
   EXPECT_EQ(db->size<uint32_t>(), operand->shape()[0]);
   db->Submit();
@@ -0,0 +1,192 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mpact/sim/generic/external_event_log.h"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#include "absl/status/status.h"
+#include "googletest/include/gtest/gtest.h"
+
+namespace mpact {
+namespace sim {
+namespace generic {
+namespace {
+
+// Loads and timed events are read back independently, each in the order they
+// were written.
+TEST(ExternalEventLogTest, WriteAndRead) {
+  std::stringstream log;
+  ExternalEventWriter writer(&log);
+  uint32_t word = 0xdeadbeef;
+  writer.WriteLoad(0x1000, &word, sizeof(word));
+  writer.WriteIrq(100, 3, true);
+  writer.WriteLoad(0x2000'0000'0000, "abc", 3);
+  writer.WriteRegisterWrite(100, 0x7b1, 0x8000'0000'0000'0000ULL);
+  writer.WriteMemoryWrite(12345, 0x40, "xy", 2);
+  writer.WriteIrq(1ULL << 40, 3, false);
+  writer.Flush();
+
+  ExternalEventReader reader(&log);
+  // Read all the timed events first.
+  auto res = reader.PeekEvent();
+  ASSERT_TRUE(res.ok());
+  const ExternalEvent* event = res.value();
+  ASSERT_NE(event, nullptr);
+  EXPECT_EQ(event->type, ExternalEventType::kIrq);
+  EXPECT_EQ(event->time, 100);
+  EXPECT_EQ(event->address, 3);
+  EXPECT_EQ(event->value, 1);
+  reader.PopEvent();
+  event = reader.PeekEvent().value();
+  ASSERT_NE(event, nullptr);
+  EXPECT_EQ(event->type, ExternalEventType::kRegisterWrite);
+  EXPECT_EQ(event->time, 100);
+  EXPECT_EQ(event->address, 0x7b1);
+  EXPECT_EQ(event->value, 0x8000'0000'0000'0000ULL);
+  reader.PopEvent();
+  event = reader.PeekEvent().value();
+  ASSERT_NE(event, nullptr);
+  EXPECT_EQ(event->type, ExternalEventType::kMemoryWrite);
+  EXPECT_EQ(event->time, 12345);
+  EXPECT_EQ(event->address, 0x40);
+  EXPECT_EQ(event->data, "xy");
+  reader.PopEvent();
+  event = reader.PeekEvent().value();
+  ASSERT_NE(event, nullptr);
+  EXPECT_EQ(event->time, 1ULL << 40);
+  EXPECT_EQ(event->value, 0);
+  reader.PopEvent();
+  res = reader.PeekEvent();
+  ASSERT_TRUE(res.ok());
+  EXPECT_EQ(res.value(), nullptr);
+
+  auto load = reader.NextLoad();
+  ASSERT_TRUE(load.ok());
+  EXPECT_EQ(load->address, 0x1000);
+  EXPECT_EQ(load->data, std::string(reinterpret_cast<char*>(&word), 4));
+  load = reader.NextLoad();
+  ASSERT_TRUE(load.ok());
+  EXPECT_EQ(load->address, 0x2000'0000'0000);
+  EXPECT_EQ(load->data, "abc");
+  load = reader.NextLoad();
+  EXPECT_EQ(load.status().code(), absl::StatusCode::kNotFound);
+}
+
+// Reads of loads and timed events can be interleaved in any order, each
+// continuing from its own position in the log.
+TEST(ExternalEventLogTest, InterleavedReads) {
+  constexpr int kNumLoads = 1000;
+  std::stringstream log;
+  ExternalEventWriter writer(&log);
+  for (uint32_t i = 0; i < kNumLoads; ++i) {
+    writer.WriteLoad(i, &i, sizeof(i));
+    if (i % 100 == 99) writer.WriteIrq(i, 1, (i / 100) & 1);
+  }
+  writer.Flush();
+
+  ExternalEventReader reader(&log);
+  uint32_t next_load = 0;
+  for (uint64_t time = 99; time < kNumLoads; time += 100) {
+    // Peek at the next event, past the loads that precede it.
+    auto res = reader.PeekEvent();
+    ASSERT_TRUE(res.ok());
+    const ExternalEvent* event = res.value();
+    ASSERT_NE(event, nullptr);
+    EXPECT_EQ(event->time, time);
+    EXPECT_EQ(event->value, (time / 100) & 1);
+    // Peeking again returns the same event.
+    EXPECT_EQ(reader.PeekEvent().value(), event);
+    // Read some of the loads before the event is consumed.
+    for (int i = 0; i < 50; ++i) {
+      auto load = reader.NextLoad();
+      ASSERT_TRUE(load.ok());
+      EXPECT_EQ(load->address, next_load);
+      EXPECT_EQ(load->data,
+                std::string(reinterpret_cast<char*>(&next_load), 4));
+      next_load++;
+    }
+    reader.PopEvent();
+  }
+  EXPECT_EQ(reader.PeekEvent().value(), nullptr);
+  // The remaining loads are read after the end of the events.
+  while (next_load < kNumLoads) {
+    auto load = reader.NextLoad();
+    ASSERT_TRUE(load.ok());
+    EXPECT_EQ(load->address, next_load);
+    next_load++;
+  }
+  EXPECT_EQ(reader.NextLoad().status().code(), absl::StatusCode::kNotFound);
+  EXPECT_EQ(reader.PeekEvent().value(), nullptr);
+}
+
+TEST(ExternalEventLogTest, CacheEvents) {
+  std::stringstream log;
+  ExternalEventWriter writer(&log);
+  writer.WriteAddCachedRange(0, 0x8000'0000, 0x10'0000, true);
+  writer.WriteInvalidateMemory(10, 0x8000'1000, 0x1000);
+  writer.WriteFlushMemory(20, 0, ~0ULL);
+  writer.Flush();
+
+  ExternalEventReader reader(&log);
+  const ExternalEvent* event = reader.PeekEvent().value();
+  ASSERT_NE(event, nullptr);
+  EXPECT_EQ(event->type, ExternalEventType::kAddCachedRange);
+  EXPECT_EQ(event->time, 0);
+  EXPECT_EQ(event->address, 0x8000'0000);
+  EXPECT_EQ(event->value, 0x10'0000);
+  EXPECT_EQ(event->data, std::string(1, 1));
+  reader.PopEvent();
+  event = reader.PeekEvent().value();
+  ASSERT_NE(event, nullptr);
+  EXPECT_EQ(event->type, ExternalEventType::kInvalidateMemory);
+  EXPECT_EQ(event->time, 10);
+  EXPECT_EQ(event->address, 0x8000'1000);
+  EXPECT_EQ(event->value, 0x1000);
+  reader.PopEvent();
+  event = reader.PeekEvent().value();
+  ASSERT_NE(event, nullptr);
+  EXPECT_EQ(event->type, ExternalEventType::kFlushMemory);
+  EXPECT_EQ(event->time, 20);
+  EXPECT_EQ(event->address, 0);
+  EXPECT_EQ(event->value, ~0ULL);
+  reader.PopEvent();
+  EXPECT_EQ(reader.PeekEvent().value(), nullptr);
+}
+
+TEST(ExternalEventLogTest, InvalidLog) {
+  std::stringstream bad_header("MPXV");
+  ExternalEventReader reader(&bad_header);
+  EXPECT_EQ(reader.NextLoad().status().code(),
+            absl::StatusCode::kInvalidArgument);
+
+  std::stringstream log;
+  {
+    ExternalEventWriter writer(&log);
+    writer.WriteLoad(0x1000, "abcd", 4);
+  }
+  // Drop the last byte of data.
+  std::string data = log.str();
+  std::stringstream truncated(data.substr(0, data.size() - 1));
+  ExternalEventReader truncated_reader(&truncated);
+  EXPECT_EQ(truncated_reader.NextLoad().status().code(),
+            absl::StatusCode::kInternal);
+}
+
+}  // namespace
+}  // namespace generic
+}  // namespace sim
+}  // namespace mpact
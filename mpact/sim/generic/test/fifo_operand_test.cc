@@ -82,6 +82,7 @@ TEST_F(FifoOperandTest, SourceOperandInitialization) {
   EXPECT_EQ(std::any_cast<FifoBase*>(v_src_op->GetObject()),
             static_cast<FifoBase*>(vfifo_));
   EXPECT_EQ(v_src_op->shape(), vfifo_->shape());
+  EXPECT_EQ(v_src_op->extent(0), vfifo_->shape()[0]);
   EXPECT_EQ(v_src_op->AsString(), kVectorFifoName);
 
   v_src_op = std::make_unique<FifoSourceOperand<uint32_t>>(vfifo_, "Fifo");
@@ -105,6 +106,7 @@ TEST_F(FifoOperandTest, DestinationOperandInitialization) {
   auto v_dst_op = std::make_unique<FifoDestinationOperand<uint32_t>>(vfifo_, 4);
   EXPECT_EQ(v_dst_op->latency(), 4);
   EXPECT_EQ(v_dst_op->shape(), vfifo_->shape());
+  EXPECT_EQ(v_dst_op->extent(0), vfifo_->shape()[0]);
   EXPECT_EQ(v_dst_op->CopyDataBuffer(), nullptr);
   EXPECT_EQ(std::any_cast<FifoBase*>(v_dst_op->GetObject()),
             static_cast<FifoBase*>(vfifo_));
@@ -72,6 +72,7 @@ TEST(ImmediateOperandTest, VectorShapedImmediate) {
 
   EXPECT_EQ(operand->shape().size(), 1);
   EXPECT_EQ(operand->shape()[0], 128);
+  EXPECT_EQ(operand->extent(0), 128);
   EXPECT_FALSE(operand->GetObject().has_value());
 
   for (int index = 0; index < 128; index += 16) {
@@ -0,0 +1,122 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mpact/sim/generic/instruction_arena.h"
+
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
+#include "googlemock/include/gmock/gmock.h"  // IWYU pragma: keep
+#include "googletest/include/gtest/gtest.h"
+#include "mpact/sim/generic/arch_state.h"
+#include "mpact/sim/generic/immediate_operand.h"
+#include "mpact/sim/generic/instruction.h"
+
+namespace mpact {
+namespace sim {
+namespace generic {
+namespace {
+
+// ArchState constructors are protected.
+class MyArchState : public ArchState {
+ public:
+  explicit MyArchState(absl::string_view id) : ArchState(id, nullptr) {}
+};
+
+void NopSemFunc(Instruction*) {}
+
+// Test fixture for InstructionArenaTest.
+class InstructionArenaTest : public testing::Test {
+ protected:
+  InstructionArenaTest() : state_("test") {}
+
+  MyArchState state_;
+  InstructionArena arena_;
+};
+
+// Recycled instructions are reused and reinitialized.
+TEST_F(InstructionArenaTest, AllocateAndRecycle) {
+  EXPECT_EQ(arena_.num_slabs(), 0);
+  Instruction* inst = arena_.Allocate(0x1000, &state_);
+  EXPECT_EQ(arena_.num_slabs(), 1);
+  EXPECT_EQ(inst->ref_count(), 1);
+  EXPECT_EQ(inst->address(), 0x1000);
+  EXPECT_EQ(inst->state(), &state_);
+  inst->set_size(4);
+  inst->set_opcode(3);
+  inst->set_semantic_function(&NopSemFunc);
+  inst->AppendSource(new ImmediateOperand<uint32_t>(1));
+  inst->SetAttributes({1, 2});
+  inst->SetDisassemblyString("nop");
+  inst->DecRef();
+  EXPECT_EQ(arena_.num_free(), 1);
+  Instruction* inst2 = arena_.Allocate(0x2000, nullptr);
+  EXPECT_EQ(inst2, inst);
+  EXPECT_EQ(arena_.num_free(), 0);
+  EXPECT_EQ(inst2->ref_count(), 1);
+  EXPECT_EQ(inst2->address(), 0x2000);
+  EXPECT_EQ(inst2->state(), nullptr);
+  EXPECT_EQ(inst2->size(), 0);
+  EXPECT_EQ(inst2->opcode(), 0);
+  EXPECT_EQ(inst2->SourcesSize(), 0);
+  EXPECT_TRUE(inst2->Attributes().empty());
+  EXPECT_EQ(inst2->AsString(), "");
+  EXPECT_FALSE(inst2->has_direct_semantic_function());
+  inst2->DecRef();
+}
+
+// Child and next instructions are released along with their parent.
+TEST_F(InstructionArenaTest, RecycleHierarchy) {
+  Instruction* inst = arena_.Allocate(0x1000, &state_);
+  Instruction* child = arena_.Allocate(0x1000, &state_);
+  Instruction* next = arena_.Allocate(0x1000, &state_);
+  inst->AppendChild(child);
+  child->DecRef();
+  inst->Append(next);
+  next->DecRef();
+  EXPECT_EQ(arena_.num_free(), 0);
+  inst->DecRef();
+  EXPECT_EQ(arena_.num_free(), 3);
+}
+
+// Instructions are allocated from additional slabs as needed.
+TEST_F(InstructionArenaTest, MultipleSlabs) {
+  Instruction* insts[InstructionArena::kSlabSize + 1];
+  for (auto& inst : insts) {
+    inst = arena_.Allocate(0, &state_);
+  }
+  EXPECT_EQ(arena_.num_slabs(), 2);
+  for (auto* inst : insts) {
+    inst->DecRef();
+  }
+  EXPECT_EQ(arena_.num_free(), InstructionArena::kSlabSize + 1);
+}
+
+// Instruction::Create uses the arena registered with the ArchState.
+TEST_F(InstructionArenaTest, CreateFromArchState) {
+  Instruction* inst = Instruction::Create(0x1000, &state_);
+  inst->DecRef();
+  EXPECT_EQ(arena_.num_free(), 0);
+  state_.set_instruction_arena(&arena_);
+  EXPECT_EQ(state_.instruction_arena(), &arena_);
+  inst = Instruction::Create(0x1000, &state_);
+  EXPECT_EQ(arena_.num_slabs(), 1);
+  inst->DecRef();
+  EXPECT_EQ(arena_.num_free(), 1);
+}
+
+}  // namespace
+}  // namespace generic
+}  // namespace sim
+}  // namespace mpact
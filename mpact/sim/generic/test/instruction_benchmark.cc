@@ -0,0 +1,280 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks for instruction dispatch and semantic function helpers.
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/functional/bind_front.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "mpact/sim/generic/arch_state.h"
+#include "mpact/sim/generic/function_delay_line.h"
+#include "mpact/sim/generic/immediate_operand.h"
+#include "mpact/sim/generic/instruction.h"
+#include "mpact/sim/generic/instruction_helpers.h"
+#include "mpact/sim/generic/ref_count.h"
+#include "mpact/sim/generic/register.h"
+
+namespace mpact {
+namespace sim {
+namespace generic {
+namespace {
+
+// Number of instructions executed per benchmark iteration.
+constexpr int kNumInstructions = 64;
+
+uint64_t counter = 0;
+
+void IncrementCounter(Instruction* inst) {
+  counter += inst->address();
+  benchmark::DoNotOptimize(counter);
+}
+
+class CounterHolder {
+ public:
+  void Increment(Instruction* inst) {
+    value_ += inst->address();
+    benchmark::DoNotOptimize(value_);
+  }
+
+ private:
+  uint64_t value_ = 0;
+};
+
+// Executes a straight line sequence of instructions with the given semantic
+// function.
+template <typename F>
+void ExecuteInstructions(benchmark::State& state, F semantic_function) {
+  std::unique_ptr<Instruction> insts[kNumInstructions];
+  for (int i = 0; i < kNumInstructions; i++) {
+    insts[i] = std::make_unique<Instruction>(i * 4, nullptr);
+    insts[i]->set_semantic_function(semantic_function);
+  }
+  for (auto s : state) {
+    for (auto& inst : insts) {
+      inst->Execute(nullptr);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNumInstructions);
+}
+
+// Plain function pointer: dispatched directly.
+void BM_ExecuteFunctionPointer(benchmark::State& state) {
+  ExecuteInstructions(state, &IncrementCounter);
+}
+BENCHMARK(BM_ExecuteFunctionPointer);
+
+// std::function wrapping a plain function pointer: the function pointer is
+// extracted when the semantic function is set, so it is dispatched directly.
+void BM_ExecuteStdFunctionPointer(benchmark::State& state) {
+  ExecuteInstructions(state,
+                      Instruction::SemanticFunction(&IncrementCounter));
+}
+BENCHMARK(BM_ExecuteStdFunctionPointer);
+
+// Bound member function: dispatched through std::function.
+void BM_ExecuteBoundFunction(benchmark::State& state) {
+  CounterHolder holder;
+  ExecuteInstructions(state,
+                      absl::bind_front(&CounterHolder::Increment, &holder));
+}
+BENCHMARK(BM_ExecuteBoundFunction);
+
+// Creates an instruction with three source and one destination operands, then
+// releases it. This measures the allocation overhead of the operand storage.
+void BM_CreateInstructionWithOperands(benchmark::State& state) {
+  for (auto s : state) {
+    auto* inst = new Instruction(0x1000, nullptr);
+    inst->AppendSource(nullptr);
+    inst->AppendSource(nullptr);
+    inst->AppendSource(nullptr);
+    inst->AppendDestination(nullptr);
+    benchmark::DoNotOptimize(inst);
+    inst->DecRef();
+  }
+  state.counters["sizeof(Instruction)"] = sizeof(Instruction);
+}
+BENCHMARK(BM_CreateInstructionWithOperands);
+
+// Reads the two source operands of a large number of instructions. This is
+// sensitive to the number of cache lines touched per operand access.
+void BM_ReadInstructionSources(benchmark::State& state) {
+  const int num_instructions = state.range(0);
+  std::vector<Instruction*> insts;
+  insts.reserve(num_instructions);
+  for (int i = 0; i < num_instructions; i++) {
+    auto* inst = new Instruction(i * 4, nullptr);
+    inst->AppendSource(new ImmediateOperand<uint32_t>(i));
+    inst->AppendSource(new ImmediateOperand<uint32_t>(i + 1));
+    insts.push_back(inst);
+  }
+  for (auto s : state) {
+    uint64_t sum = 0;
+    for (auto* inst : insts) {
+      sum += GetInstructionSource<uint32_t>(inst, 0);
+      sum += GetInstructionSource<uint32_t>(inst, 1);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * num_instructions);
+  for (auto* inst : insts) inst->DecRef();
+}
+BENCHMARK(BM_ReadInstructionSources)->Arg(1 << 10)->Arg(1 << 16);
+
+class BenchmarkArchState : public ArchState {
+ public:
+  BenchmarkArchState() : ArchState("bench") {}
+};
+
+// Reads the two register source operands of a sequence of instructions. The
+// register operands provide direct access to the register values, so this
+// does not use the virtual operand interface.
+void BM_ReadRegisterSources(benchmark::State& state) {
+  constexpr int kNumRegisters = 32;
+  BenchmarkArchState arch_state;
+  std::vector<std::unique_ptr<Register<uint32_t>>> regs;
+  for (int i = 0; i < kNumRegisters; i++) {
+    regs.push_back(std::make_unique<Register<uint32_t>>(&arch_state,
+                                                        absl::StrCat("x", i)));
+  }
+  std::unique_ptr<Instruction> insts[kNumInstructions];
+  for (int i = 0; i < kNumInstructions; i++) {
+    insts[i] = std::make_unique<Instruction>(i * 4, &arch_state);
+    insts[i]->AppendSource(regs[i % kNumRegisters]->CreateSourceOperand());
+    insts[i]->AppendSource(
+        regs[(i + 1) % kNumRegisters]->CreateSourceOperand());
+  }
+  for (auto s : state) {
+    uint64_t sum = 0;
+    for (auto& inst : insts) {
+      sum += GetInstructionSource<uint32_t>(inst.get(), 0);
+      sum += GetInstructionSource<uint32_t>(inst.get(), 1);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kNumInstructions);
+}
+BENCHMARK(BM_ReadRegisterSources);
+
+// Add semantic functions using the BinaryOp helper with a lambda and with a
+// std::function.
+void AddSemanticFunction(Instruction* inst) {
+  BinaryOp<uint32_t>(inst, [](uint32_t a, uint32_t b) { return a + b; });
+}
+
+void AddStdFunctionSemanticFunction(Instruction* inst) {
+  BinaryOp<uint32_t>(inst, std::function<uint32_t(uint32_t, uint32_t)>(
+                               [](uint32_t a, uint32_t b) { return a + b; }));
+}
+
+// Executes a sequence of register add instructions with zero latency
+// destinations.
+void ExecuteRegisterAdd(benchmark::State& state,
+                        Instruction::SemanticFunctionPtr semantic_function) {
+  constexpr int kNumRegisters = 32;
+  BenchmarkArchState arch_state;
+  std::vector<std::unique_ptr<Register<uint32_t>>> regs;
+  for (int i = 0; i < kNumRegisters; i++) {
+    regs.push_back(std::make_unique<Register<uint32_t>>(&arch_state,
+                                                        absl::StrCat("x", i)));
+  }
+  std::unique_ptr<Instruction> insts[kNumInstructions];
+  for (int i = 0; i < kNumInstructions; i++) {
+    insts[i] = std::make_unique<Instruction>(i * 4, &arch_state);
+    insts[i]->AppendSource(regs[i % kNumRegisters]->CreateSourceOperand());
+    insts[i]->AppendSource(
+        regs[(i + 1) % kNumRegisters]->CreateSourceOperand());
+    insts[i]->AppendDestination(
+        regs[(i + 2) % kNumRegisters]->CreateDestinationOperand(0));
+    insts[i]->set_semantic_function(semantic_function);
+  }
+  for (auto s : state) {
+    for (auto& inst : insts) {
+      inst->Execute(nullptr);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNumInstructions);
+}
+
+void BM_ExecuteRegisterBinaryOp(benchmark::State& state) {
+  ExecuteRegisterAdd(state, &AddSemanticFunction);
+}
+BENCHMARK(BM_ExecuteRegisterBinaryOp);
+
+void BM_ExecuteRegisterBinaryOpStdFunction(benchmark::State& state) {
+  ExecuteRegisterAdd(state, &AddStdFunctionSemanticFunction);
+}
+BENCHMARK(BM_ExecuteRegisterBinaryOpStdFunction);
+
+// Applies BinaryVectorOp to vector registers. If the second source operand is
+// an immediate, the source elements are read one at a time, otherwise the
+// operation is applied to the contiguous register values.
+template <bool kImmediate>
+void BM_BinaryVectorOp(benchmark::State& state) {
+  constexpr int kVectorLength = 64;
+  BenchmarkArchState arch_state;
+  VectorRegister<uint32_t, kVectorLength> vreg0(&arch_state, "v0");
+  VectorRegister<uint32_t, kVectorLength> vreg1(&arch_state, "v1");
+  VectorRegister<uint32_t, kVectorLength> vreg2(&arch_state, "v2");
+  Instruction inst(0, &arch_state);
+  inst.AppendSource(vreg0.CreateSourceOperand());
+  if (kImmediate) {
+    inst.AppendSource(new ImmediateOperand<uint32_t>(1));
+  } else {
+    inst.AppendSource(vreg1.CreateSourceOperand());
+  }
+  inst.AppendDestination(vreg2.CreateDestinationOperand(0));
+  for (auto s : state) {
+    BinaryVectorOp<uint32_t>(&inst,
+                             [](uint32_t a, uint32_t b) { return a + b; });
+  }
+  state.SetItemsProcessed(state.iterations() * kVectorLength);
+}
+BENCHMARK(BM_BinaryVectorOp<false>);
+BENCHMARK(BM_BinaryVectorOp<true>);
+
+// Schedules deferred function calls that capture an instruction and a context
+// pointer, like the memory load completions, and advances the function delay
+// line to execute them.
+void BM_FunctionDelayLine(benchmark::State& state) {
+  const int latency = state.range(0);
+  FunctionDelayLine delay_line;
+  Instruction inst(0, nullptr);
+  ReferenceCount* context = nullptr;
+  uint64_t sum = 0;
+  for (auto s : state) {
+    for (int i = 0; i < kNumInstructions; i++) {
+      Instruction* inst_ptr = &inst;
+      delay_line.Add(latency, [inst_ptr, context, &sum]() {
+        sum += inst_ptr->address() + (context == nullptr);
+      });
+      delay_line.Advance();
+    }
+  }
+  while (!delay_line.IsEmpty()) delay_line.Advance();
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations() * kNumInstructions);
+}
+BENCHMARK(BM_FunctionDelayLine)->Arg(1)->Arg(8);
+
+}  // namespace
+}  // namespace generic
+}  // namespace sim
+}  // namespace mpact
+
+BENCHMARK_MAIN();
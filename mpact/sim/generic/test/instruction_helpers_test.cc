@@ -0,0 +1,233 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mpact/sim/generic/instruction_helpers.h"
+
+#include <cstdint>
+#include <functional>
+
+#include "absl/strings/string_view.h"
+#include "googlemock/include/gmock/gmock.h"  // IWYU pragma: keep
+#include "googletest/include/gtest/gtest.h"
+#include "mpact/sim/generic/arch_state.h"
+#include "mpact/sim/generic/immediate_operand.h"
+#include "mpact/sim/generic/instruction.h"
+#include "mpact/sim/generic/register.h"
+#include "mpact/sim/generic/type_helpers.h"
+
+namespace mpact {
+namespace sim {
+namespace generic {
+namespace {
+
+constexpr int kVectorLength = 4;
+
+using ScalarRegister = Register<uint32_t>;
+using WideRegister = Register<uint64_t>;
+using Vector4Register = VectorRegister<uint32_t, kVectorLength>;
+
+class MockArchState : public ArchState {
+ public:
+  explicit MockArchState(absl::string_view id) : ArchState(id, nullptr) {}
+};
+
+uint32_t Add(uint32_t a, uint32_t b) { return a + b; }
+
+// Test fixture with instructions that read from and write to registers.
+class InstructionHelpersTest : public testing::Test {
+ protected:
+  InstructionHelpersTest() {
+    arch_state_ = new MockArchState("MockArchState");
+    for (int i = 0; i < 3; i++) {
+      sreg_[i] = new ScalarRegister(arch_state_, "S");
+      vreg_[i] = new Vector4Register(arch_state_, "V");
+    }
+    wreg_ = new WideRegister(arch_state_, "W");
+    sreg_[0]->data_buffer()->Set<uint32_t>(0, 0xffff'fffe);
+    sreg_[1]->data_buffer()->Set<uint32_t>(0, 3);
+    for (int i = 0; i < kVectorLength; i++) {
+      vreg_[0]->data_buffer()->Set<uint32_t>(i, i);
+      vreg_[1]->data_buffer()->Set<uint32_t>(i, 10 * i);
+      vreg_[2]->data_buffer()->Set<uint32_t>(i, 100 * i);
+    }
+    scalar_inst_ = MakeInstruction(sreg_, 2, sreg_[2]);
+    wide_inst_ = MakeInstruction(sreg_, 2, wreg_);
+    vector_inst_ = MakeInstruction(vreg_, 3, vreg_[0]);
+  }
+
+  ~InstructionHelpersTest() override {
+    scalar_inst_->DecRef();
+    wide_inst_->DecRef();
+    vector_inst_->DecRef();
+    for (int i = 0; i < 3; i++) {
+      delete sreg_[i];
+      delete vreg_[i];
+    }
+    delete wreg_;
+    delete arch_state_;
+  }
+
+  // Creates an instruction with num_sources register source operands and a
+  // zero latency register destination operand.
+  template <typename SourceRegister, typename DestinationRegister>
+  Instruction* MakeInstruction(SourceRegister* const* sources, int num_sources,
+                               DestinationRegister* dest) {
+    auto* inst = new Instruction(0, arch_state_);
+    for (int i = 0; i < num_sources; i++) {
+      inst->AppendSource(sources[i]->CreateSourceOperand());
+    }
+    inst->AppendDestination(dest->CreateDestinationOperand(0));
+    return inst;
+  }
+
+  uint32_t ScalarResult() const {
+    return sreg_[2]->data_buffer()->Get<uint32_t>(0);
+  }
+  uint64_t WideResult() const { return wreg_->data_buffer()->Get<uint64_t>(0); }
+
+  MockArchState* arch_state_;
+  ScalarRegister* sreg_[3];
+  WideRegister* wreg_;
+  Vector4Register* vreg_[3];
+  Instruction* scalar_inst_;
+  Instruction* wide_inst_;
+  Instruction* vector_inst_;
+};
+
+// BinaryOp with callables and with std::function.
+TEST_F(InstructionHelpersTest, BinaryOp) {
+  BinaryOp<uint32_t>(scalar_inst_,
+                     [](uint32_t a, uint32_t b) { return a - b; });
+  EXPECT_EQ(ScalarResult(), 0xffff'fffb);
+  BinaryOp<uint32_t>(scalar_inst_, Add);
+  EXPECT_EQ(ScalarResult(), 1);
+  BinaryOp<uint32_t>(scalar_inst_,
+                     std::function<uint32_t(uint32_t, uint32_t)>(Add));
+  EXPECT_EQ(ScalarResult(), 1);
+  // The argument types default to the preceding argument type.
+  BinaryOp<uint64_t, int32_t>(
+      wide_inst_, [](int32_t a, int32_t b) -> uint64_t { return a * b; });
+  EXPECT_EQ(WideResult(), static_cast<uint64_t>(-6));
+  BinaryOp<uint64_t, int32_t>(
+      wide_inst_, std::function<uint64_t(int32_t, int32_t)>(
+                      [](int32_t a, int32_t b) -> uint64_t { return a + b; }));
+  EXPECT_EQ(WideResult(), 1);
+  BinaryOp<uint64_t, uint32_t, int32_t>(
+      wide_inst_, [](uint32_t a, int32_t b) -> uint64_t {
+        return static_cast<uint64_t>(a) + b;
+      });
+  EXPECT_EQ(WideResult(), 0x1'0000'0001);
+  BinaryOp<uint64_t, uint32_t, int32_t>(
+      wide_inst_,
+      std::function<uint64_t(uint32_t, int32_t)>(
+          [](uint32_t a, int32_t b) -> uint64_t { return a - b; }));
+  EXPECT_EQ(WideResult(), 0xffff'fffb);
+}
+
+// UnaryOp with callables and with std::function.
+TEST_F(InstructionHelpersTest, UnaryOp) {
+  UnaryOp<uint32_t>(scalar_inst_, [](uint32_t a) { return ~a; });
+  EXPECT_EQ(ScalarResult(), 1);
+  UnaryOp<uint32_t>(scalar_inst_,
+                    std::function<uint32_t(uint32_t)>([](uint32_t a) {
+                      return a + 1;
+                    }));
+  EXPECT_EQ(ScalarResult(), 0xffff'ffff);
+  UnaryOp<uint64_t, int32_t>(
+      wide_inst_, [](int32_t a) { return static_cast<uint64_t>(a); });
+  EXPECT_EQ(WideResult(), static_cast<uint64_t>(-2));
+  UnaryOp<uint64_t, uint32_t>(
+      wide_inst_, std::function<uint64_t(uint32_t)>(
+                      [](uint32_t a) { return static_cast<uint64_t>(a); }));
+  EXPECT_EQ(WideResult(), 0xffff'fffe);
+}
+
+// The vector helpers with callables and with std::function.
+TEST_F(InstructionHelpersTest, VectorOps) {
+  BinaryVectorOp<uint32_t>(vector_inst_, Add);
+  auto* result = vreg_[0]->data_buffer();
+  for (int i = 0; i < kVectorLength; i++) {
+    EXPECT_EQ(result->Get<uint32_t>(i), 11 * i);
+  }
+  UnaryVectorOp<uint32_t>(
+      vector_inst_,
+      std::function<uint32_t(uint32_t)>([](uint32_t a) { return a + 1; }));
+  result = vreg_[0]->data_buffer();
+  for (int i = 0; i < kVectorLength; i++) {
+    EXPECT_EQ(result->Get<uint32_t>(i), 11 * i + 1);
+  }
+  TernaryVectorOp<uint32_t>(vector_inst_, [](uint32_t a, uint32_t b,
+                                             uint32_t c) { return a + b + c; });
+  result = vreg_[0]->data_buffer();
+  for (int i = 0; i < kVectorLength; i++) {
+    EXPECT_EQ(result->Get<uint32_t>(i), 121 * i + 1);
+  }
+  TernaryVectorOp<uint32_t>(
+      vector_inst_, std::function<uint32_t(uint32_t, uint32_t, uint32_t)>(
+                        [](uint32_t a, uint32_t b, uint32_t c) { return c; }));
+  result = vreg_[0]->data_buffer();
+  for (int i = 0; i < kVectorLength; i++) {
+    EXPECT_EQ(result->Get<uint32_t>(i), 100 * i);
+  }
+}
+
+// Vector helpers with source operands that do not provide direct access to
+// all elements read the elements one at a time.
+TEST_F(InstructionHelpersTest, VectorOpsMixedSources) {
+  auto* inst = new Instruction(0, arch_state_);
+  inst->AppendSource(vreg_[1]->CreateSourceOperand());
+  inst->AppendSource(new ImmediateOperand<uint32_t>(5));
+  inst->AppendSource(sreg_[1]->CreateSourceOperand());
+  inst->AppendDestination(vreg_[0]->CreateDestinationOperand(0));
+  BinaryVectorOp<uint32_t>(inst, Add);
+  auto* result = vreg_[0]->data_buffer();
+  for (int i = 0; i < kVectorLength; i++) {
+    EXPECT_EQ(result->Get<uint32_t>(i), 10 * i + 5);
+  }
+  // Reading the vector register as a different size element type.
+  BinaryVectorOp<uint32_t, uint64_t>(
+      inst, [](uint64_t a, uint64_t b) -> uint32_t { return a * b; });
+  result = vreg_[0]->data_buffer();
+  for (int i = 0; i < kVectorLength; i++) {
+    EXPECT_EQ(result->Get<uint32_t>(i), 50 * i);
+  }
+  inst->DecRef();
+}
+
+// Source spans are only provided for integral and floating point types, even
+// if other types have the same size as the register elements.
+TEST_F(InstructionHelpersTest, SourceSpanTypes) {
+  VectorRegister<uint16_t, kVectorLength> hreg(arch_state_, "H");
+  VectorRegister<uint8_t, kVectorLength> breg(arch_state_, "B");
+  auto* inst = new Instruction(0, arch_state_);
+  inst->AppendSource(vreg_[1]->CreateSourceOperand());
+  inst->AppendSource(hreg.CreateSourceOperand());
+  inst->AppendSource(breg.CreateSourceOperand());
+  EXPECT_EQ(internal::GetSourceSpan<uint32_t>(inst, 0, kVectorLength).size(),
+            kVectorLength);
+  EXPECT_EQ(internal::GetSourceSpan<float>(inst, 0, kVectorLength).size(),
+            kVectorLength);
+  EXPECT_EQ(internal::GetSourceSpan<int16_t>(inst, 1, kVectorLength).size(),
+            kVectorLength);
+  EXPECT_TRUE(internal::GetSourceSpan<HalfFP>(inst, 1, kVectorLength).empty());
+  EXPECT_EQ(internal::GetSourceSpan<uint8_t>(inst, 2, kVectorLength).size(),
+            kVectorLength);
+  EXPECT_TRUE(internal::GetSourceSpan<bool>(inst, 2, kVectorLength).empty());
+  inst->DecRef();
+}
+
+}  // namespace
+}  // namespace generic
+}  // namespace sim
+}  // namespace mpact
@@ -15,6 +15,7 @@
 #include "mpact/sim/generic/instruction.h"
 
 #include <memory>
+#include <vector>
 
 #include "absl/types/span.h"
 #include "googlemock/include/gmock/gmock.h"
@@ -31,6 +32,12 @@ struct InstructionContext : public ReferenceCount {
   int* value;
 };
 
+// Plain semantic function that increments the value in the context.
+void IncrementContextValue(Instruction* inst) {
+  auto context = static_cast<InstructionContext*>(inst->context());
+  ++(*context->value);
+}
+
 // Tests values of the instruction properties.
 TEST(InstructionTest, BasicProperties) {
   auto inst = std::make_unique<Instruction>(0x1000, nullptr);
@@ -67,6 +74,87 @@ TEST(InstructionTest, SemanticFunction) {
   EXPECT_EQ(context_value, 2);
 }
 
+// Tests that plain functions and captureless lambdas are called directly,
+// whereas other callables are called through std::function.
+TEST(InstructionTest, DirectSemanticFunction) {
+  auto inst = std::make_unique<Instruction>(0x1000, nullptr);
+  int context_value = 0;
+  auto my_context = std::make_unique<InstructionContext>();
+  my_context->value = &context_value;
+
+  // No semantic function set yet.
+  EXPECT_FALSE(inst->has_direct_semantic_function());
+
+  // Function pointer.
+  inst->set_semantic_function(&IncrementContextValue);
+  EXPECT_TRUE(inst->has_direct_semantic_function());
+  inst->Execute(my_context.get());
+  EXPECT_EQ(context_value, 1);
+
+  // Captureless lambda.
+  inst->set_semantic_function([](Instruction* inst) {
+    auto context = static_cast<InstructionContext*>(inst->context());
+    *context->value += 10;
+  });
+  EXPECT_TRUE(inst->has_direct_semantic_function());
+  inst->Execute(my_context.get());
+  EXPECT_EQ(context_value, 11);
+
+  // std::function wrapping a function pointer.
+  inst->set_semantic_function(
+      Instruction::SemanticFunction(&IncrementContextValue));
+  EXPECT_TRUE(inst->has_direct_semantic_function());
+  inst->Execute(my_context.get());
+  EXPECT_EQ(context_value, 12);
+
+  // Lambda with a capture.
+  int my_value = 0;
+  inst->set_semantic_function([&my_value](Instruction* inst) { my_value++; });
+  EXPECT_FALSE(inst->has_direct_semantic_function());
+  inst->Execute(my_context.get());
+  EXPECT_EQ(my_value, 1);
+  EXPECT_EQ(context_value, 12);
+
+  // Pre-bound semantic functions, as used by the generated decoders.
+  std::vector<PreboundSemanticFunction> semfuncs = {
+      &IncrementContextValue, [&my_value](Instruction*) { my_value++; }};
+  EXPECT_NE(semfuncs[0].function_ptr(), nullptr);
+  EXPECT_EQ(semfuncs[1].function_ptr(), nullptr);
+  inst->set_semantic_function(semfuncs[0]);
+  EXPECT_TRUE(inst->has_direct_semantic_function());
+  inst->Execute(my_context.get());
+  EXPECT_EQ(context_value, 13);
+  inst->set_semantic_function(semfuncs[1]);
+  EXPECT_FALSE(inst->has_direct_semantic_function());
+  inst->Execute(my_context.get());
+  EXPECT_EQ(my_value, 2);
+}
+
+// Tests that the disassembly function is only called when the disassembly
+// string is first requested.
+int disasm_calls = 0;
+void SetDisasm(Instruction* inst) {
+  disasm_calls++;
+  inst->SetDisassemblyString("add r1, r2, r3");
+}
+
+TEST(InstructionTest, LazyDisassembly) {
+  auto inst = std::make_unique<Instruction>(0x1000, nullptr);
+  EXPECT_EQ(inst->AsString(), "");
+  disasm_calls = 0;
+  inst->SetDisassemblyFunction(&SetDisasm);
+  EXPECT_EQ(disasm_calls, 0);
+  EXPECT_EQ(inst->AsString(), "add r1, r2, r3");
+  EXPECT_EQ(disasm_calls, 1);
+  EXPECT_EQ(inst->AsString(), "add r1, r2, r3");
+  EXPECT_EQ(disasm_calls, 1);
+  // Setting the string directly overrides a pending disassembly function.
+  inst->SetDisassemblyFunction(&SetDisasm);
+  inst->SetDisassemblyString("nop");
+  EXPECT_EQ(inst->AsString(), "nop");
+  EXPECT_EQ(disasm_calls, 1);
+}
+
 // Tests adding instructions to the ChildBundle list.
 TEST(InstructionTest, ChildBundle) {
   auto inst = std::make_unique<Instruction>(0x1000, nullptr);
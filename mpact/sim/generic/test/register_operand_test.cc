@@ -14,6 +14,7 @@
 
 #include <any>
 #include <cstdint>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "absl/types/any.h"
@@ -21,6 +22,8 @@
 #include "googletest/include/gtest/gtest.h"
 #include "mpact/sim/generic/arch_state.h"
 #include "mpact/sim/generic/data_buffer.h"
+#include "mpact/sim/generic/instruction.h"
+#include "mpact/sim/generic/instruction_helpers.h"
 #include "mpact/sim/generic/operand_interface.h"
 #include "mpact/sim/generic/register.h"
 #include "mpact/sim/generic/simple_resource.h"
@@ -34,6 +37,29 @@ using ScalarRegister = Register<uint32_t>;
 using Vector8Register = VectorRegister<uint32_t, 8>;
 using ScalarReservedRegister = ReservedRegister<uint32_t>;
 
+// Register type that counts the writes to the register.
+class CountingRegisterBase : public RegisterBase {
+ public:
+  void SetDataBuffer(DataBuffer* db) override {
+    num_writes_++;
+    RegisterBase::SetDataBuffer(db);
+  }
+
+  int num_writes() const { return num_writes_; }
+
+ protected:
+  CountingRegisterBase(ArchState* state, absl::string_view name,
+                       const std::vector<int>& shape, int unit_size)
+      : RegisterBase(state, name, shape, unit_size) {}
+
+ private:
+  int num_writes_ = 0;
+};
+
+using CountingRegister =
+    StateItem<CountingRegisterBase, uint32_t, RegisterSourceOperand<uint32_t>,
+              RegisterDestinationOperand<uint32_t>>;
+
 static constexpr char kTestPoolName[] = "TestPool";
 static constexpr int kTestPoolSize = 35;
 
@@ -82,12 +108,14 @@ TEST_F(RegisterOperandTest, SourceOperandInitialization) {
   EXPECT_EQ(std::any_cast<RegisterBase*>(s_src_op->GetObject()),
             static_cast<RegisterBase*>(sreg_));
   EXPECT_EQ(s_src_op->shape(), sreg_->shape());
+  EXPECT_EQ(s_src_op->extent(0), 1);
   delete s_src_op;
 
   auto v_src_op = vreg_->CreateSourceOperand();
   EXPECT_EQ(std::any_cast<RegisterBase*>(v_src_op->GetObject()),
             static_cast<RegisterBase*>(vreg_));
   EXPECT_EQ(v_src_op->shape(), vreg_->shape());
+  EXPECT_EQ(v_src_op->extent(0), 8);
   delete v_src_op;
 
   auto r_src_op = rreg_->CreateSourceOperand();
@@ -109,6 +137,7 @@ TEST_F(RegisterOperandTest, DestinationOperandInitialization) {
   auto v_dst_op = vreg_->CreateDestinationOperand(4);
   EXPECT_EQ(v_dst_op->latency(), 4);
   EXPECT_EQ(v_dst_op->shape(), vreg_->shape());
+  EXPECT_EQ(v_dst_op->extent(0), 8);
   EXPECT_EQ(std::any_cast<RegisterBase*>(v_dst_op->GetObject()),
             static_cast<RegisterBase*>(vreg_));
   delete v_dst_op;
@@ -247,6 +276,122 @@ TEST_F(RegisterOperandTest, ReservedRegisterValueWriteAndRead) {
   delete dst_op;
 }
 
+// Tests that register source operands provide direct access to the register
+// value, both through the operand and through GetInstructionSource.
+TEST_F(RegisterOperandTest, DirectAccess) {
+  auto* s_src_op = sreg_->CreateSourceOperand();
+  auto* v_src_op = vreg_->CreateSourceOperand();
+  EXPECT_EQ(s_src_op->kind(), SourceOperandInterface::Kind::kRegister);
+  // Direct access is only provided for types of the same size as the register
+  // element type.
+  EXPECT_TRUE(s_src_op->HasDirectAccess<uint32_t>());
+  EXPECT_TRUE(s_src_op->HasDirectAccess<int32_t>());
+  EXPECT_TRUE(s_src_op->HasDirectAccess<float>());
+  EXPECT_FALSE(s_src_op->HasDirectAccess<uint16_t>());
+  EXPECT_FALSE(s_src_op->HasDirectAccess<uint64_t>());
+
+  auto* inst = new Instruction(0x1000, arch_state_);
+  inst->AppendSource(s_src_op);
+  inst->AppendSource(v_src_op);
+
+  // Write new values to the registers.
+  auto* s_dst_op = sreg_->CreateDestinationOperand(1);
+  auto* v_dst_op = vreg_->CreateDestinationOperand(1);
+  DataBuffer* db = s_dst_op->AllocateDataBuffer();
+  db->Set<uint32_t>(0, 0xDEADBEEF);
+  db->Submit();
+  db = v_dst_op->AllocateDataBuffer();
+  for (int i = 0; i < vreg_->shape()[0]; i++) {
+    db->Set<uint32_t>(i, 0x8000'0000 | i);
+  }
+  db->Submit();
+  arch_state_->AdvanceDelayLines();
+
+  // The operands see the new data buffers.
+  EXPECT_EQ(s_src_op->GetDirect<uint32_t>(0), 0xDEADBEEF);
+  EXPECT_EQ(GetInstructionSource<uint32_t>(inst, 0), 0xDEADBEEF);
+  EXPECT_EQ(GetInstructionSource<int32_t>(inst, 0),
+            static_cast<int32_t>(0xDEADBEEF));
+  // Types with a different size use the virtual interface.
+  EXPECT_EQ(GetInstructionSource<uint64_t>(inst, 0), 0xDEADBEEF);
+  EXPECT_EQ(GetInstructionSource<int64_t>(inst, 0),
+            static_cast<int32_t>(0xDEADBEEF));
+  EXPECT_EQ(GetInstructionSource<uint16_t>(inst, 0), 0xBEEF);
+  for (int i = 0; i < vreg_->shape()[0]; i++) {
+    EXPECT_EQ(GetInstructionSource<uint32_t>(inst, 1, i), 0x8000'0000 | i);
+    EXPECT_EQ(GetInstructionSource<int64_t>(inst, 1, i),
+              static_cast<int32_t>(0x8000'0000 | i));
+  }
+
+  inst->DecRef();
+  delete s_dst_op;
+  delete v_dst_op;
+}
+
+// Tests that zero latency writes using SetValue update the register value in
+// place when possible.
+TEST_F(RegisterOperandTest, SetValueInPlace) {
+  auto* dst_op = sreg_->CreateDestinationOperand(0);
+  auto* dst_op_latency = sreg_->CreateDestinationOperand(1);
+  auto* r_dst_op = rreg_->CreateDestinationOperand(0);
+  EXPECT_TRUE(dst_op->CanSetValueInPlace<uint32_t>());
+  EXPECT_TRUE(dst_op->CanSetValueInPlace<int32_t>());
+  EXPECT_FALSE(dst_op->CanSetValueInPlace<uint64_t>());
+  EXPECT_FALSE(dst_op_latency->CanSetValueInPlace<uint32_t>());
+  // Writes to reserved registers have to release the resource.
+  EXPECT_FALSE(r_dst_op->CanSetValueInPlace<uint32_t>());
+
+  // An in-place write keeps the same data buffer.
+  DataBuffer* db = sreg_->data_buffer();
+  dst_op->SetValue<uint32_t>(0, 0xDEADBEEF);
+  EXPECT_EQ(sreg_->data_buffer(), db);
+  EXPECT_EQ(db->Get<uint32_t>(0), 0xDEADBEEF);
+
+  // If the data buffer is shared, it is replaced instead.
+  db->IncRef();
+  EXPECT_FALSE(dst_op->CanSetValueInPlace<uint32_t>());
+  dst_op->SetValue<uint32_t>(0, 0xA5A5A5A5);
+  EXPECT_NE(sreg_->data_buffer(), db);
+  EXPECT_EQ(sreg_->data_buffer()->Get<uint32_t>(0), 0xA5A5A5A5);
+  EXPECT_EQ(db->Get<uint32_t>(0), 0xDEADBEEF);
+  db->DecRef();
+
+  // Non-zero latency writes go through the delay line.
+  dst_op_latency->SetValue<uint32_t>(0, 0x12345678);
+  EXPECT_EQ(sreg_->data_buffer()->Get<uint32_t>(0), 0xA5A5A5A5);
+  arch_state_->AdvanceDelayLines();
+  EXPECT_EQ(sreg_->data_buffer()->Get<uint32_t>(0), 0x12345678);
+
+  // The reserved register write releases the resource.
+  rreg_->resource()->Acquire();
+  r_dst_op->SetValue<uint32_t>(0, 0xDEADBEEF);
+  EXPECT_TRUE(rreg_->resource()->IsFree());
+  EXPECT_EQ(rreg_->data_buffer()->Get<uint32_t>(0), 0xDEADBEEF);
+
+  delete dst_op;
+  delete dst_op_latency;
+  delete r_dst_op;
+}
+
+// Tests that zero latency writes by semantic functions to registers that
+// override SetDataBuffer are not performed in place.
+TEST_F(RegisterOperandTest, SetValueOverriddenSetDataBuffer) {
+  CountingRegister creg(arch_state_, "C0");
+  auto* dst_op = creg.CreateDestinationOperand(0);
+  EXPECT_FALSE(dst_op->CanSetValueInPlace<uint32_t>());
+
+  auto* inst = new Instruction(0x1000, arch_state_);
+  inst->AppendSource(sreg_->CreateSourceOperand());
+  inst->AppendSource(vreg_->CreateSourceOperand());
+  inst->AppendDestination(dst_op);
+  sreg_->data_buffer()->Set<uint32_t>(0, 0x1000);
+  vreg_->data_buffer()->Set<uint32_t>(0, 0x0234);
+  BinaryOp<uint32_t>(inst, [](uint32_t a, uint32_t b) { return a + b; });
+  EXPECT_EQ(creg.num_writes(), 1);
+  EXPECT_EQ(creg.data_buffer()->Get<uint32_t>(0), 0x1234);
+  inst->DecRef();
+}
+
 }  // namespace
 }  // namespace generic
 }  // namespace sim
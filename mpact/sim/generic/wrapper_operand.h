@@ -53,6 +53,7 @@ class WrapperSourceOperand : public SourceOperandInterface {
   std::any GetObject() const override { return std::any(value_); }
   // Return the shape of the MR.
   std::vector<int> shape() const override { return shape_; }
+  int extent(int dimension) const override { return shape_[dimension]; }
   // Return the name of the MR.
   std::string AsString() const override { return value_->AsString(); }
 
@@ -83,6 +84,7 @@ class WrapperDestinationOperand : public DestinationOperandInterface {
   std::any GetObject() const override { return std::any(value_); }
   // Return the shape of the MR.
   std::vector<int> shape() const override { return shape_; }
+  int extent(int dimension) const override { return shape_[dimension]; }
   // Return the name of the MR.
   std::string AsString() const override { return value_->AsString(); }
 
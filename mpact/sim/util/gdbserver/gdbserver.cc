@@ -19,6 +19,7 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <cstddef>
 #include <cstdint>
@@ -55,22 +56,37 @@ constexpr std::string_view kGDBServerVersion =
 // escapes after the command has been "unwrapped".
 std::string UnescapeCommand(std::string_view escaped_command) {
   std::string command;
+  command.reserve(escaped_command.size());
   for (int i = 0; i < escaped_command.size(); ++i) {
     char c = escaped_command[i];
-    if (c == 0x7d) {
+    if ((c == 0x7d) && (i + 1 < escaped_command.size())) {
       c = escaped_command[++i] ^ 0x20;
-      command.push_back(c);
     }
     command.push_back(c);
   }
   return command;
 }
 
+// Appends the binary data to the response, escaping the characters that have
+// special meaning in the GDB packet format.
+void AppendEscapedBinary(absl::Span<const uint8_t> data,
+                         std::string& response) {
+  for (uint8_t byte : data) {
+    if ((byte == '#') || (byte == '$') || (byte == 0x7d) || (byte == '*')) {
+      response.push_back(0x7d);
+      byte ^= 0x20;
+    }
+    response.push_back(static_cast<char>(byte));
+  }
+}
+
 }  // namespace
 
 namespace mpact::sim::util::gdbserver {
 
-LazyRE2 GdbServer::gdb_command_re_{R"(\$([^#]*)#([0-9a-fA-F]{2}))"};
+// The command may contain binary data, so it is not matched as UTF-8.
+LazyRE2 GdbServer::gdb_command_re_{R"(\$([^#]*)#([0-9a-fA-F]{2}))",
+                                   RE2::Latin1};
 LazyRE2 GdbServer::thread_re_{R"(;?thread\:(\d+);?)"};
 LazyRE2 GdbServer::xfer_read_target_re_{
     R"(Xfer\:features\:read\:target\.xml\:([0-9a-fA-F]+),([0-9a-fA-F]+))"};
@@ -95,6 +111,7 @@ GdbServer::GdbServer(
   for (int i = 0; i < core_debug_interfaces_.size(); ++i) {
     halt_reasons_.push_back(*generic::CoreDebugInterface::HaltReason::kNone);
   }
+  gpr_handles_.resize(core_debug_interfaces_.size());
   // Get register widths for each register number.
   auto xml_data = absl::StrSplit(debug_info_.GetGdbTargetXml(), '\n');
   RE2 bitsize_re{R"re2(<reg\s.*bitsize\s*=\s*"(\d+)")re2"};
@@ -212,10 +229,10 @@ bool GdbServer::Connect(int port) {
       return false;
     }
     buffer_[buffer_pos++] = val;
-    // Next read the command until we see a '#'.
+    // Next read the command until we see a '#'. Leave room for the checksum.
     do {
       val = is_->get();
-      if (!is_->good()) {
+      if (!is_->good() || (buffer_pos >= sizeof(buffer_) - 2)) {
         LOG(ERROR) << absl::StrFormat(
             "Failed to receive complete command on port %d received: '%s'",
             port,
@@ -415,7 +432,9 @@ void GdbServer::ParseGdbCommand(std::string_view command) {
       return GdbSelectThread(command);
     case 'k':  // Kill packet.
       return Terminate();
-    case 'm': {  // Read memory.
+    case 'm':    // Read memory.
+    case 'x': {  // Read memory (binary).
+      bool binary = command.front() == 'x';
       command.remove_prefix(1);
       size_t pos = command.find(',');
       if (pos == std::string_view::npos) {
@@ -427,10 +446,12 @@ void GdbServer::ParseGdbCommand(std::string_view command) {
       }
       std::string_view address = command.substr(0, pos);
       std::string_view length = command.substr(pos + 1);
-      GdbReadMemory(address, length);
+      GdbReadMemory(address, length, binary);
       break;
     }
-    case 'M': {  // Write memory.
+    case 'M':    // Write memory.
+    case 'X': {  // Write memory (binary).
+      bool binary = command.front() == 'X';
       command.remove_prefix(1);
       size_t comma_pos = command.find(',');
       if (comma_pos == std::string_view::npos) {
@@ -449,7 +470,7 @@ void GdbServer::ParseGdbCommand(std::string_view command) {
       std::string_view length =
           command.substr(comma_pos + 1, colon_pos - comma_pos - 1);
       std::string_view data = command.substr(colon_pos + 1);
-      return GdbWriteMemory(address, length, data);
+      return GdbWriteMemory(address, length, data, binary);
     }
     case 'p': {  // Read register.
       command.remove_prefix(1);
@@ -832,7 +853,7 @@ void GdbServer::GdbThreadInfo() {
 }
 
 void GdbServer::GdbReadMemory(std::string_view address_str,
-                              std::string_view length_str) {
+                              std::string_view length_str, bool binary) {
   uint64_t address;
   bool success = absl::SimpleHexAtoi(address_str, &address);
   if (!success) {
@@ -852,9 +873,10 @@ void GdbServer::GdbReadMemory(std::string_view address_str,
     return Respond("E01");
   }
   if (length > sizeof(buffer_)) {
-    LOG(ERROR) << "Length exceeds buffer size of 4096";
+    LOG(ERROR) << "Length exceeds buffer size of " << sizeof(buffer_);
     if (error_message_supported_) {
-      return SendError("length exceeds buffer size of 4096");
+      return SendError(
+          absl::StrCat("length exceeds buffer size of ", sizeof(buffer_)));
     }
     return Respond("E01");
   }
@@ -867,6 +889,14 @@ void GdbServer::GdbReadMemory(std::string_view address_str,
     return Respond("E01");
   }
   std::string response;
+  if (binary) {
+    response.reserve(result.value() + 1);
+    response.push_back('b');
+    AppendEscapedBinary(absl::MakeConstSpan(buffer_, result.value()),
+                        response);
+    return Respond(response);
+  }
+  response.reserve(2 * result.value());
   for (int i = 0; i < result.value(); ++i) {
     absl::StrAppend(&response, absl::Hex(buffer_[i], absl::kZeroPad2));
   }
@@ -875,7 +905,7 @@ void GdbServer::GdbReadMemory(std::string_view address_str,
 
 void GdbServer::GdbWriteMemory(std::string_view address_str,
                                std::string_view length_str,
-                               std::string_view data) {
+                               std::string_view data, bool binary) {
   uint64_t address;
   bool success = absl::SimpleHexAtoi(address_str, &address);
   if (!success) {
@@ -895,21 +925,30 @@ void GdbServer::GdbWriteMemory(std::string_view address_str,
     return Respond("E01");
   }
   if (length > sizeof(buffer_)) {
-    LOG(ERROR) << "Length exceeds buffer size of 4096";
+    LOG(ERROR) << "Length exceeds buffer size of " << sizeof(buffer_);
     if (error_message_supported_) {
-      return SendError("length exceeds buffer size of 4096");
+      return SendError(
+          absl::StrCat("length exceeds buffer size of ", sizeof(buffer_)));
     }
     return Respond("E01");
   }
+  // A zero length write is used by the client to probe for packet support.
+  if (length == 0) return Respond("OK");
   int num_bytes = 0;
-  for (int i = 0; (i < length) && (data.size() >= 2); ++i) {
-    num_bytes++;
-    std::string_view byte = data.substr(0, 2);
-    data.remove_prefix(2);
-    uint32_t value_tmp;
-    (void)absl::SimpleHexAtoi(byte, &value_tmp);
-    uint8_t value = static_cast<uint8_t>(value_tmp);
-    buffer_[i] = value;
+  if (binary) {
+    // The data has already been unescaped, so it can be copied directly.
+    num_bytes = std::min<size_t>(length, data.size());
+    std::memcpy(buffer_, data.data(), num_bytes);
+  } else {
+    for (int i = 0; (i < length) && (data.size() >= 2); ++i) {
+      num_bytes++;
+      std::string_view byte = data.substr(0, 2);
+      data.remove_prefix(2);
+      uint32_t value_tmp;
+      (void)absl::SimpleHexAtoi(byte, &value_tmp);
+      uint8_t value = static_cast<uint8_t>(value_tmp);
+      buffer_[i] = value;
+    }
   }
   if (num_bytes != length) {
     LOG(ERROR) << "Length does not match data size";
@@ -937,9 +976,49 @@ void GdbServer::GdbWriteMemory(std::string_view address_str,
   Respond("OK");
 }
 
+bool GdbServer::ResolveGprHandles(int thread_index) {
+  GprHandles& gprs = gpr_handles_[thread_index];
+  if (gprs.resolved) return gprs.valid;
+  gprs.resolved = true;
+  for (int i = debug_info_.GetFirstGpr(); i <= debug_info_.GetLastGpr(); ++i) {
+    auto it = debug_info_.debug_register_map().find(i);
+    if (it == debug_info_.debug_register_map().end()) continue;
+    // Registers wider than 64 bits have to be accessed through their data
+    // buffers.
+    int byte_width = debug_info_.GetRegisterByteWidth(i);
+    if ((byte_width <= 0) ||
+        (byte_width > static_cast<int>(sizeof(uint64_t)))) {
+      return false;
+    }
+    auto result =
+        core_debug_interfaces_[thread_index]->GetRegisterHandle(it->second);
+    if (!result.ok()) return false;
+    gprs.handles.push_back(result.value());
+    gprs.byte_widths.push_back(byte_width);
+  }
+  gprs.values.resize(gprs.handles.size());
+  gprs.valid = true;
+  return true;
+}
+
 void GdbServer::GdbReadGprRegisters(int thread_id) {
   int thread_index = thread_id - 1;
   std::string response;
+  if (ResolveGprHandles(thread_index)) {
+    GprHandles& gprs = gpr_handles_[thread_index];
+    auto status = core_debug_interfaces_[thread_index]->ReadRegisters(
+        gprs.handles, absl::MakeSpan(gprs.values));
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to read registers: " << status.message();
+      return SendError(status.message());
+    }
+    for (size_t i = 0; i < gprs.values.size(); ++i) {
+      absl::StrAppend(&response,
+                      HexEncodeNumberInTargetEndianness(
+                          gprs.byte_widths[i] * 8, gprs.values[i]));
+    }
+    return Respond(response);
+  }
   for (int i = debug_info_.GetFirstGpr(); i <= debug_info_.GetLastGpr(); ++i) {
     auto it = debug_info_.debug_register_map().find(i);
     // If the register is not found, go to the next one (assume there is a
@@ -961,6 +1040,35 @@ void GdbServer::GdbReadGprRegisters(int thread_id) {
 
 void GdbServer::GdbWriteGprRegisters(int thread_id, std::string_view data) {
   int thread_index = thread_id - 1;
+  int num_gprs = debug_info_.GetLastGpr() - debug_info_.GetFirstGpr() + 1;
+  if (ResolveGprHandles(thread_index) &&
+      (gpr_handles_[thread_index].handles.size() ==
+       static_cast<size_t>(num_gprs))) {
+    GprHandles& gprs = gpr_handles_[thread_index];
+    for (size_t i = 0; i < gprs.values.size(); ++i) {
+      // The register values are in target (little endian) byte order.
+      uint64_t value = 0;
+      for (int byte = 0; byte < gprs.byte_widths[i]; ++byte) {
+        if (data.empty()) {
+          LOG(ERROR) << "Invalid data format";
+          return SendError("Invalid data format");
+        }
+        std::string_view byte_str = data.substr(0, 2);
+        data.remove_prefix(byte_str.size());
+        uint32_t byte_value;
+        (void)absl::SimpleHexAtoi(byte_str, &byte_value);
+        value |= static_cast<uint64_t>(byte_value & 0xff) << (byte * 8);
+      }
+      gprs.values[i] = value;
+    }
+    auto status = core_debug_interfaces_[thread_index]->WriteRegisters(
+        gprs.handles, gprs.values);
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to write registers: " << status.message();
+      return SendError(status.message());
+    }
+    return Respond("OK");
+  }
   for (int i = debug_info_.GetFirstGpr(); i <= debug_info_.GetLastGpr(); ++i) {
     auto it = debug_info_.debug_register_map().find(i);
     if (it == debug_info_.debug_register_map().end()) {
@@ -1323,7 +1431,8 @@ void GdbServer::GdbSupported(std::string_view command) {
   }
   std::string response;
   absl::StrAppend(
-      &response, "PacketSize=2000;multi-wp-addr-",
+      &response, absl::StrFormat("PacketSize=%x", kGdbPacketSize),
+      ";binary-upload+;multi-wp-addr-",
       ";multiprocess-;hwbreak-;qRelocInsn-;fork-events-;exec-events-"
       ";vContSupported+;QThreadEvents-;QThreadOptions-;no-resumed-"
       ";memory-tagging-;vfork-events-;QStartNoAckMode+;swbreak+;watch+"
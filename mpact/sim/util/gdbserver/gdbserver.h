@@ -19,6 +19,9 @@
 #ifndef MPACT_SIM_UTIL_GDBSERVER_GDBSERVER_H_
 #define MPACT_SIM_UTIL_GDBSERVER_GDBSERVER_H_
 
+#include <unistd.h>
+
+#include <cerrno>
 #include <cstdint>
 #include <cstdio>
 #include <istream>
@@ -38,37 +41,70 @@ namespace mpact::sim::util::gdbserver {
 
 using ::mpact::sim::generic::DebugInfo;
 
+// Maximum size of a packet exchanged with the GDB client, advertised to the
+// client in the qSupported response.
+inline constexpr int kGdbPacketSize = 64 * 1024;
+
 // This class is used to provide a streambuf interface to a socket file
 // descriptor, so that it can be used to access a socket as an istream/ostream.
-// The overflow and underflow methods are the bare minimum that's required to
-// implement to make this happen. No buffering is performed. This streambuf
-// does not expand \n to \r\n or vice versa.
+// Both input and output are buffered, so that a packet is transferred with a
+// small number of read/write system calls. Output is sent to the socket when
+// the buffer is full, or when the stream is flushed, which is done at the end
+// of each packet. This streambuf does not expand \n to \r\n or vice versa.
 class GdbSocketStreambuf : public std::streambuf {
  public:
-  explicit GdbSocketStreambuf(int fd) : fd_(fd) {}
+  explicit GdbSocketStreambuf(int fd) : fd_(fd) {
+    setp(out_buffer_, out_buffer_ + sizeof(out_buffer_));
+    setg(in_buffer_, in_buffer_, in_buffer_);
+  }
   ~GdbSocketStreambuf() override { close(fd_); }
 
-  // On overflow write character to the socket fd.
-  int overflow(int c) override {
-    if (c == EOF) {
-      close(fd_);
-      return c;
+ protected:
+  // On overflow write the buffered characters to the socket fd, then buffer c.
+  int_type overflow(int_type c) override {
+    if (!FlushOutput()) return traits_type::eof();
+    if (traits_type::eq_int_type(c, traits_type::eof())) {
+      return traits_type::not_eof(c);
     }
-    write(fd_, &c, 1);
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
     return c;
   }
 
-  // On underflow read character from the socket fd.
-  std::streambuf::int_type underflow() override {
-    int count = read(fd_, &ch_, 1);
-    if (count == 0) return traits_type::eof();
-    setg(&ch_, &ch_, &ch_ + 1);
-    return traits_type::to_int_type(ch_);
+  // Write the buffered characters to the socket fd.
+  int sync() override { return FlushOutput() ? 0 : -1; }
+
+  // On underflow read as many characters as are available (up to the buffer
+  // size) from the socket fd.
+  int_type underflow() override {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+    ssize_t count;
+    do {
+      count = read(fd_, in_buffer_, sizeof(in_buffer_));
+    } while ((count < 0) && (errno == EINTR));
+    if (count <= 0) return traits_type::eof();
+    setg(in_buffer_, in_buffer_, in_buffer_ + count);
+    return traits_type::to_int_type(*gptr());
   }
 
  private:
-  char ch_;
+  bool FlushOutput() {
+    char* data = pbase();
+    while (data < pptr()) {
+      ssize_t count = write(fd_, data, pptr() - data);
+      if (count < 0) {
+        if (errno == EINTR) continue;
+        return false;
+      }
+      data += count;
+    }
+    setp(out_buffer_, out_buffer_ + sizeof(out_buffer_));
+    return true;
+  }
+
   int fd_;
+  char in_buffer_[kGdbPacketSize];
+  char out_buffer_[kGdbPacketSize];
 };
 
 class GdbServer {
@@ -127,11 +163,17 @@ class GdbServer {
   void GdbSelectThread(std::string_view command);
   // Return the thread info.
   void GdbThreadInfo();
-  // Read memory from the simulator.
-  void GdbReadMemory(std::string_view address, std::string_view length);
-  // Write memory to the simulator.
+  // Read memory from the simulator. If binary is true, the data is sent as
+  // escaped binary data ('x' packet) instead of hex encoded ('m' packet).
+  void GdbReadMemory(std::string_view address, std::string_view length,
+                     bool binary);
+  // Write memory to the simulator. If binary is true, the data is unescaped
+  // binary data ('X' packet) instead of hex encoded ('M' packet).
   void GdbWriteMemory(std::string_view address, std::string_view length,
-                      std::string_view data);
+                      std::string_view data, bool binary);
+  // Resolves the register handles of the GPRs for the given thread on first
+  // use. Returns false if the GPRs cannot be accessed through handles.
+  bool ResolveGprHandles(int thread_index);
   // Read GPR registers from the simulator.
   void GdbReadGprRegisters(int thread_id);
   // Write GPR registers to the simulator.
@@ -173,7 +215,7 @@ class GdbServer {
   bool no_ack_mode_latch_ = false;
   bool error_message_supported_ = false;
   bool thread_suffix_ = false;
-  uint8_t buffer_[16 * 1024];
+  uint8_t buffer_[kGdbPacketSize];
   bool good_ = false;
   int server_socket_ = -1;
   int cli_fd_ = -1;
@@ -182,6 +224,16 @@ class GdbServer {
   absl::Span<generic::CoreDebugInterface*> core_debug_interfaces_;
   std::vector<int> halt_reasons_;
   absl::flat_hash_map<int, int> reg_bitsize_map_;
+  // Register handles, byte widths and value storage for the GPRs of each
+  // thread, so that the GPRs can be accessed with a single call.
+  struct GprHandles {
+    bool resolved = false;
+    bool valid = false;
+    std::vector<generic::CoreDebugInterface::RegisterHandle> handles;
+    std::vector<int> byte_widths;
+    std::vector<uint64_t> values;
+  };
+  std::vector<GprHandles> gpr_handles_;
   const DebugInfo& debug_info_;
   // Regular expressions used to parse GDB commands.
   // These are static since they are immutable once initialized.
@@ -20,7 +20,6 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 
-#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
@@ -32,6 +31,7 @@
 #include "absl/log/log.h"
 #include "absl/random/random.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
@@ -58,6 +58,7 @@ using HaltReason = ::mpact::sim::generic::CoreDebugInterface::HaltReason;
 using HaltReasonValueType =
     ::mpact::sim::generic::CoreDebugInterface::HaltReasonValueType;
 using ::mpact::sim::generic::Instruction;
+using ::mpact::sim::generic::RegisterHandleTable;
 using ::testing::_;
 using ::testing::Return;
 
@@ -103,6 +104,23 @@ class MockCoreDebugInterface : public CoreDebugInterface {
               (override));
   MOCK_METHOD(absl::StatusOr<std::string>, GetDisassembly, (uint64_t address),
               (override));
+
+  // Indexed register access in terms of the mocked named register accessors.
+  absl::StatusOr<RegisterHandle> GetRegisterHandle(
+      const std::string& name) override {
+    return register_handles_.GetRegisterHandle(name);
+  }
+  absl::Status ReadRegisters(absl::Span<const RegisterHandle> handles,
+                             absl::Span<uint64_t> values) override {
+    return register_handles_.ReadRegisters(handles, values);
+  }
+  absl::Status WriteRegisters(absl::Span<const RegisterHandle> handles,
+                              absl::Span<const uint64_t> values) override {
+    return register_handles_.WriteRegisters(handles, values);
+  }
+
+ private:
+  RegisterHandleTable register_handles_{this};
 };
 
 // Test debug info class.
@@ -427,18 +445,12 @@ TEST_F(GdbServerTest, HaltReason) {
 TEST_F(GdbServerTest, ReadGpr) {
   int port = PickUnusedPortOrDie();
 
-  std::vector<std::array<uint8_t, 8>> reg_storage(32);
-  std::vector<generic::DataBuffer*> dbs;
+  // The GPRs are read by name through the register handle table, once when
+  // resolving the register handles, then once for each 'g' packet.
   for (int i = 0; i < 32; ++i) {
-    generic::DataBuffer* db = db_factory_.Allocate<uint8_t>(8);
-    dbs.push_back(db);
-    uint64_t reg_val = 0x0102030405060700 | i;
-    memcpy(db->raw_ptr(), &reg_val, 8);
-  }
-
-  for (int i = 0; i < 32; ++i) {
-    EXPECT_CALL(mock_core_, GetRegisterDataBuffer(absl::StrCat("x", i)))
-        .WillOnce(Return(dbs[i]));
+    EXPECT_CALL(mock_core_, ReadRegister(absl::StrCat("x", i)))
+        .Times(3)
+        .WillRepeatedly(Return(0x0102030405060700 | i));
   }
 
   std::thread server_fiber([&]() { gdb_server_->Connect(port); });
@@ -459,8 +471,11 @@ TEST_F(GdbServerTest, ReadGpr) {
   EXPECT_EQ(response.substr(0, 16), "0007060504030201");
   // Reg x31: 1f07060504030201
   EXPECT_EQ(response.substr(31 * 16, 16), "1f07060504030201");
-
-  for (auto* db : dbs) db->DecRef();
+  // Read again, using the register handles resolved by the first read.
+  client.SendCommand("g");
+  EXPECT_TRUE(client.ExpectAck());
+  EXPECT_EQ(response, client.ReceiveResponse());
+  client.SendAck();
 
   client.SendCommand("D");
   EXPECT_TRUE(client.ExpectAck());
@@ -536,6 +551,40 @@ TEST_F(GdbServerTest, ReadMemory) {
   server_fiber.join();
 }
 
+TEST_F(GdbServerTest, ReadMemoryBinary) {
+  int port = PickUnusedPortOrDie();
+
+  // Read 4 bytes from 0x1000, two of which have to be escaped.
+  EXPECT_CALL(mock_core_, ReadMemory(0x1000, _, 4))
+      .WillOnce([](uint64_t address, void* buf, size_t length) {
+        uint8_t data[] = {'#', 0x7d, 0x00, 0xff};
+        memcpy(buf, data, 4);
+        return 4;
+      });
+
+  std::thread server_fiber([&]() { gdb_server_->Connect(port); });
+
+  absl::SleepFor(absl::Milliseconds(100));
+
+  GdbTestClient client;
+  ASSERT_TRUE(client.Connect(port));
+
+  client.SendAck();
+  // Read 4 bytes from 0x1000: x1000,4
+  client.SendCommand("x1000,4");
+  EXPECT_TRUE(client.ExpectAck());
+  EXPECT_EQ(std::string("b\x7d\x03\x7d\x5d\x00\xff", 7),
+            client.ReceiveResponse());
+  client.SendAck();
+
+  client.SendCommand("D");
+  EXPECT_TRUE(client.ExpectAck());
+  EXPECT_EQ("OK", client.ReceiveResponse());
+  client.SendAck();
+
+  server_fiber.join();
+}
+
 TEST_F(GdbServerTest, Continue) {
   int port = PickUnusedPortOrDie();
 
@@ -598,15 +647,13 @@ TEST_F(GdbServerTest, Step) {
 TEST_F(GdbServerTest, WriteGpr) {
   int port = PickUnusedPortOrDie();
 
-  std::vector<generic::DataBuffer*> dbs;
   for (int i = 0; i < 32; ++i) {
-    generic::DataBuffer* db = db_factory_.Allocate<uint8_t>(8);
-    dbs.push_back(db);
-  }
-
-  for (int i = 0; i < 32; ++i) {
-    EXPECT_CALL(mock_core_, GetRegisterDataBuffer(absl::StrCat("x", i)))
-        .WillOnce(Return(dbs[i]));
+    // The register is read once when its handle is resolved.
+    EXPECT_CALL(mock_core_, ReadRegister(absl::StrCat("x", i)))
+        .WillOnce(Return(0));
+    EXPECT_CALL(mock_core_,
+                WriteRegister(absl::StrCat("x", i), 0x0102030405060700 | i))
+        .WillOnce(Return(absl::OkStatus()));
   }
 
   std::thread server_fiber([&]() { gdb_server_->Connect(port); });
@@ -626,11 +673,6 @@ TEST_F(GdbServerTest, WriteGpr) {
   EXPECT_EQ("OK", client.ReceiveResponse());
   client.SendAck();
 
-  for (int i = 0; i < 32; ++i) {
-    EXPECT_EQ(dbs[i]->Get<uint64_t>(0), 0x0102030405060700 | i);
-    dbs[i]->DecRef();
-  }
-
   client.SendCommand("D");
   EXPECT_TRUE(client.ExpectAck());
   EXPECT_EQ("OK", client.ReceiveResponse());
@@ -707,6 +749,44 @@ TEST_F(GdbServerTest, WriteMemory) {
   server_fiber.join();
 }
 
+TEST_F(GdbServerTest, WriteMemoryBinary) {
+  int port = PickUnusedPortOrDie();
+
+  // Write 4 bytes to 0x1000, two of which are escaped in the packet.
+  EXPECT_CALL(mock_core_, WriteMemory(0x1000, _, 4))
+      .WillOnce([](uint64_t address, const void* buf,
+                   size_t length) -> absl::StatusOr<size_t> {
+        uint8_t expected[] = {'#', 0x7d, 0x00, 0xff};
+        if (memcmp(buf, expected, 4) == 0) return 4;
+        return absl::InternalError("Memory content mismatch");
+      });
+
+  std::thread server_fiber([&]() { gdb_server_->Connect(port); });
+
+  absl::SleepFor(absl::Milliseconds(100));
+
+  GdbTestClient client;
+  ASSERT_TRUE(client.Connect(port));
+
+  client.SendAck();
+  // A zero length write is used to probe for support of the packet.
+  client.SendCommand("X1000,0:");
+  EXPECT_TRUE(client.ExpectAck());
+  EXPECT_EQ("OK", client.ReceiveResponse());
+  client.SendAck();
+  client.SendCommand(std::string("X1000,4:\x7d\x03\x7d\x5d\x00\xff", 14));
+  EXPECT_TRUE(client.ExpectAck());
+  EXPECT_EQ("OK", client.ReceiveResponse());
+  client.SendAck();
+
+  client.SendCommand("D");
+  EXPECT_TRUE(client.ExpectAck());
+  EXPECT_EQ("OK", client.ReceiveResponse());
+  client.SendAck();
+
+  server_fiber.join();
+}
+
 TEST_F(GdbServerTest, SetSwBreakpoint) {
   int port = PickUnusedPortOrDie();
 
@@ -21,6 +21,8 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "mpact/sim/generic/arch_state.h"
 #include "mpact/sim/util/memory/memory_interface.h"
 
 namespace mpact {
@@ -92,8 +94,12 @@ static void PerformOp(AtomicMemoryOpInterface::Operation op,
   }
 }
 
-// Constructor.
-AtomicMemory::AtomicMemory(MemoryInterface* memory) : memory_(memory) {
+// Constructors.
+AtomicMemory::AtomicMemory(MemoryInterface* memory)
+    : AtomicMemory(memory, /*thread_safe=*/false) {}
+
+AtomicMemory::AtomicMemory(MemoryInterface* memory, bool thread_safe)
+    : memory_(memory), lock_(thread_safe ? &mutex_ : nullptr) {
   // Construct and initialize the local data buffers.
   db1_ = db_factory_.Allocate<uint8_t>(1);
   db1_->set_latency(0);
@@ -117,9 +123,15 @@ AtomicMemory::~AtomicMemory() {
   db8_->DecRef();
 }
 
+// Returns the core that performs the operation.
+static const ArchState* GetCore(const Instruction* inst) {
+  return inst == nullptr ? nullptr : inst->state();
+}
+
 // Forward the load call.
 void AtomicMemory::Load(uint64_t address, DataBuffer* db, Instruction* inst,
                         ReferenceCount* context) {
+  absl::MutexLockMaybe lock(lock_);
   memory_->Load(address, db, inst, context);
 }
 
@@ -127,56 +139,87 @@ void AtomicMemory::Load(uint64_t address, DataBuffer* db, Instruction* inst,
 void AtomicMemory::Load(DataBuffer* address_db, DataBuffer* mask_db,
                         int el_size, DataBuffer* db, Instruction* inst,
                         ReferenceCount* context) {
+  absl::MutexLockMaybe lock(lock_);
   memory_->Load(address_db, mask_db, el_size, db, inst, context);
 }
 
-// Store the value to memory, but remove any matching tag from the tag set.
+// Store the value to memory, but remove any overlapping reservations.
 void AtomicMemory::Store(uint64_t address, DataBuffer* db) {
-  // If the address matches a tag, remove the tag.
-  auto ptr = ll_tag_set_.find(address >> kTagShift);
-  if (ptr != ll_tag_set_.end()) {
-    ll_tag_set_.erase(ptr);
-  }
+  absl::MutexLockMaybe lock(lock_);
+  ClearReservations(address, db->size<uint8_t>());
   memory_->Store(address, db);
 }
 
-// Store the value to memory, but remove any matching tag from the tag set.
+// Store the value to memory, but remove any overlapping reservations.
 void AtomicMemory::Store(DataBuffer* address_db, DataBuffer* mask_db,
                          int el_size, DataBuffer* db) {
-  // If the address matches a tag, remove the tag.
-  for (uint64_t address : address_db->Get<uint64_t>()) {
-    auto ptr = ll_tag_set_.find(address >> kTagShift);
-    if (ptr != ll_tag_set_.end()) {
-      ll_tag_set_.erase(ptr);
-    }
+  absl::MutexLockMaybe lock(lock_);
+  auto addresses = address_db->Get<uint64_t>();
+  if (addresses.size() == 1) {
+    // Unit stride store.
+    ClearReservations(addresses[0],
+                      static_cast<uint64_t>(el_size) * mask_db->size<bool>());
+  } else {
+    for (uint64_t address : addresses) ClearReservations(address, el_size);
   }
   memory_->Store(address_db, mask_db, el_size, db);
 }
 
+void AtomicMemory::ClearReservations(uint64_t address, uint64_t size) {
+  if (ll_reservations_.empty() || (size == 0)) return;
+  uint64_t last_tag = (address + size - 1) >> kTagShift;
+  for (uint64_t tag = address >> kTagShift; tag <= last_tag; tag++) {
+    auto it = ll_reservations_.find(tag);
+    if (it == ll_reservations_.end()) continue;
+    for (const ArchState* core : it->second) core_reservations_.erase(core);
+    ll_reservations_.erase(it);
+  }
+}
+
+void AtomicMemory::ClearReservation(const ArchState* core) {
+  auto it = core_reservations_.find(core);
+  if (it == core_reservations_.end()) return;
+  auto tag_it = ll_reservations_.find(it->second);
+  if (tag_it != ll_reservations_.end()) {
+    tag_it->second.erase(core);
+    if (tag_it->second.empty()) ll_reservations_.erase(tag_it);
+  }
+  core_reservations_.erase(it);
+}
+
 // Perform the atomic memory operation.
 absl::Status AtomicMemory::PerformMemoryOp(uint64_t address, Operation op,
                                            DataBuffer* db, Instruction* inst,
                                            ReferenceCount* context) {
+  absl::MutexLockMaybe lock(lock_);
   int el_size = db->size<uint8_t>();
   db->set_latency(0);
   // Load-linked.
   if (op == Operation::kLoadLinked) {
+    // The reservation replaces any previous reservation of the core.
+    const ArchState* core = GetCore(inst);
     uint64_t tag = address >> kTagShift;
-    if (ll_tag_set_.find(tag) == ll_tag_set_.end()) {
-      ll_tag_set_.insert(tag);
-    }
+    ClearReservation(core);
+    ll_reservations_[tag].insert(core);
+    core_reservations_[core] = tag;
     memory_->Load(address, db, inst, context);
     return absl::OkStatus();
   }
   // Store-conditional.
   if (op == Operation::kStoreConditional) {
+    const ArchState* core = GetCore(inst);
     uint64_t tag = address >> kTagShift;
     int value = 1;
-    // Determine if the store is successful.
-    if (ll_tag_set_.find(tag) != ll_tag_set_.end()) {
-      // Successful SC. Store the value and set result to 0.
+    // Determine if the store is successful. The reservation of the core is
+    // removed whether or not it is.
+    auto it = core_reservations_.find(core);
+    bool success = (it != core_reservations_.end()) && (it->second == tag);
+    ClearReservation(core);
+    if (success) {
+      // Successful SC. Store the value, which removes the reservations of all
+      // cores, and set result to 0.
       memory_->Store(address, db);
-      ll_tag_set_.erase(tag);
+      ClearReservations(address, el_size);
       value = 0;
     }
     auto res = WriteDb(db, value);
@@ -210,6 +253,7 @@ absl::Status AtomicMemory::PerformMemoryOp(uint64_t address, Operation op,
       break;
   }
   if (op == Operation::kAtomicSwap) {
+    ClearReservations(address, el_size);
     memory_->Store(address, tmp_db);
     WriteBack(inst, context, db);
     return absl::OkStatus();
@@ -237,6 +281,7 @@ absl::Status AtomicMemory::PerformMemoryOp(uint64_t address, Operation op,
   }
   // Store the new value to memory, the other value will be written back to the
   // instruction destination.
+  ClearReservations(address, el_size);
   memory_->Store(address, tmp_db);
   WriteBack(inst, context, db);
   return absl::OkStatus();
@@ -17,8 +17,11 @@
 
 #include <cstdint>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "mpact/sim/generic/arch_state.h"
 #include "mpact/sim/generic/data_buffer.h"
 #include "mpact/sim/generic/instruction.h"
 #include "mpact/sim/generic/ref_count.h"
@@ -28,12 +31,28 @@ namespace mpact {
 namespace sim {
 namespace util {
 
+using ::mpact::sim::generic::ArchState;
 using ::mpact::sim::generic::DataBufferFactory;
 using ::mpact::sim::generic::Instruction;
 using ::mpact::sim::generic::ReferenceCount;
 
 // This class builds upon the flat demand memory class to provide atomic
 // memory operations on top of memory loads/stores.
+//
+// If constructed with thread_safe set to true, the class is thread safe, so
+// that it can be shared by cores that are simulated on different host
+// threads, provided that all accesses to the underlying memory go through this
+// class. Otherwise no locking is performed, which is the right choice for
+// single threaded simulations, and when the instance is a target of a thread
+// safe MemoryRouter that serializes the accesses. Load-linked reservations are
+// held per core, identified by the ArchState of the instruction performing the
+// operation (nullptr if there is no instruction). Each core holds at most one
+// reservation, which is replaced by a subsequent load-linked, and removed by
+// any store-conditional by the core. A store-conditional only succeeds if the
+// core holds a reservation for the address, and any store to the reservation
+// granule removes the reservations of all cores.
+// In thread safe mode, load completions that are not delayed are executed
+// while the internal lock is held, so they must not access this memory.
 
 class AtomicMemory : public MemoryInterface, public AtomicMemoryOpInterface {
  public:
@@ -41,6 +60,7 @@ class AtomicMemory : public MemoryInterface, public AtomicMemoryOpInterface {
 
   AtomicMemory() = delete;
   explicit AtomicMemory(MemoryInterface* memory);
+  AtomicMemory(MemoryInterface* memory, bool thread_safe);
   ~AtomicMemory() override;
 
   // Load data from address into the DataBuffer, then schedule the Instruction
@@ -72,6 +92,8 @@ class AtomicMemory : public MemoryInterface, public AtomicMemoryOpInterface {
                                Instruction* inst,
                                ReferenceCount* context) override;
 
+  bool thread_safe() const { return lock_ != nullptr; }
+
  private:
   static constexpr int kTagShift = 3;
   // Write back the result.
@@ -79,12 +101,25 @@ class AtomicMemory : public MemoryInterface, public AtomicMemoryOpInterface {
   // Returns the db of the given size.
   DataBuffer* GetDb(int size) const;
   MemoryInterface* memory_ = nullptr;
-  // Tag store for load linked operations. This is used to track if there is an
-  // intervening store between the ll and the sc instruction. The addresses used
-  // are the memory address shifted right by three. For byte addressable
-  // memories, this means that the address is effectively a uint64_t address,
-  // and that the ll/sc tracking granule is 8 bytes.
-  absl::flat_hash_set<uint64_t> ll_tag_set_;
+  // Removes the reservations that overlap the address range [address,
+  // address + size).
+  void ClearReservations(uint64_t address, uint64_t size);
+  // Removes the reservation held by the core, if any.
+  void ClearReservation(const ArchState* core);
+
+  absl::Mutex mutex_;
+  // Points to mutex_ in thread safe mode, nullptr otherwise.
+  absl::Mutex* lock_ = nullptr;
+  // Reservations for load linked operations. This is used to track if there is
+  // an intervening store between the ll and the sc instruction. The map is
+  // indexed by tags that are the memory address shifted right by three, and
+  // holds the set of cores that have a reservation on that tag. For byte
+  // addressable memories, this means that the address is effectively a
+  // uint64_t address, and that the ll/sc tracking granule is 8 bytes.
+  absl::flat_hash_map<uint64_t, absl::flat_hash_set<const ArchState*>>
+      ll_reservations_;
+  // The tag of the reservation held by each core.
+  absl::flat_hash_map<const ArchState*, uint64_t> core_reservations_;
   // Support accesses of 1 through 8 byte integer types.
   DataBuffer* db1_;
   DataBuffer* db2_;
@@ -14,15 +14,19 @@
 
 #include "mpact/sim/util/memory/flat_demand_memory.h"
 
+#include <sys/mman.h>
+
 #include <algorithm>
 #include <cstdint>
 #include <cstring>
-#include <utility>
 
 #include "absl/base/macros.h"
 #include "absl/log/log.h"
 #include "absl/numeric/bits.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 
 namespace mpact {
 namespace sim {
@@ -34,16 +38,40 @@ FlatDemandMemory::FlatDemandMemory(uint64_t memory_size_in_units,
     : base_address_(base_address),
       max_address_(base_address + memory_size_in_units),
       fill_value_(fill),
-      allocation_byte_size_(kAllocationSize * addressable_unit_size) {
+      allocation_byte_size_(kAllocationSize * addressable_unit_size),
+      radix_root_(new RadixNode()) {
   // Compute the addressable unit shift.
   ABSL_HARDENING_ASSERT(
       (addressable_unit_size != 0) &&
       ((addressable_unit_size & (addressable_unit_size - 1)) == 0));
   addressable_unit_shift_ = absl::bit_width(addressable_unit_size) - 1;
+  // Reserve the memory range in host memory if it is zero filled and not too
+  // large. Anonymous mappings are zero filled.
+  uint64_t max_size_in_units = kMaxHostMappedSize >> addressable_unit_shift_;
+  if ((fill != 0) || (max_address_ <= base_address_) ||
+      (memory_size_in_units > max_size_in_units)) {
+    return;
+  }
+  uint64_t byte_size = memory_size_in_units << addressable_unit_shift_;
+  void* host_memory = mmap(nullptr, byte_size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (host_memory == MAP_FAILED) {
+    LOG(WARNING) << absl::StrFormat(
+        "Failed to reserve %d bytes of host memory, using demand allocated "
+        "blocks instead",
+        byte_size);
+    return;
+  }
+  host_memory_ = static_cast<uint8_t*>(host_memory);
+  host_memory_byte_size_ = byte_size;
 }
 
 // Delete all the allocated blocks.
-FlatDemandMemory::~FlatDemandMemory() { Clear(); }
+FlatDemandMemory::~FlatDemandMemory() {
+  Clear();
+  delete radix_root_;
+  if (host_memory_ != nullptr) munmap(host_memory_, host_memory_byte_size_);
+}
 
 void FlatDemandMemory::Load(uint64_t address, DataBuffer* db, Instruction* inst,
                             ReferenceCount* context) {
@@ -95,17 +123,22 @@ void FlatDemandMemory::Load(DataBuffer* address_db, DataBuffer* mask_db,
   // This is either a gather load, or a unit stride load depending on size of
   // the address span.
   bool gather = address_span.size() > 1;
-  for (unsigned i = 0; i < mask_span.size(); i++) {
-    if (!mask_span[i]) continue;
-    uint64_t address = gather ? address_span[i] : address_span[0] + i * el_size;
-    uint64_t high = address + size_in_units;
-    if (address < base_address_ || high > max_address_) [[unlikely]] {
-      LOG(ERROR) << absl::StrFormat(
-          "Load access [%x, %x] out of bounds [%x, %x]\n", address, high,
-          base_address_, max_address_);
-      ABSL_HARDENING_ASSERT(false);
+  if (gather || !UnitStrideHelper(address_span[0], mask_span.data(),
+                                  mask_span.size(), el_size, byte_ptr,
+                                  /*is_load*/ true)) {
+    for (unsigned i = 0; i < mask_span.size(); i++) {
+      if (!mask_span[i]) continue;
+      uint64_t address =
+          gather ? address_span[i] : address_span[0] + i * el_size;
+      uint64_t high = address + size_in_units;
+      if (address < base_address_ || high > max_address_) [[unlikely]] {
+        LOG(ERROR) << absl::StrFormat(
+            "Load access [%x, %x] out of bounds [%x, %x]\n", address, high,
+            base_address_, max_address_);
+        ABSL_HARDENING_ASSERT(false);
+      }
+      LoadStoreHelper(address, &byte_ptr[el_size * i], size_in_units, true);
     }
-    LoadStoreHelper(address, &byte_ptr[el_size * i], size_in_units, true);
   }
   // Execute the instruction to process and write back the load data.
   if (nullptr != inst) {
@@ -157,6 +190,11 @@ void FlatDemandMemory::Store(DataBuffer* address_db, DataBuffer* mask_db,
   // If the address_span.size() > 1, then this is a scatter store, otherwise
   // it's a unit stride store.
   bool scatter = address_span.size() > 1;
+  if (!scatter && UnitStrideHelper(address_span[0], mask_span.data(),
+                                   mask_span.size(), el_size, byte_ptr,
+                                   /*is_load*/ false)) {
+    return;
+  }
   for (unsigned i = 0; i < mask_span.size(); i++) {
     if (!mask_span[i]) continue;
     uint64_t address =
@@ -173,23 +211,117 @@ void FlatDemandMemory::Store(DataBuffer* address_db, DataBuffer* mask_db,
   }
 }
 
+namespace {
+
+// Copies the elements of src for which the mask is set to dst. The select is
+// used instead of a branch so that the compiler can vectorize the loop.
+template <typename T>
+void MaskedCopy(const bool* masks, int num_elements, const uint8_t* src,
+                uint8_t* dst) {
+  const T* src_data = reinterpret_cast<const T*>(src);
+  T* dst_data = reinterpret_cast<T*>(dst);
+  for (int i = 0; i < num_elements; i++) {
+    dst_data[i] = masks[i] ? src_data[i] : dst_data[i];
+  }
+}
+
+}  // namespace
+
+bool FlatDemandMemory::UnitStrideHelper(uint64_t address, const bool* masks,
+                                        int num_elements, int el_size,
+                                        uint8_t* data_ptr, bool is_load) {
+  // The elements are only contiguous if the memory is byte addressable.
+  if (addressable_unit_shift_ != 0) return false;
+  uint64_t size = static_cast<uint64_t>(num_elements) * el_size;
+  uint64_t range = max_address_ - base_address_;
+  if ((size == 0) || (address < base_address_) || (size > range) ||
+      (address - base_address_ > range - size)) {
+    return false;
+  }
+  bool all_set = true;
+  for (int i = 0; i < num_elements; i++) all_set &= masks[i];
+  if (all_set) {
+    LoadStoreHelper(address, data_ptr, size, is_load);
+    return true;
+  }
+  // With some elements masked off, the access is performed in place if the
+  // range is contiguous in host memory.
+  uint8_t* host_ptr;
+  if (host_memory_ != nullptr) {
+    host_ptr = host_memory_ + (address - base_address_);
+  } else {
+    uint64_t offset = address & kAllocationMask;
+    if (offset + size > kAllocationSize) return false;
+    host_ptr = FindBlock(address >> kAllocationShift) + offset;
+  }
+  const uint8_t* src = is_load ? host_ptr : data_ptr;
+  uint8_t* dst = is_load ? data_ptr : host_ptr;
+  switch (el_size) {
+    case 1:
+      MaskedCopy<uint8_t>(masks, num_elements, src, dst);
+      return true;
+    case 2:
+      MaskedCopy<uint16_t>(masks, num_elements, src, dst);
+      return true;
+    case 4:
+      MaskedCopy<uint32_t>(masks, num_elements, src, dst);
+      return true;
+    case 8:
+      MaskedCopy<uint64_t>(masks, num_elements, src, dst);
+      return true;
+    default:
+      break;
+  }
+  for (int i = 0; i < num_elements; i++) {
+    if (masks[i]) std::memcpy(&dst[i * el_size], &src[i * el_size], el_size);
+  }
+  return true;
+}
+
+absl::StatusOr<absl::Span<uint8_t>> FlatDemandMemory::GetHostSpan(
+    uint64_t address, uint64_t length, HostAccess access) {
+  if (addressable_unit_shift_ != 0) {
+    return absl::UnavailableError(
+        "Direct host memory access requires byte addressable memory");
+  }
+  if ((address < base_address_) || (address >= max_address_)) {
+    return absl::OutOfRangeError(
+        absl::StrFormat("Address %x out of bounds [%x, %x]", address,
+                        base_address_, max_address_));
+  }
+  length = std::min(length, max_address_ - address);
+  if (host_memory_ != nullptr) {
+    return absl::MakeSpan(host_memory_ + (address - base_address_), length);
+  }
+  uint8_t* block = FindBlock(address >> kAllocationShift);
+  uint64_t offset = address & kAllocationMask;
+  return absl::MakeSpan(block + offset,
+                        std::min<uint64_t>(length, kAllocationSize - offset));
+}
+
 void FlatDemandMemory::LoadStoreHelper(uint64_t address, uint8_t* data_ptr,
                                        int size_in_units, bool is_load) {
+  // Accesses within the memory range reserved in host memory. The bounds are
+  // checked without computing the end address, which may wrap around.
+  uint64_t range = max_address_ - base_address_;
+  uint64_t size = static_cast<uint64_t>(size_in_units);
+  if ((host_memory_ != nullptr) && (address >= base_address_) &&
+      (size <= range) && (address - base_address_ <= range - size)) [[likely]] {
+    uint8_t* host_ptr =
+        host_memory_ + ((address - base_address_) << addressable_unit_shift_);
+    int size_in_bytes = size_in_units << addressable_unit_shift_;
+    if (is_load) {
+      std::memcpy(data_ptr, host_ptr, size_in_bytes);
+    } else {
+      std::memcpy(host_ptr, data_ptr, size_in_bytes);
+    }
+    return;
+  }
   // Repeat the following while there is data to copy. If it's a big chunk of
   // data it may span across more than one block.
   do {
     // Find the block, allocate a new one if needed.
-    uint64_t block_address = address >> kAllocationShift;
-    auto iter = block_map_.find(block_address);
-
-    uint8_t* block;
-    if (iter == block_map_.end()) {
-      block = new uint8_t[allocation_byte_size_];
-      block_map_.insert(std::make_pair(block_address, block));
-      std::memset(block, fill_value_, allocation_byte_size_);
-    } else {
-      block = iter->second;
-    }
+    uint8_t* block = FindBlock(address >> kAllocationShift);
 
     int block_unit_offset = (address & kAllocationMask);
 
@@ -216,11 +348,47 @@ void FlatDemandMemory::LoadStoreHelper(uint64_t address, uint8_t* data_ptr,
   } while (size_in_units > 0);
 }
 
+uint8_t* FlatDemandMemory::FindBlockSlow(uint64_t block_address) {
+  // Walk the radix table, allocating the missing nodes on the way.
+  RadixNode* node = radix_root_;
+  for (int level = kRadixLevels - 1; level > 0; --level) {
+    void*& entry =
+        node->entries[(block_address >> (level * kRadixBits)) & kRadixMask];
+    if (entry == nullptr) entry = new RadixNode();
+    node = static_cast<RadixNode*>(entry);
+  }
+  void*& entry = node->entries[block_address & kRadixMask];
+  if (entry == nullptr) {
+    auto* block = new uint8_t[allocation_byte_size_];
+    std::memset(block, fill_value_, allocation_byte_size_);
+    entry = block;
+  }
+  auto* block = static_cast<uint8_t*>(entry);
+  tlb_[block_address & kTlbMask] = {block_address, block};
+  return block;
+}
+
+void FlatDemandMemory::FreeRadixNode(RadixNode* node, int level) {
+  for (void*& entry : node->entries) {
+    if (entry == nullptr) continue;
+    if (level == 0) {
+      delete[] static_cast<uint8_t*>(entry);
+    } else {
+      auto* child = static_cast<RadixNode*>(entry);
+      FreeRadixNode(child, level - 1);
+      delete child;
+    }
+    entry = nullptr;
+  }
+}
+
 void FlatDemandMemory::Clear() {
-  for (auto& [unused, block_ptr] : block_map_) {
-    delete[] block_ptr;
+  // Release the host pages. They are zero filled on the next access.
+  if (host_memory_ != nullptr) {
+    madvise(host_memory_, host_memory_byte_size_, MADV_DONTNEED);
   }
-  block_map_.clear();
+  FreeRadixNode(radix_root_, kRadixLevels - 1);
+  for (auto& entry : tlb_) entry = TlbEntry();
 }
 
 }  // namespace util
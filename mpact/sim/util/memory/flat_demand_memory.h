@@ -17,7 +17,8 @@
 
 #include <cstdint>
 
-#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "mpact/sim/generic/data_buffer.h"
 #include "mpact/sim/generic/instruction.h"
 #include "mpact/sim/generic/ref_count.h"
@@ -38,6 +39,12 @@ using ::mpact::sim::generic::ReferenceCount;
 // the addressable_unit will treat the addressable unit as byte addressable and
 // only access the low order bytes. All addresses are in terms of the
 // addressable units.
+//
+// If the memory is zero filled and its size is at most kMaxHostMappedSize
+// bytes, the memory range is instead reserved in the host virtual address
+// space without committing any memory, and the host kernel allocates the pages
+// on demand. Accesses within the range then only require adding an offset to
+// the address. Accesses outside the range use the demand allocated blocks.
 class FlatDemandMemory : public MemoryInterface {
  public:
   FlatDemandMemory(uint64_t memory_size_in_units, uint64_t base_address,
@@ -85,23 +92,78 @@ class FlatDemandMemory : public MemoryInterface {
   void Store(DataBuffer* address_db, DataBuffer* mask_db, DataBuffer* db) {
     Store(address_db, mask_db, sizeof(T), db);
   }
+  // Returns a span of host memory starting at address. The span ends at the
+  // end of the memory range reserved in host memory, or at the end of the
+  // demand allocated block. Only supported for byte addressable memories.
+  absl::StatusOr<absl::Span<uint8_t>> GetHostSpan(uint64_t address,
+                                                  uint64_t length,
+                                                  HostAccess access) override;
   static constexpr int kAllocationSize = 16 * 1024;  // Power of two.
+  // Maximum byte size of the memory range reserved in host memory.
+  static constexpr uint64_t kMaxHostMappedSize = 1ULL << 36;
 
   // Clears the memory and frees all allocated blocks.
   void Clear();
 
+  // Returns true if the memory range is reserved in host memory.
+  bool is_host_mapped() const { return host_memory_ != nullptr; }
+
  private:
   void LoadStoreHelper(uint64_t address, uint8_t* data_ptr, int size_in_units,
                        bool is_load);
+  // Performs a unit stride vector access of num_elements elements of el_size
+  // bytes starting at address, with a single bounds check. Returns false if the
+  // access cannot be performed this way, in which case it has to be performed
+  // one element at a time.
+  bool UnitStrideHelper(uint64_t address, const bool* masks, int num_elements,
+                        int el_size, uint8_t* data_ptr, bool is_load);
+
+  // Returns the block with the given block address, allocating it if needed.
+  // The most recently used blocks are found in a small direct mapped table
+  // (the host TLB) before the radix table is searched.
+  uint8_t* FindBlock(uint64_t block_address) {
+    TlbEntry& entry = tlb_[block_address & kTlbMask];
+    if (entry.block_address == block_address) [[likely]] return entry.block;
+    return FindBlockSlow(block_address);
+  }
+  uint8_t* FindBlockSlow(uint64_t block_address);
 
   static constexpr int kAllocationShift = 14;
   static constexpr uint64_t kAllocationMask = kAllocationSize - 1;
+
+  // Host TLB entry. The block address of an invalid entry is all ones, which
+  // is not a valid block address.
+  struct TlbEntry {
+    uint64_t block_address = ~0ULL;
+    uint8_t* block = nullptr;
+  };
+  static constexpr int kTlbSize = 64;  // Power of two.
+  static constexpr uint64_t kTlbMask = kTlbSize - 1;
+
+  // The blocks are stored in a radix table that covers the full 64 bit unit
+  // address space. Each of the kRadixLevels levels is indexed by kRadixBits
+  // of the block address. The entries of the last level point to the blocks,
+  // the entries of the other levels point to the next level radix nodes.
+  static constexpr int kRadixBits = 10;
+  static constexpr int kRadixLevels = 5;
+  static constexpr uint64_t kRadixMask = (1ULL << kRadixBits) - 1;
+  static_assert(kRadixBits * kRadixLevels + kAllocationShift >= 64);
+  struct RadixNode {
+    void* entries[1 << kRadixBits] = {};
+  };
+  // Deletes the radix nodes and the blocks reachable from node.
+  void FreeRadixNode(RadixNode* node, int level);
+
   uint64_t base_address_;
   uint64_t max_address_;
   uint8_t fill_value_;
   int addressable_unit_shift_;
   int allocation_byte_size_;
-  absl::flat_hash_map<uint64_t, uint8_t*> block_map_;
+  TlbEntry tlb_[kTlbSize];
+  RadixNode* radix_root_;
+  // Host memory reserved for the memory range, or nullptr.
+  uint8_t* host_memory_ = nullptr;
+  uint64_t host_memory_byte_size_ = 0;
 };
 
 }  // namespace util
@@ -14,11 +14,16 @@
 
 #include "mpact/sim/util/memory/flat_memory.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 
 #include "absl/base/macros.h"
 #include "absl/numeric/bits.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 
 namespace mpact {
 namespace sim {
@@ -119,6 +124,21 @@ void FlatMemory::Store(DataBuffer* address_db, DataBuffer* mask_db, int el_size,
   }
 }
 
+absl::StatusOr<absl::Span<uint8_t>> FlatMemory::GetHostSpan(
+    uint64_t address, uint64_t length, HostAccess access) {
+  if (shift_ != 0) {
+    return absl::UnavailableError(
+        "Direct host memory access requires byte addressable memory");
+  }
+  if ((address < base_) || (address - base_ >= static_cast<uint64_t>(size_))) {
+    return absl::OutOfRangeError(absl::StrFormat(
+        "Address %x out of bounds [%x, %x]", address, base_, base_ + size_));
+  }
+  uint64_t offset = address - base_;
+  return absl::MakeSpan(&memory_buffer_[offset],
+                        std::min<uint64_t>(length, size_ - offset));
+}
+
 FlatMemory::FlatMemory(int64_t memory_size_in_units, uint64_t base_address,
                        uint32_t addressable_unit_size, uint8_t fill)
     : size_(memory_size_in_units * addressable_unit_size),
@@ -16,7 +16,10 @@
 #define MPACT_SIM_UTIL_MEMORY_FLAT_MEMORY_H_
 
 #include <cstdint>
+#include <cstring>
 
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "mpact/sim/generic/instruction.h"
 #include "mpact/sim/generic/ref_count.h"
 #include "mpact/sim/util/memory/memory_interface.h"
@@ -95,6 +98,12 @@ class FlatMemory : public MemoryInterface {
     Store(address_db, mask_db, sizeof(T), db);
   }
 
+  // Returns a span of the memory buffer starting at address. Only supported
+  // for byte addressable memories.
+  absl::StatusOr<absl::Span<uint8_t>> GetHostSpan(uint64_t address,
+                                                  uint64_t length,
+                                                  HostAccess access) override;
+
   // Accessors
   int64_t size() const { return size_; }
   uint64_t base() const { return base_; }
@@ -109,6 +118,11 @@ class FlatMemory : public MemoryInterface {
     auto masks = mask_db->Get<bool>();
     auto addresses = address_db->Get<uint64_t>();
     bool gather = addresses.size() > 1;
+    if (!gather && UnitStrideAccess<T>(addresses[0], masks.data(), max,
+                                       db->Get<T>().data(),
+                                       /*is_load=*/true)) {
+      return;
+    }
     for (int entry = 0; entry < max; entry++) {
       if (masks[entry]) {
         uint64_t address =
@@ -129,6 +143,12 @@ class FlatMemory : public MemoryInterface {
     auto masks = mask_db->Get<bool>();
     auto addresses = address_db->Get<uint64_t>();
     bool gather = addresses.size() > 1;
+    if (!gather &&
+        UnitStrideAccess<T>(addresses[0], masks.data(), max,
+                            const_cast<T*>(db->Get<T>().data()),
+                            /*is_load=*/false)) {
+      return;
+    }
     for (int entry = 0; entry < max; entry++) {
       if (masks[entry]) {
         uint64_t address =
@@ -140,6 +160,62 @@ class FlatMemory : public MemoryInterface {
       }
     }
   }
+
+  // Private helper function for unit stride vector accesses of max elements
+  // starting at address. If all the elements are within the memory, it copies
+  // the unmasked elements between memory and data with a single bounds check,
+  // and returns true. Otherwise it returns false, and the access has to be
+  // performed element by element.
+  template <typename T>
+  bool UnitStrideAccess(uint64_t address, const bool* masks, int max, T* data,
+                        bool is_load) {
+    if ((address < base_) || (max <= 0)) return false;
+    uint64_t size = static_cast<uint64_t>(size_);
+    uint64_t stride = sizeof(T) << shift_;
+    // Number of bytes spanned by the access.
+    uint64_t span = (max - 1) * stride + sizeof(T);
+    // Compare the address offset against the last valid start, so that the
+    // check doesn't wrap around for addresses near the top of the address
+    // space.
+    if ((span > size) || (address - base_ > ((size - span) >> shift_))) {
+      return false;
+    }
+    uint64_t offset = (address - base_) << shift_;
+    uint8_t* mem = &memory_buffer_[offset];
+    bool all_set = true;
+    for (int entry = 0; entry < max; entry++) all_set &= masks[entry];
+    if (all_set && (shift_ == 0)) {
+      if (is_load) {
+        std::memcpy(data, mem, max * sizeof(T));
+      } else {
+        std::memcpy(mem, data, max * sizeof(T));
+      }
+      return true;
+    }
+    if (shift_ == 0) {
+      // Contiguous elements with some masked off. Use a select on each element
+      // instead of a branch, so that the compiler can vectorize the loop.
+      T* mem_data = reinterpret_cast<T*>(mem);
+      T* dst = is_load ? data : mem_data;
+      const T* src = is_load ? mem_data : data;
+      for (int entry = 0; entry < max; entry++) {
+        dst[entry] = masks[entry] ? src[entry] : dst[entry];
+      }
+      return true;
+    }
+    // The elements are strided in memory if the addressable unit is larger
+    // than a byte.
+    for (int entry = 0; entry < max; entry++, mem += stride) {
+      if (!masks[entry]) continue;
+      if (is_load) {
+        std::memcpy(&data[entry], mem, sizeof(T));
+      } else {
+        std::memcpy(mem, &data[entry], sizeof(T));
+      }
+    }
+    return true;
+  }
+
   int64_t size_;
   uint64_t base_;
   int shift_;
@@ -17,6 +17,9 @@
 
 #include <cstdint>
 
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "mpact/sim/generic/data_buffer.h"
 #include "mpact/sim/generic/instruction.h"
 #include "mpact/sim/generic/ref_count.h"
@@ -41,11 +44,35 @@ using ::mpact::sim::generic::ReferenceCount;
 //
 // This interface does not do any inter-access ordering, for instance performing
 // loads before stores. That is the responsibility of the calling entity.
+//
+// Memories that keep their contents in host memory may also provide direct
+// access to it through GetHostSpan(). This is intended for bulk transfers, such
+// as loading a program, that would otherwise be copied through DataBuffer
+// instances.
 class MemoryInterface {
  public:
+  // The type of access performed through a span returned by GetHostSpan().
+  enum class HostAccess {
+    kRead,
+    kWrite,
+  };
+
   // Default destructor.
   virtual ~MemoryInterface() = default;
 
+  // Returns a span of host memory that holds the contents of the memory
+  // starting at address. The span may be shorter than the requested length
+  // (in bytes) if the contents are not contiguous in host memory, in which
+  // case the remaining data can be accessed with additional calls. The span is
+  // valid until the next memory operation. Memories that do not support direct
+  // access, for instance because accesses have side effects, or because the
+  // addressable unit is larger than a byte, return an unavailable error.
+  virtual absl::StatusOr<absl::Span<uint8_t>> GetHostSpan(uint64_t address,
+                                                          uint64_t length,
+                                                          HostAccess access) {
+    return absl::UnavailableError("Direct host memory access not supported");
+  }
+
   // Load data from address into the DataBuffer, then schedule the Instruction
   // inst (if not nullptr) to be executed (using the function delay line) with
   // context. The size of the data access is based on size of the data buffer.
@@ -15,13 +15,19 @@
 #include "mpact/sim/util/memory/memory_router.h"
 
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "mpact/sim/util/memory/memory_interface.h"
 #include "mpact/sim/util/memory/single_initiator_router.h"
 #include "mpact/sim/util/memory/tagged_memory_interface.h"
@@ -30,7 +36,103 @@ namespace mpact {
 namespace sim {
 namespace util {
 
-MemoryRouter::MemoryRouter() {}
+namespace internal {
+
+// Base class of the target wrappers used in thread safe mode.
+class LockedTarget {
+ public:
+  explicit LockedTarget(absl::Mutex* mutex) : mutex_(mutex) {}
+  virtual ~LockedTarget() = default;
+
+  absl::Mutex* mutex() const { return mutex_; }
+  void set_mutex(absl::Mutex* mutex) { mutex_ = mutex; }
+
+ protected:
+  absl::Mutex* mutex_;
+};
+
+// Wrapper that holds the target lock while forwarding the memory interface
+// calls to the target. Load completions that are not delayed are executed by
+// the target while the lock is held, so they must not access the same target.
+template <typename Interface>
+class LockedMemory : public LockedTarget, public Interface {
+ public:
+  using HostAccess = MemoryInterface::HostAccess;
+
+  LockedMemory(absl::Mutex* mutex, Interface* memory)
+      : LockedTarget(mutex), memory_(memory) {}
+
+  // The lock only covers obtaining the span. Any accesses through the span
+  // have to be synchronized by the caller.
+  absl::StatusOr<absl::Span<uint8_t>> GetHostSpan(uint64_t address,
+                                                  uint64_t length,
+                                                  HostAccess access) override {
+    absl::MutexLock lock(mutex_);
+    return memory_->GetHostSpan(address, length, access);
+  }
+  void Load(uint64_t address, DataBuffer* db, Instruction* inst,
+            ReferenceCount* context) override {
+    absl::MutexLock lock(mutex_);
+    memory_->Load(address, db, inst, context);
+  }
+  void Load(DataBuffer* address_db, DataBuffer* mask_db, int el_size,
+            DataBuffer* db, Instruction* inst,
+            ReferenceCount* context) override {
+    absl::MutexLock lock(mutex_);
+    memory_->Load(address_db, mask_db, el_size, db, inst, context);
+  }
+  void Store(uint64_t address, DataBuffer* db) override {
+    absl::MutexLock lock(mutex_);
+    memory_->Store(address, db);
+  }
+  void Store(DataBuffer* address_db, DataBuffer* mask_db, int el_size,
+             DataBuffer* db) override {
+    absl::MutexLock lock(mutex_);
+    memory_->Store(address_db, mask_db, el_size, db);
+  }
+
+ protected:
+  Interface* memory_;
+};
+
+class LockedTaggedMemory : public LockedMemory<TaggedMemoryInterface> {
+ public:
+  using LockedMemory<TaggedMemoryInterface>::LockedMemory;
+  using LockedMemory<TaggedMemoryInterface>::Load;
+  using LockedMemory<TaggedMemoryInterface>::Store;
+
+  void Load(uint64_t address, DataBuffer* db, DataBuffer* tags,
+            Instruction* inst, ReferenceCount* context) override {
+    absl::MutexLock lock(mutex_);
+    memory_->Load(address, db, tags, inst, context);
+  }
+  void Store(uint64_t address, DataBuffer* db, DataBuffer* tags) override {
+    absl::MutexLock lock(mutex_);
+    memory_->Store(address, db, tags);
+  }
+};
+
+class LockedAtomicMemory : public LockedTarget, public AtomicMemoryOpInterface {
+ public:
+  LockedAtomicMemory(absl::Mutex* mutex, AtomicMemoryOpInterface* memory)
+      : LockedTarget(mutex), memory_(memory) {}
+
+  absl::Status PerformMemoryOp(uint64_t address, Operation op, DataBuffer* db,
+                               Instruction* inst,
+                               ReferenceCount* context) override {
+    absl::MutexLock lock(mutex_);
+    return memory_->PerformMemoryOp(address, op, db, inst, context);
+  }
+
+ private:
+  AtomicMemoryOpInterface* memory_;
+};
+
+}  // namespace internal
+
+MemoryRouter::MemoryRouter() : MemoryRouter(/*thread_safe=*/false) {}
+
+MemoryRouter::MemoryRouter(bool thread_safe) : thread_safe_(thread_safe) {}
 
 MemoryRouter::~MemoryRouter() {
   for (auto& [unused, initiator] : initiators_) delete initiator;
@@ -70,18 +172,29 @@ AtomicMemoryOpInterface* MemoryRouter::AddAtomicInitiator(
 namespace internal {
 
 // Templated helper method used in implementing the next three methods that
-// add named targets to the router (one for each type of target interface).
-template <typename Interface>
+// add named targets to the router (one for each type of target interface). If
+// locked_targets is not nullptr, the target is wrapped in an instance of the
+// Locked class with its own lock.
+template <typename Locked, typename Interface>
 absl::Status AddTargetPrivate(
     MemoryRouter::TargetMap<Interface>& target_interface_map,
     absl::flat_hash_set<std::string>& target_names, const std::string& name,
-    Interface* memory) {
+    Interface* memory,
+    absl::flat_hash_map<std::string, std::unique_ptr<LockedTarget>>*
+        locked_targets,
+    std::vector<std::unique_ptr<absl::Mutex>>& target_locks) {
   // Only one instance of each target name can exist.
   if (target_names.contains(name)) {
     return absl::AlreadyExistsError(
         absl::StrCat("Target: ", name, " already exists"));
   }
   target_names.insert(name);
+  if (locked_targets != nullptr) {
+    target_locks.push_back(std::make_unique<absl::Mutex>());
+    auto locked = std::make_unique<Locked>(target_locks.back().get(), memory);
+    memory = locked.get();
+    locked_targets->emplace(name, std::move(locked));
+  }
   target_interface_map.emplace(std::string(name), memory);
   return absl::OkStatus();
 }
@@ -90,20 +203,23 @@ absl::Status AddTargetPrivate(
 
 absl::Status MemoryRouter::AddTarget(const std::string& name,
                                      MemoryInterface* memory) {
-  return internal::AddTargetPrivate<MemoryInterface>(
-      memory_targets_, target_names_, name, memory);
+  return internal::AddTargetPrivate<internal::LockedMemory<MemoryInterface>>(
+      memory_targets_, target_names_, name, memory,
+      thread_safe_ ? &locked_targets_ : nullptr, target_locks_);
 }
 
 absl::Status MemoryRouter::AddTarget(const std::string& name,
                                      TaggedMemoryInterface* tagged_memory) {
-  return internal::AddTargetPrivate<TaggedMemoryInterface>(
-      tagged_targets_, target_names_, name, tagged_memory);
+  return internal::AddTargetPrivate<internal::LockedTaggedMemory>(
+      tagged_targets_, target_names_, name, tagged_memory,
+      thread_safe_ ? &locked_targets_ : nullptr, target_locks_);
 }
 
 absl::Status MemoryRouter::AddTarget(const std::string& name,
                                      AtomicMemoryOpInterface* atomic_memory) {
-  return internal::AddTargetPrivate<AtomicMemoryOpInterface>(
-      atomic_targets_, target_names_, name, atomic_memory);
+  return internal::AddTargetPrivate<internal::LockedAtomicMemory>(
+      atomic_targets_, target_names_, name, atomic_memory,
+      thread_safe_ ? &locked_targets_ : nullptr, target_locks_);
 }
 
 // Add a mapping between 'initiator_name' and 'target_name' for the given
@@ -139,6 +255,19 @@ absl::Status MemoryRouter::AddMapping(const std::string& initiator_name,
       absl::StrCat("Target: ", target_name, " not found"));
 }
 
+absl::Status MemoryRouter::ShareTargetLock(const std::string& name,
+                                           const std::string& other_name) {
+  for (auto const* target_name : {&name, &other_name}) {
+    if (!target_names_.contains(*target_name)) {
+      return absl::NotFoundError(
+          absl::StrCat("Target: ", *target_name, " not found"));
+    }
+  }
+  if (!thread_safe_) return absl::OkStatus();
+  locked_targets_.at(name)->set_mutex(locked_targets_.at(other_name)->mutex());
+  return absl::OkStatus();
+}
+
 }  // namespace util
 }  // namespace sim
 }  // namespace mpact
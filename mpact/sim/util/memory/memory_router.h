@@ -16,11 +16,14 @@
 #define MPACT_SIM_UTIL_MEMORY_MEMORY_ROUTER_H_
 
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
 #include "mpact/sim/generic/data_buffer.h"
 #include "mpact/sim/generic/instruction.h"
 #include "mpact/sim/generic/ref_count.h"
@@ -31,6 +34,13 @@
 // initiators to one or more memory targets according to the memory addresses
 // used in the load/store/memory op calls. The class uses instances of the
 // SingleInitiatorRouter class to achieve this.
+//
+// By default the router assumes that all initiators are used from a single
+// simulation thread. When constructed in thread safe mode, the initiators may
+// be used from different host threads (e.g., one per simulated core), and each
+// target is then only accessed while holding a lock associated with that
+// target. The methods that configure the router are not thread safe, and have
+// to be called before the simulation threads are started.
 
 namespace mpact {
 namespace sim {
@@ -42,6 +52,10 @@ using ::mpact::sim::generic::ReferenceCount;
 
 class SingleInitiatorRouter;
 
+namespace internal {
+class LockedTarget;
+}  // namespace internal
+
 class MemoryRouter {
  public:
   // Convenient map types shorthand.
@@ -50,6 +64,9 @@ class MemoryRouter {
   using TargetMap = absl::flat_hash_map<std::string, Interface*>;
 
   MemoryRouter();
+  // If thread_safe is true, the router serializes the accesses to each target,
+  // so that the initiators can be used from different host threads.
+  explicit MemoryRouter(bool thread_safe);
   MemoryRouter(const MemoryRouter&) = delete;
   MemoryRouter& operator=(const MemoryRouter&) = delete;
   ~MemoryRouter();
@@ -85,6 +102,15 @@ class MemoryRouter {
                           const std::string& target_name, uint64_t base,
                           uint64_t top);
 
+  // In thread safe mode, make target 'name' use the same lock as target
+  // 'other_name'. This is required when two targets share state, such as an
+  // AtomicMemory instance and the memory it forwards its accesses to. Has no
+  // effect if the router is not thread safe.
+  absl::Status ShareTargetLock(const std::string& name,
+                               const std::string& other_name);
+
+  bool thread_safe() const { return thread_safe_; }
+
  private:
   // Containers of initiators and target interfaces.
   InitiatorMap initiators_;
@@ -92,6 +118,12 @@ class MemoryRouter {
   TargetMap<MemoryInterface> memory_targets_;
   TargetMap<TaggedMemoryInterface> tagged_targets_;
   TargetMap<AtomicMemoryOpInterface> atomic_targets_;
+  bool thread_safe_ = false;
+  // In thread safe mode, the targets above are wrappers that hold the target
+  // lock for the duration of each call to the wrapped target.
+  absl::flat_hash_map<std::string, std::unique_ptr<internal::LockedTarget>>
+      locked_targets_;
+  std::vector<std::unique_ptr<absl::Mutex>> target_locks_;
 };
 
 }  // namespace util
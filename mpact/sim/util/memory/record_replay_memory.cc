@@ -0,0 +1,114 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mpact/sim/util/memory/record_replay_memory.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "absl/log/log.h"
+#include "absl/strings/str_cat.h"
+#include "mpact/sim/generic/data_buffer.h"
+#include "mpact/sim/generic/external_event_log.h"
+#include "mpact/sim/generic/instruction.h"
+#include "mpact/sim/generic/ref_count.h"
+#include "mpact/sim/util/memory/memory_interface.h"
+
+namespace mpact {
+namespace sim {
+namespace util {
+
+RecordReplayMemory::RecordReplayMemory(MemoryInterface* target,
+                                       ExternalEventWriter* writer)
+    : target_(target), writer_(writer) {}
+
+RecordReplayMemory::RecordReplayMemory(ExternalEventReader* reader)
+    : reader_(reader) {}
+
+void RecordReplayMemory::Load(uint64_t address, DataBuffer* db,
+                              Instruction* inst, ReferenceCount* context) {
+  if (target_ != nullptr) target_->Load(address, db, nullptr, nullptr);
+  RecordOrReplay(address, db);
+  FinishLoad(db->latency(), inst, context);
+}
+
+void RecordReplayMemory::Load(DataBuffer* address_db, DataBuffer* mask_db,
+                              int el_size, DataBuffer* db, Instruction* inst,
+                              ReferenceCount* context) {
+  if (target_ != nullptr) {
+    target_->Load(address_db, mask_db, el_size, db, nullptr, nullptr);
+  }
+  // The masked out elements are recorded too, so that the data buffer is
+  // restored exactly.
+  RecordOrReplay(address_db->Get<uint64_t>(0), db);
+  FinishLoad(db->latency(), inst, context);
+}
+
+void RecordReplayMemory::Store(uint64_t address, DataBuffer* db) {
+  if (target_ != nullptr) target_->Store(address, db);
+}
+
+void RecordReplayMemory::Store(DataBuffer* address_db, DataBuffer* mask_db,
+                               int el_size, DataBuffer* db) {
+  if (target_ != nullptr) target_->Store(address_db, mask_db, el_size, db);
+}
+
+void RecordReplayMemory::RecordOrReplay(uint64_t address, DataBuffer* db) {
+  int size = db->size<uint8_t>();
+  if (writer_ != nullptr) {
+    writer_->WriteLoad(address, db->raw_ptr(), size);
+    return;
+  }
+  auto res = reader_->NextLoad();
+  if (res.ok() && (res->address == address) && (res->data.size() == static_cast<size_t>(size))) {
+    std::memcpy(db->raw_ptr(), res->data.data(), size);
+    return;
+  }
+  // Only report the first divergence, as all subsequent loads are likely to
+  // fail too.
+  if (!diverged_) {
+    LOG(ERROR) << absl::StrCat(
+        "Replayed load of ", size, " bytes from 0x", absl::Hex(address),
+        " does not match the log: ",
+        res.ok() ? absl::StrCat("logged load of ", res->data.size(),
+                                " bytes from 0x", absl::Hex(res->address))
+                 : res.status().ToString());
+    diverged_ = true;
+  }
+  std::memset(db->raw_ptr(), 0, size);
+}
+
+void RecordReplayMemory::FinishLoad(int latency, Instruction* inst,
+                                    ReferenceCount* context) {
+  if (inst == nullptr) return;
+  // If the latency is 0, execute the instruction immediately.
+  if (latency == 0) {
+    inst->Execute(context);
+    return;
+  }
+  // If the latency is not zero, increment the reference counts of the
+  // instruction and context.
+  inst->IncRef();
+  if (context != nullptr) context->IncRef();
+  inst->state()->function_delay_line()->Add(latency, [inst, context]() {
+    inst->Execute(context);
+    if (context != nullptr) context->DecRef();
+    inst->DecRef();
+  });
+}
+
+}  // namespace util
+}  // namespace sim
+}  // namespace mpact
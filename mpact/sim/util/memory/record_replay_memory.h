@@ -0,0 +1,85 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MPACT_SIM_UTIL_MEMORY_RECORD_REPLAY_MEMORY_H_
+#define MPACT_SIM_UTIL_MEMORY_RECORD_REPLAY_MEMORY_H_
+
+#include <cstdint>
+
+#include "mpact/sim/generic/data_buffer.h"
+#include "mpact/sim/generic/external_event_log.h"
+#include "mpact/sim/generic/instruction.h"
+#include "mpact/sim/generic/ref_count.h"
+#include "mpact/sim/util/memory/memory_interface.h"
+
+// This file declares a memory interface that is inserted in front of a source
+// of non-deterministic load data, such as a device model or a memory shared
+// with an external simulator. In record mode, the data returned by loads is
+// written to an external event log. In replay mode, the loads return the data
+// from the log instead of accessing the target, and stores are dropped, so
+// that the simulation can be rerun without the target.
+
+namespace mpact {
+namespace sim {
+namespace util {
+
+using ::mpact::sim::generic::DataBuffer;
+using ::mpact::sim::generic::ExternalEventReader;
+using ::mpact::sim::generic::ExternalEventWriter;
+using ::mpact::sim::generic::Instruction;
+using ::mpact::sim::generic::ReferenceCount;
+
+class RecordReplayMemory : public MemoryInterface {
+ public:
+  // Record mode: accesses are forwarded to the target, and load data is
+  // written to the log. Neither is owned.
+  RecordReplayMemory(MemoryInterface* target, ExternalEventWriter* writer);
+  // Replay mode: load data is read from the log, which is not owned.
+  explicit RecordReplayMemory(ExternalEventReader* reader);
+  RecordReplayMemory() = delete;
+  RecordReplayMemory(const RecordReplayMemory&) = delete;
+  RecordReplayMemory& operator=(const RecordReplayMemory&) = delete;
+  ~RecordReplayMemory() override = default;
+
+  // The memory interface methods.
+  void Load(uint64_t address, DataBuffer* db, Instruction* inst,
+            ReferenceCount* context) override;
+  void Load(DataBuffer* address_db, DataBuffer* mask_db, int el_size,
+            DataBuffer* db, Instruction* inst,
+            ReferenceCount* context) override;
+  void Store(uint64_t address, DataBuffer* db) override;
+  void Store(DataBuffer* address_db, DataBuffer* mask_db, int el_size,
+             DataBuffer* db) override;
+
+  // True if a replayed load did not match the log, i.e., the replay no longer
+  // follows the recorded execution.
+  bool diverged() const { return diverged_; }
+
+ private:
+  // Records or replays the data of a load from address.
+  void RecordOrReplay(uint64_t address, DataBuffer* db);
+  // Schedules the instruction to be executed with the latency of the db.
+  void FinishLoad(int latency, Instruction* inst, ReferenceCount* context);
+
+  MemoryInterface* target_ = nullptr;
+  ExternalEventWriter* writer_ = nullptr;
+  ExternalEventReader* reader_ = nullptr;
+  bool diverged_ = false;
+};
+
+}  // namespace util
+}  // namespace sim
+}  // namespace mpact
+
+#endif  // MPACT_SIM_UTIL_MEMORY_RECORD_REPLAY_MEMORY_H_
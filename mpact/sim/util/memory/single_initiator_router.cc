@@ -14,13 +14,16 @@
 
 #include "mpact/sim/util/memory/single_initiator_router.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
 
 #include "absl/container/btree_map.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "mpact/sim/util/memory/memory_interface.h"
 #include "mpact/sim/util/memory/tagged_memory_interface.h"
 
@@ -70,12 +73,14 @@ static absl::Status AddTargetPrivate(
 template <>
 absl::Status SingleInitiatorRouter::AddTarget<MemoryInterface>(
     MemoryInterface* memory, uint64_t base, uint64_t top) {
+  InvalidateRouteCache();
   return AddTargetPrivate<MemoryInterface>(memory_targets_, memory, base, top);
 }
 
 template <>
 absl::Status SingleInitiatorRouter::AddTarget<TaggedMemoryInterface>(
     TaggedMemoryInterface* tagged_memory, uint64_t base, uint64_t top) {
+  InvalidateRouteCache();
   return AddTargetPrivate<TaggedMemoryInterface>(tagged_targets_, tagged_memory,
                                                  base, top);
 }
@@ -91,6 +96,7 @@ absl::Status SingleInitiatorRouter::AddTarget<AtomicMemoryOpInterface>(
 template <>
 absl::Status SingleInitiatorRouter::AddDefaultTarget<MemoryInterface>(
     MemoryInterface* memory) {
+  InvalidateRouteCache();
   if ((memory != nullptr) && (default_memory_target_ != nullptr)) {
     return absl::AlreadyExistsError("Default memory target already exists");
   }
@@ -101,6 +107,7 @@ absl::Status SingleInitiatorRouter::AddDefaultTarget<MemoryInterface>(
 template <>
 absl::Status SingleInitiatorRouter::AddDefaultTarget<TaggedMemoryInterface>(
     TaggedMemoryInterface* tagged_memory) {
+  InvalidateRouteCache();
   if ((tagged_memory != nullptr) && (default_tagged_target_ != nullptr)) {
     return absl::AlreadyExistsError(
         "Default tagged memory target already exists");
@@ -120,6 +127,52 @@ absl::Status SingleInitiatorRouter::AddDefaultTarget<AtomicMemoryOpInterface>(
   return absl::OkStatus();
 }
 
+// Helper function that returns the target for all the addresses in the page
+// [base, top], the default target if no target overlaps the page, or nullptr
+// with 'uniform' set to false if a target only covers part of the page.
+template <typename Interface>
+static Interface* RoutePage(
+    const SingleInitiatorRouter::InterfaceMap<Interface>& map,
+    Interface* default_target, uint64_t base, uint64_t top, bool& uniform) {
+  auto it = map.find({base, top});
+  if (it == map.end()) return default_target;
+  if ((it->first.base <= base) && (it->first.top >= top)) return it->second;
+  uniform = false;
+  return nullptr;
+}
+
+void SingleInitiatorRouter::FillRoute(uint64_t page, RouteCacheEntry& entry) {
+  uint64_t base = page << kRoutePageShift;
+  uint64_t top = base + kRoutePageMask;
+  entry.page = page;
+  entry.cacheable = true;
+  entry.memory = RoutePage(memory_targets_, default_memory_target_, base, top,
+                           entry.cacheable);
+  entry.tagged = RoutePage(tagged_targets_, default_tagged_target_, base, top,
+                           entry.cacheable);
+}
+
+void SingleInitiatorRouter::InvalidateRouteCache() {
+  for (auto& entry : route_cache_) entry = RouteCacheEntry();
+}
+
+template <typename Interface>
+Interface* SingleInitiatorRouter::FindTarget(
+    uint64_t address, int size, Interface* RouteCacheEntry::*route_target,
+    const InterfaceMap<Interface>& map, Interface* default_target) {
+  if (auto* route = GetRoute(address, size); route != nullptr) {
+    return route->*route_target;
+  }
+  auto it = map.find({address, address + size - 1});
+  // If there are no overlapping targets, use the default.
+  if (it == map.end()) return default_target;
+  auto& range = it->first;
+  if ((range.base > address) || (range.top < address + size - 1)) {
+    return nullptr;
+  }
+  return it->second;
+}
+
 // The next methods are the overridden methods of the different memory
 // interfaces. These perform lookups to find an appropriate target. Failing that
 // they log an error and return.
@@ -128,6 +181,14 @@ absl::Status SingleInitiatorRouter::AddDefaultTarget<AtomicMemoryOpInterface>(
 void SingleInitiatorRouter::Load(uint64_t address, DataBuffer* db,
                                  Instruction* inst, ReferenceCount* context) {
   int size = db->size<uint8_t>();
+  if (auto* route = GetRoute(address, size); route != nullptr) {
+    if (route->memory != nullptr) {
+      return route->memory->Load(address, db, inst, context);
+    }
+    if (route->tagged != nullptr) {
+      return route->tagged->Load(address, db, inst, context);
+    }
+  }
   auto it = memory_targets_.find({address, address + size - 1});
   if (it != memory_targets_.end()) {
     auto& range = it->first;
@@ -170,20 +231,11 @@ void SingleInitiatorRouter::Load(DataBuffer* address_db, DataBuffer* mask_db,
     // If the mask is true, check this address.
     if (mask_db->Get<uint8_t>(i)) {
       auto address = address_db->Get<uint64_t>(i);
-      auto it = memory_targets_.find({address, address + el_size - 1});
-      MemoryInterface* tmp_memory = nullptr;
-      if (it == memory_targets_.end()) {
-        // If there are no overlapping targets, use the default, if it is set.
-        if (default_memory_target_ == nullptr) break;
-        tmp_memory = default_memory_target_;
-      } else {
-        auto& range = it->first;
-        // If there is no proper overlap, just break out of the loop. We are
-        // not splitting the memory access across multiple targets.
-        if ((range.base > address) || (range.top < address + el_size - 1))
-          break;
-        tmp_memory = it->second;
-      }
+      auto* tmp_memory = FindTarget(address, el_size, &RouteCacheEntry::memory,
+                                    memory_targets_, default_memory_target_);
+      // If there is no target, or no proper overlap, just break out of the
+      // loop. We are not splitting the memory access across multiple targets.
+      if (tmp_memory == nullptr) break;
       if (memory != nullptr) {
         if (tmp_memory != memory) {
           LOG(ERROR) << "Multiple targets found for address vector load";
@@ -204,20 +256,11 @@ void SingleInitiatorRouter::Load(DataBuffer* address_db, DataBuffer* mask_db,
   for (int i = 0; i < count; i++) {
     if (mask_db->Get<uint8_t>(i)) {
       auto address = address_db->Get<uint64_t>(i);
-      auto it = tagged_targets_.find({address, address + el_size - 1});
-      TaggedMemoryInterface* tmp_memory = nullptr;
-      if (it == tagged_targets_.end()) {
-        // If there are no overlapping targets, use the default, if it is set.
-        if (default_tagged_target_ == nullptr) break;
-        tmp_memory = default_tagged_target_;
-      } else {
-        auto& range = it->first;
-        // If there is no proper overlap, just break out of the loop. We are
-        // not splitting the memory access across multiple targets.
-        if ((range.base > address) || (range.top < address + el_size - 1))
-          break;
-        tmp_memory = it->second;
-      }
+      auto* tmp_memory = FindTarget(address, el_size, &RouteCacheEntry::tagged,
+                                    tagged_targets_, default_tagged_target_);
+      // If there is no target, or no proper overlap, just break out of the
+      // loop. We are not splitting the memory access across multiple targets.
+      if (tmp_memory == nullptr) break;
       if (tagged_memory != nullptr) {
         if (tmp_memory != tagged_memory) {
           LOG(ERROR) << "Multiple targets found for address vector load";
@@ -246,6 +289,10 @@ void SingleInitiatorRouter::Load(uint64_t address, DataBuffer* db,
   } else {
     size = db->size<uint8_t>();
   }
+  if (auto* route = GetRoute(address, size);
+      (route != nullptr) && (route->tagged != nullptr)) {
+    return route->tagged->Load(address, db, tags, inst, context);
+  }
   auto tagged_it = tagged_targets_.find({address, address + size - 1});
   if (tagged_it != tagged_targets_.end()) {
     auto& range = tagged_it->first;
@@ -265,6 +312,10 @@ void SingleInitiatorRouter::Load(uint64_t address, DataBuffer* db,
 // Plain memory store.
 void SingleInitiatorRouter::Store(uint64_t address, DataBuffer* db) {
   int size = db->size<uint8_t>();
+  if (auto* route = GetRoute(address, size); route != nullptr) {
+    if (route->memory != nullptr) return route->memory->Store(address, db);
+    if (route->tagged != nullptr) return route->tagged->Store(address, db);
+  }
   auto it = memory_targets_.find({address, address + size});
   if (it != memory_targets_.end()) {
     auto& range = it->first;
@@ -306,20 +357,11 @@ void SingleInitiatorRouter::Store(DataBuffer* address_db, DataBuffer* mask_db,
     // If the mask is true, check this address.
     if (mask_db->Get<uint8_t>(i)) {
       auto address = address_db->Get<uint64_t>(i);
-      auto it = memory_targets_.find({address, address + el_size - 1});
-      MemoryInterface* tmp_memory = nullptr;
-      if (it == memory_targets_.end()) {
-        // If there are no overlapping targets, use the default, if it is set.
-        if (default_memory_target_ == nullptr) break;
-        tmp_memory = default_memory_target_;
-      } else {
-        auto& range = it->first;
-        // If there is no proper overlap, just break out of the loop. We are
-        // not splitting the memory access across multiple targets.
-        if ((range.base > address) || (range.top < address + el_size - 1))
-          break;
-        tmp_memory = it->second;
-      }
+      auto* tmp_memory = FindTarget(address, el_size, &RouteCacheEntry::memory,
+                                    memory_targets_, default_memory_target_);
+      // If there is no target, or no proper overlap, just break out of the
+      // loop. We are not splitting the memory access across multiple targets.
+      if (tmp_memory == nullptr) break;
       if (memory != nullptr) {
         if (tmp_memory != memory) {
           LOG(ERROR) << "Multiple targets found for address vector load";
@@ -340,19 +382,11 @@ void SingleInitiatorRouter::Store(DataBuffer* address_db, DataBuffer* mask_db,
   for (int i = 0; i < count; i++) {
     if (mask_db->Get<uint8_t>(i)) {
       auto address = address_db->Get<uint64_t>(i);
-      auto it = tagged_targets_.find({address, address + el_size});
-      TaggedMemoryInterface* tmp_memory = nullptr;
-      if (it == tagged_targets_.end()) {
-        // If there are no overlapping targets, use the default, if it is set.
-        if (default_tagged_target_ == nullptr) break;
-        tmp_memory = default_tagged_target_;
-      } else {
-        auto& range = it->first;
-        // If there is no proper overlap, just break out of the loop. We are
-        // not splitting the memory access across multiple targets.
-        if ((range.base > address) || (range.top < address + el_size)) break;
-        tmp_memory = it->second;
-      }
+      auto* tmp_memory = FindTarget(address, el_size, &RouteCacheEntry::tagged,
+                                    tagged_targets_, default_tagged_target_);
+      // If there is no target, or no proper overlap, just break out of the
+      // loop. We are not splitting the memory access across multiple targets.
+      if (tmp_memory == nullptr) break;
       if (tagged_memory != nullptr) {
         if (tmp_memory != tagged_memory) {
           LOG(ERROR) << "Multiple targets found for address vector load";
@@ -373,6 +407,10 @@ void SingleInitiatorRouter::Store(DataBuffer* address_db, DataBuffer* mask_db,
 void SingleInitiatorRouter::Store(uint64_t address, DataBuffer* db,
                                   DataBuffer* tags) {
   int size = db->size<uint8_t>();
+  if (auto* route = GetRoute(address, size);
+      (route != nullptr) && (route->tagged != nullptr)) {
+    return route->tagged->Store(address, db, tags);
+  }
   auto tagged_it = tagged_targets_.find({address, address + size - 1});
   if (tagged_it != tagged_targets_.end()) {
     auto& range = tagged_it->first;
@@ -392,6 +430,48 @@ void SingleInitiatorRouter::Store(uint64_t address, DataBuffer* db,
                              absl::Hex(address));
 }
 
+// Helper function that limits the length of an access starting at address
+// (which is not in any of the ranges in map) so that it ends before the next
+// range in the map.
+template <typename Interface>
+static uint64_t LimitToNextTarget(
+    const SingleInitiatorRouter::InterfaceMap<Interface>& map, uint64_t address,
+    uint64_t length) {
+  auto next = map.upper_bound({address, address});
+  if (next == map.end()) return length;
+  return std::min(length, next->first.base - address);
+}
+
+// Direct host memory access.
+absl::StatusOr<absl::Span<uint8_t>> SingleInitiatorRouter::GetHostSpan(
+    uint64_t address, uint64_t length, HostAccess access) {
+  if (length == 0) return absl::Span<uint8_t>();
+  // The span is limited to the range of the target, so only the first address
+  // is used for the lookup.
+  auto it = memory_targets_.find({address, address});
+  if (it != memory_targets_.end()) {
+    length = std::min(length - 1, it->first.top - address) + 1;
+    return it->second->GetHostSpan(address, length, access);
+  }
+  auto tagged_it = tagged_targets_.find({address, address});
+  if (tagged_it != tagged_targets_.end()) {
+    length = std::min(length - 1, tagged_it->first.top - address) + 1;
+    return tagged_it->second->GetHostSpan(address, length, access);
+  }
+  // Fall back to the default targets. The span may not extend into the range
+  // of another target.
+  MemoryInterface* memory = default_memory_target_ != nullptr
+                                ? default_memory_target_
+                                : default_tagged_target_;
+  if (memory == nullptr) {
+    return absl::NotFoundError(absl::StrCat("No target found for address: 0x",
+                                            absl::Hex(address)));
+  }
+  length = LimitToNextTarget(memory_targets_, address, length);
+  length = LimitToNextTarget(tagged_targets_, address, length);
+  return memory->GetHostSpan(address, length, access);
+}
+
 // Atomic memory operation.
 absl::Status SingleInitiatorRouter::PerformMemoryOp(uint64_t address,
                                                     Operation op,
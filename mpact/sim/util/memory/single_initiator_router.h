@@ -21,6 +21,8 @@
 
 #include "absl/container/btree_map.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "mpact/sim/util/memory/memory_interface.h"
 #include "mpact/sim/util/memory/tagged_memory_interface.h"
 
@@ -97,6 +99,11 @@ class SingleInitiatorRouter : public TaggedMemoryInterface,
              DataBuffer* db) override;
   // Tagged store.
   void Store(uint64_t address, DataBuffer* db, DataBuffer* tags) override;
+  // Direct host memory access. The request is forwarded to the target that
+  // contains address, and the span is limited to the target's address range.
+  absl::StatusOr<absl::Span<uint8_t>> GetHostSpan(uint64_t address,
+                                                  uint64_t length,
+                                                  HostAccess access) override;
   // Atomic memory operation.
   absl::Status PerformMemoryOp(uint64_t address, Operation op, DataBuffer* db,
                                Instruction* inst,
@@ -104,8 +111,60 @@ class SingleInitiatorRouter : public TaggedMemoryInterface,
 
   // Accessors.
   std::string_view name() const { return name_; }
+  // Number of accesses that looked up their target in the route cache, and
+  // the number of those that found the page in the cache.
+  uint64_t num_route_lookups() const { return num_route_lookups_; }
+  uint64_t num_route_cache_hits() const { return num_route_cache_hits_; }
 
  private:
+  // The route cache maps pages to the memory and tagged memory targets that
+  // serve every address in the page. It is a direct mapped cache indexed by
+  // the page number, and is invalidated whenever a target is added. Pages that
+  // are only partially covered by a target are marked as not cacheable, and
+  // accesses to those pages use the target maps.
+  static constexpr int kRoutePageShift = 12;
+  static constexpr uint64_t kRoutePageSize = 1ULL << kRoutePageShift;
+  static constexpr uint64_t kRoutePageMask = kRoutePageSize - 1;
+  static constexpr int kRouteCacheSize = 64;  // Power of two.
+  struct RouteCacheEntry {
+    uint64_t page = ~0ULL;
+    bool cacheable = false;
+    // Target for plain memory accesses, or nullptr if there is none.
+    MemoryInterface* memory = nullptr;
+    // Target for tagged memory accesses, or nullptr if there is none.
+    TaggedMemoryInterface* tagged = nullptr;
+  };
+
+  // Returns the route cache entry for the page that contains the access, or
+  // nullptr if the access crosses a page boundary, or the page is not
+  // cacheable.
+  const RouteCacheEntry* GetRoute(uint64_t address, int size) {
+    if ((size <= 0) || ((address & kRoutePageMask) + size > kRoutePageSize)) {
+      return nullptr;
+    }
+    num_route_lookups_++;
+    uint64_t page = address >> kRoutePageShift;
+    RouteCacheEntry& entry = route_cache_[page & (kRouteCacheSize - 1)];
+    if (entry.page == page) {
+      num_route_cache_hits_++;
+    } else {
+      FillRoute(page, entry);
+    }
+    return entry.cacheable ? &entry : nullptr;
+  }
+  // Computes the route cache entry for the given page.
+  void FillRoute(uint64_t page, RouteCacheEntry& entry);
+  void InvalidateRouteCache();
+  // Returns the target for the access of size bytes at address, using the
+  // route cache if possible, and otherwise the map or the default target.
+  // Returns nullptr if there is no target, or if a target only covers part of
+  // the access.
+  template <typename Interface>
+  Interface* FindTarget(uint64_t address, int size,
+                        Interface* RouteCacheEntry::*route_target,
+                        const InterfaceMap<Interface>& map,
+                        Interface* default_target);
+
   std::string name_;
   // These maps are used to look up target interfaces based on addresses.
   InterfaceMap<MemoryInterface> memory_targets_;
@@ -114,6 +173,9 @@ class SingleInitiatorRouter : public TaggedMemoryInterface,
   TaggedMemoryInterface* default_tagged_target_ = nullptr;
   InterfaceMap<AtomicMemoryOpInterface> atomic_targets_;
   AtomicMemoryOpInterface* default_atomic_target_ = nullptr;
+  RouteCacheEntry route_cache_[kRouteCacheSize];
+  uint64_t num_route_lookups_ = 0;
+  uint64_t num_route_cache_hits_ = 0;
 };
 
 }  // namespace util
@@ -171,6 +171,12 @@ void TaggedFlatDemandMemory::FinishLoad(int latency, Instruction* inst,
   });
 }
 
+void TaggedFlatDemandMemory::Clear() {
+  if (data_memory_ == nullptr) return;
+  data_memory_->Clear();
+  tag_memory_->Clear();
+}
+
 // Clear the tags for the given range of memory.
 void TaggedFlatDemandMemory::ClearTags(uint64_t address, unsigned size) {
   uint64_t lo = address >> tag_granule_shift_;
@@ -113,6 +113,9 @@ class TaggedFlatDemandMemory : public TaggedMemoryInterface {
     Store(address_db, mask_db, sizeof(T), db);
   }
 
+  // Clears the memory and the tags.
+  void Clear();
+
  private:
   // Check that the tagged load or store is properly aligned to the tag
   // granule, and that the number of tags provided is correct.
@@ -16,10 +16,15 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <thread>  // NOLINT
+#include <vector>
 
+#include "absl/strings/string_view.h"
 #include "googlemock/include/gmock/gmock.h"  // IWYU pragma: keep
 #include "googletest/include/gtest/gtest.h"
+#include "mpact/sim/generic/arch_state.h"
 #include "mpact/sim/generic/data_buffer.h"
+#include "mpact/sim/generic/instruction.h"
 #include "mpact/sim/util/memory/flat_demand_memory.h"
 
 namespace {
@@ -27,8 +32,10 @@ namespace {
 // This file implements some tests to verify that the atomic memory class
 // performs the required operations appropriately.
 
+using ::mpact::sim::generic::ArchState;
 using ::mpact::sim::generic::DataBuffer;
 using ::mpact::sim::generic::DataBufferFactory;
+using ::mpact::sim::generic::Instruction;
 using ::mpact::sim::util::AtomicMemory;
 using ::mpact::sim::util::FlatDemandMemory;
 using Operation = ::mpact::sim::util::AtomicMemory::Operation;
@@ -37,6 +44,11 @@ constexpr uint32_t kBaseValue = 0x8765'4321;
 constexpr uint32_t kSecondValue = 0x4321'8765;
 constexpr uint64_t kBaseAddr = 0x1000;
 
+class MockArchState : public ArchState {
+ public:
+  explicit MockArchState(absl::string_view id) : ArchState(id, nullptr) {}
+};
+
 class AtomicMemoryTest : public ::testing::Test {
  protected:
   AtomicMemoryTest() {
@@ -179,6 +191,162 @@ TEST_F(AtomicMemoryTest, TestLlScFailure) {
   db2->DecRef();
 }
 
+// A core holds at most one reservation, which is replaced by a load-linked
+// and removed by any store-conditional.
+TEST_F(AtomicMemoryTest, TestLlScSingleReservation) {
+  constexpr uint64_t kOtherAddr = kBaseAddr + 0x100;
+  auto* db = db_factory_.Allocate<uint32_t>(1);
+  db->Set<uint32_t>(0, kBaseValue);
+  flat_memory_->Store(kBaseAddr, db);
+  // LR X; LR Y; SC X fails.
+  ASSERT_TRUE(memory_
+                  ->PerformMemoryOp(kBaseAddr, Operation::kLoadLinked, db,
+                                    nullptr, nullptr)
+                  .ok());
+  ASSERT_TRUE(memory_
+                  ->PerformMemoryOp(kOtherAddr, Operation::kLoadLinked, db,
+                                    nullptr, nullptr)
+                  .ok());
+  db->Set<uint32_t>(0, kSecondValue);
+  ASSERT_TRUE(memory_
+                  ->PerformMemoryOp(kBaseAddr, Operation::kStoreConditional,
+                                    db, nullptr, nullptr)
+                  .ok());
+  EXPECT_NE(db->Get<uint32_t>(0), 0);
+  // LR X; SC Y (fails); SC X fails.
+  ASSERT_TRUE(memory_
+                  ->PerformMemoryOp(kBaseAddr, Operation::kLoadLinked, db,
+                                    nullptr, nullptr)
+                  .ok());
+  db->Set<uint32_t>(0, kSecondValue);
+  ASSERT_TRUE(memory_
+                  ->PerformMemoryOp(kOtherAddr, Operation::kStoreConditional,
+                                    db, nullptr, nullptr)
+                  .ok());
+  EXPECT_NE(db->Get<uint32_t>(0), 0);
+  db->Set<uint32_t>(0, kSecondValue);
+  ASSERT_TRUE(memory_
+                  ->PerformMemoryOp(kBaseAddr, Operation::kStoreConditional,
+                                    db, nullptr, nullptr)
+                  .ok());
+  EXPECT_NE(db->Get<uint32_t>(0), 0);
+  // Neither store conditional updated the memory.
+  flat_memory_->Load(kBaseAddr, db, nullptr, nullptr);
+  EXPECT_EQ(db->Get<uint32_t>(0), kBaseValue);
+  // LR X; SC X succeeds.
+  ASSERT_TRUE(memory_
+                  ->PerformMemoryOp(kBaseAddr, Operation::kLoadLinked, db,
+                                    nullptr, nullptr)
+                  .ok());
+  db->Set<uint32_t>(0, kSecondValue);
+  ASSERT_TRUE(memory_
+                  ->PerformMemoryOp(kBaseAddr, Operation::kStoreConditional,
+                                    db, nullptr, nullptr)
+                  .ok());
+  EXPECT_EQ(db->Get<uint32_t>(0), 0);
+  flat_memory_->Load(kBaseAddr, db, nullptr, nullptr);
+  EXPECT_EQ(db->Get<uint32_t>(0), kSecondValue);
+  db->DecRef();
+}
+
+// Load-linked reservations are held per core.
+TEST_F(AtomicMemoryTest, TestLlScMultipleCores) {
+  MockArchState core0("core0");
+  MockArchState core1("core1");
+  auto* inst0 = new Instruction(0, &core0);
+  auto* inst1 = new Instruction(0, &core1);
+  inst0->set_semantic_function([](Instruction*) {});
+  inst1->set_semantic_function([](Instruction*) {});
+  auto* db = db_factory_.Allocate<uint32_t>(1);
+  db->Set<uint32_t>(0, kBaseValue);
+  flat_memory_->Store(kBaseAddr, db);
+  // A store conditional fails if only another core holds a reservation.
+  ASSERT_TRUE(memory_
+                  ->PerformMemoryOp(kBaseAddr, Operation::kLoadLinked, db,
+                                    inst0, nullptr)
+                  .ok());
+  db->Set<uint32_t>(0, kSecondValue);
+  ASSERT_TRUE(memory_
+                  ->PerformMemoryOp(kBaseAddr, Operation::kStoreConditional,
+                                    db, inst1, nullptr)
+                  .ok());
+  EXPECT_NE(db->Get<uint32_t>(0), 0);
+  // Both cores hold a reservation. The first store conditional succeeds, and
+  // removes the reservation of the other core.
+  ASSERT_TRUE(memory_
+                  ->PerformMemoryOp(kBaseAddr, Operation::kLoadLinked, db,
+                                    inst1, nullptr)
+                  .ok());
+  EXPECT_EQ(db->Get<uint32_t>(0), kBaseValue);
+  db->Set<uint32_t>(0, kSecondValue);
+  ASSERT_TRUE(memory_
+                  ->PerformMemoryOp(kBaseAddr, Operation::kStoreConditional,
+                                    db, inst1, nullptr)
+                  .ok());
+  EXPECT_EQ(db->Get<uint32_t>(0), 0);
+  db->Set<uint32_t>(0, kBaseValue);
+  ASSERT_TRUE(memory_
+                  ->PerformMemoryOp(kBaseAddr, Operation::kStoreConditional,
+                                    db, inst0, nullptr)
+                  .ok());
+  EXPECT_NE(db->Get<uint32_t>(0), 0);
+  flat_memory_->Load(kBaseAddr, db, nullptr, nullptr);
+  EXPECT_EQ(db->Get<uint32_t>(0), kSecondValue);
+  // An atomic memory operation by another core removes the reservation.
+  ASSERT_TRUE(memory_
+                  ->PerformMemoryOp(kBaseAddr, Operation::kLoadLinked, db,
+                                    inst0, nullptr)
+                  .ok());
+  db->Set<uint32_t>(0, 1);
+  ASSERT_TRUE(memory_
+                  ->PerformMemoryOp(kBaseAddr, Operation::kAtomicAdd, db,
+                                    inst1, nullptr)
+                  .ok());
+  ASSERT_TRUE(memory_
+                  ->PerformMemoryOp(kBaseAddr, Operation::kStoreConditional,
+                                    db, inst0, nullptr)
+                  .ok());
+  EXPECT_NE(db->Get<uint32_t>(0), 0);
+  flat_memory_->Load(kBaseAddr, db, nullptr, nullptr);
+  EXPECT_EQ(db->Get<uint32_t>(0), kSecondValue + 1);
+  db->DecRef();
+  inst0->DecRef();
+  inst1->DecRef();
+}
+
+// Atomic adds from multiple host threads are not lost in thread safe mode.
+TEST_F(AtomicMemoryTest, ThreadSafeAtomicAdd) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumAdds = 1000;
+  EXPECT_FALSE(memory_->thread_safe());
+  AtomicMemory memory(flat_memory_, /*thread_safe=*/true);
+  EXPECT_TRUE(memory.thread_safe());
+  auto* db = db_factory_.Allocate<uint32_t>(1);
+  db->Set<uint32_t>(0, 0);
+  flat_memory_->Store(kBaseAddr, db);
+  // The data buffer factory is not thread safe, so allocate the per thread
+  // data buffers up front.
+  std::vector<DataBuffer*> add_dbs;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; i++) {
+    add_dbs.push_back(db_factory_.Allocate<uint32_t>(1));
+    threads.emplace_back([&memory, add_db = add_dbs.back()]() {
+      for (int j = 0; j < kNumAdds; j++) {
+        add_db->Set<uint32_t>(0, 1);
+        EXPECT_TRUE(memory
+                        .PerformMemoryOp(kBaseAddr, Operation::kAtomicAdd,
+                                         add_db, nullptr, nullptr)
+                        .ok());
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  for (auto* add_db : add_dbs) add_db->DecRef();
+  flat_memory_->Load(kBaseAddr, db, nullptr, nullptr);
+  EXPECT_EQ(db->Get<uint32_t>(0), kNumThreads * kNumAdds);
+  db->DecRef();
+}
+
 // Swap
 TEST_F(AtomicMemoryTest, Swap) {
   auto* db = db_factory_.Allocate<uint32_t>(1);
@@ -18,17 +18,20 @@
 #include <cstring>
 #include <memory>
 
+#include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "googlemock/include/gmock/gmock.h"
 #include "googletest/include/gtest/gtest.h"
 #include "mpact/sim/generic/arch_state.h"
 #include "mpact/sim/generic/data_buffer.h"
+#include "mpact/sim/util/memory/memory_interface.h"
 
 namespace {
 
 using ::mpact::sim::generic::ArchState;
 using ::mpact::sim::generic::DataBuffer;
 using ::mpact::sim::util::FlatDemandMemory;
+using ::mpact::sim::util::MemoryInterface;
 
 // Define a class that derives from ArchState since constructors are
 // protected.
@@ -164,6 +167,87 @@ TEST_F(FlatDemandMemoryTest, MultiLoadUnitStride) {
   st_db->DecRef();
 }
 
+// Unit stride accesses with some of the elements masked off, both in host
+// mapped memory and across a block boundary in demand allocated memory.
+TEST_F(FlatDemandMemoryTest, MaskedUnitStride) {
+  for (uint8_t fill : {0, 0xff}) {
+    auto mem = std::make_unique<FlatDemandMemory>(0x10000, 0x1000, 1, fill);
+    EXPECT_EQ(mem->is_host_mapped(), fill == 0);
+    DataBuffer* address_db = arch_state_->db_factory()->Allocate<uint64_t>(1);
+    DataBuffer* mask_db = arch_state_->db_factory()->Allocate<bool>(8);
+    DataBuffer* ld_db = arch_state_->db_factory()->Allocate<uint32_t>(8);
+    ld_db->set_latency(0);
+    DataBuffer* st_db = arch_state_->db_factory()->Allocate<uint32_t>(8);
+    auto ld_span = ld_db->Get<uint32_t>();
+    auto st_span = st_db->Get<uint32_t>();
+    auto mask_span = mask_db->Get<bool>();
+    for (uint64_t address : {0x1100ULL, 0x4000ULL - 12}) {
+      address_db->Set<uint64_t>(0, address);
+      for (int i = 0; i < 8; i++) {
+        mask_span[i] = (i % 3) != 0;
+        st_span[i] = 0x100 + i;
+      }
+      mem->Store<uint32_t>(address_db, mask_db, st_db);
+      for (int i = 0; i < 8; i++) {
+        mask_span[i] = true;
+        ld_span[i] = 0;
+      }
+      mem->Load<uint32_t>(address_db, mask_db, ld_db, nullptr, nullptr);
+      uint32_t fill_word = fill * 0x0101'0101U;
+      for (int i = 0; i < 8; i++) {
+        EXPECT_EQ(ld_span[i], (i % 3) ? 0x100 + i : fill_word) << i;
+      }
+      // Masked off elements are not loaded.
+      for (int i = 0; i < 8; i++) {
+        mask_span[i] = (i % 3) == 1;
+        ld_span[i] = 0x5555;
+      }
+      mem->Load<uint32_t>(address_db, mask_db, ld_db, nullptr, nullptr);
+      for (int i = 0; i < 8; i++) {
+        EXPECT_EQ(ld_span[i], (i % 3) == 1 ? 0x100 + i : 0x5555) << i;
+      }
+    }
+    address_db->DecRef();
+    mask_db->DecRef();
+    ld_db->DecRef();
+    st_db->DecRef();
+  }
+}
+
+// A masked unit stride access that wraps around the address space is not
+// performed in place in host memory.
+TEST_F(FlatDemandMemoryTest, MaskedUnitStrideWrapAround) {
+  auto mem = std::make_unique<FlatDemandMemory>(0x10000, 0, 1, 0);
+  ASSERT_TRUE(mem->is_host_mapped());
+  DataBuffer* address_db = arch_state_->db_factory()->Allocate<uint64_t>(1);
+  DataBuffer* mask_db = arch_state_->db_factory()->Allocate<bool>(4);
+  DataBuffer* ld_db = arch_state_->db_factory()->Allocate<uint32_t>(4);
+  ld_db->set_latency(0);
+  DataBuffer* st_db = arch_state_->db_factory()->Allocate<uint32_t>(4);
+  auto ld_span = ld_db->Get<uint32_t>();
+  auto st_span = st_db->Get<uint32_t>();
+  auto mask_span = mask_db->Get<bool>();
+  // The elements are at 2^64 - 4, 0, 4, and 8.
+  address_db->Set<uint64_t>(0, 0xffff'ffff'ffff'fffcULL);
+  for (int i = 0; i < 4; i++) {
+    mask_span[i] = i != 1;
+    st_span[i] = 0x100 + i;
+  }
+  mem->Store<uint32_t>(address_db, mask_db, st_db);
+  for (int i = 0; i < 4; i++) {
+    mask_span[i] = true;
+    ld_span[i] = 0x5555;
+  }
+  mem->Load<uint32_t>(address_db, mask_db, ld_db, nullptr, nullptr);
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(ld_span[i], i != 1 ? 0x100 + i : 0) << i;
+  }
+  address_db->DecRef();
+  mask_db->DecRef();
+  ld_db->DecRef();
+  st_db->DecRef();
+}
+
 TEST_F(FlatDemandMemoryTest, HalfWordAddressable) {
   auto mem = std::make_unique<FlatDemandMemory>(0x4000, 0x1000, 2, 0);
   DataBuffer* st_db2 = arch_state_->db_factory()->Allocate<uint16_t>(1);
@@ -223,4 +307,112 @@ TEST_F(FlatDemandMemoryTest, LargeBlockOfMemory) {
   st_db->DecRef();
 }
 
+// Accesses blocks that map to the same host TLB entry and blocks that are far
+// apart in the address space, and checks that Clear() drops all the data.
+TEST_F(FlatDemandMemoryTest, SparseBlocks) {
+  constexpr uint64_t kAddresses[] = {
+      0x0,
+      0x40 * FlatDemandMemory::kAllocationSize,
+      0x80 * FlatDemandMemory::kAllocationSize + 8,
+      0x8000'0000'0000'0000ULL,
+      0xffff'ffff'ffff'ff00ULL,
+  };
+  auto mem = std::make_unique<FlatDemandMemory>(
+      0xffff'ffff'ffff'ffffULL, 0, 1, 0xa5);
+  DataBuffer* db = arch_state_->db_factory()->Allocate<uint64_t>(1);
+  db->set_latency(0);
+  for (int i = 0; i < 5; i++) {
+    db->Set<uint64_t>(0, i + 1);
+    mem->Store(kAddresses[i], db);
+  }
+  for (int i = 4; i >= 0; i--) {
+    mem->Load(kAddresses[i], db, nullptr, nullptr);
+    EXPECT_EQ(db->Get<uint64_t>(0), i + 1);
+  }
+  mem->Clear();
+  for (int i = 0; i < 5; i++) {
+    mem->Load(kAddresses[i], db, nullptr, nullptr);
+    EXPECT_EQ(db->Get<uint64_t>(0), 0xa5a5'a5a5'a5a5'a5a5ULL);
+  }
+  db->DecRef();
+}
+
+// Zero filled memories of bounded size are reserved in host memory. Accesses
+// outside the memory range use demand allocated blocks.
+TEST_F(FlatDemandMemoryTest, HostMappedMemory) {
+  EXPECT_FALSE(FlatDemandMemory().is_host_mapped());
+  EXPECT_FALSE(FlatDemandMemory(0x10'0000, 0x1000, 1, 0xff).is_host_mapped());
+  auto mem = std::make_unique<FlatDemandMemory>(0x10'0000, 0x1000, 2, 0);
+  EXPECT_TRUE(mem->is_host_mapped());
+  DataBuffer* db = arch_state_->db_factory()->Allocate<uint16_t>(16);
+  db->set_latency(0);
+  for (int i = 0; i < 16; i++) db->Set<uint16_t>(i, i + 1);
+  // Store across a block boundary and at the end of the range.
+  mem->Store(FlatDemandMemory::kAllocationSize - 8, db);
+  mem->Store(0x10'1000 - 16, db);
+  for (int i = 0; i < 16; i++) db->Set<uint16_t>(i, 0);
+  mem->Load(FlatDemandMemory::kAllocationSize - 8, db, nullptr, nullptr);
+  for (int i = 0; i < 16; i++) EXPECT_EQ(db->Get<uint16_t>(i), i + 1);
+  for (int i = 0; i < 16; i++) db->Set<uint16_t>(i, 0);
+  mem->Load(0x10'1000 - 16, db, nullptr, nullptr);
+  for (int i = 0; i < 16; i++) EXPECT_EQ(db->Get<uint16_t>(i), i + 1);
+  // Out of range loads read the demand allocated blocks.
+  mem->Load(0x10'1000, db, nullptr, nullptr);
+  for (int i = 0; i < 16; i++) EXPECT_EQ(db->Get<uint16_t>(i), 0);
+  // Clear the memory.
+  mem->Clear();
+  mem->Load(FlatDemandMemory::kAllocationSize - 8, db, nullptr, nullptr);
+  for (int i = 0; i < 16; i++) EXPECT_EQ(db->Get<uint16_t>(i), 0);
+  db->DecRef();
+}
+
+// Accesses whose end address wraps around the address space are not within
+// the host mapped range.
+TEST_F(FlatDemandMemoryTest, HostMappedMemoryWrapAround) {
+  constexpr uint64_t kAddress = 0xffff'ffff'ffff'fff8ULL;
+  auto mem = std::make_unique<FlatDemandMemory>(0x10'0000, 0, 1, 0);
+  ASSERT_TRUE(mem->is_host_mapped());
+  DataBuffer* db = arch_state_->db_factory()->Allocate<uint8_t>(16);
+  db->set_latency(0);
+  for (int i = 0; i < 16; i++) db->Set<uint8_t>(i, i + 1);
+  mem->Store(kAddress, db);
+  for (int i = 0; i < 16; i++) db->Set<uint8_t>(i, 0);
+  mem->Load(kAddress, db, nullptr, nullptr);
+  for (int i = 0; i < 16; i++) EXPECT_EQ(db->Get<uint8_t>(i), i + 1);
+  db->DecRef();
+}
+
+// Direct access to the host memory is limited to contiguous host memory.
+TEST_F(FlatDemandMemoryTest, GetHostSpan) {
+  constexpr uint64_t kBlockEnd = FlatDemandMemory::kAllocationSize;
+  DataBuffer* db = arch_state_->db_factory()->Allocate<uint8_t>(32);
+  db->set_latency(0);
+  for (auto* mem :
+       {new FlatDemandMemory(), new FlatDemandMemory(0x10'0000, 0, 1, 0)}) {
+    uint64_t address = kBlockEnd - 16;
+    auto res =
+        mem->GetHostSpan(address, 32, MemoryInterface::HostAccess::kWrite);
+    ASSERT_TRUE(res.ok());
+    // Only the host mapped memory is contiguous across the block boundary.
+    int size = mem->is_host_mapped() ? 32 : 16;
+    ASSERT_EQ(res->size(), size);
+    for (int i = 0; i < size; i++) (*res)[i] = i + 1;
+    if (!mem->is_host_mapped()) {
+      res = mem->GetHostSpan(kBlockEnd, 16, MemoryInterface::HostAccess::kWrite);
+      ASSERT_TRUE(res.ok());
+      ASSERT_EQ(res->size(), 16);
+      for (int i = 0; i < 16; i++) (*res)[i] = i + 17;
+    }
+    mem->Load(address, db, nullptr, nullptr);
+    for (int i = 0; i < 32; i++) EXPECT_EQ(db->Get<uint8_t>(i), i + 1);
+    delete mem;
+  }
+  db->DecRef();
+  FlatDemandMemory word_mem(0x10'0000, 0, 2, 0);
+  EXPECT_EQ(word_mem.GetHostSpan(0, 4, MemoryInterface::HostAccess::kRead)
+                .status()
+                .code(),
+            absl::StatusCode::kUnavailable);
+}
+
 }  // namespace
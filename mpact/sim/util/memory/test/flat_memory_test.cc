@@ -17,6 +17,7 @@
 #include <cstdint>
 #include <memory>
 
+#include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "googlemock/include/gmock/gmock.h"
 #include "googletest/include/gtest/gtest.h"
@@ -25,6 +26,7 @@
 #include "mpact/sim/generic/instruction.h"
 #include "mpact/sim/generic/operand_interface.h"
 #include "mpact/sim/generic/ref_count.h"
+#include "mpact/sim/util/memory/memory_interface.h"
 
 namespace mpact {
 namespace sim {
@@ -288,6 +290,60 @@ TEST_F(FlatMemoryTest, MultiLoadUnitStride) {
   st_db->DecRef();
 }
 
+// Unit stride accesses with some of the elements masked off.
+TEST_F(FlatMemoryTest, MaskedUnitStride) {
+  for (unsigned unit_size : {1, 4}) {
+    auto mem = std::make_unique<FlatMemory>(1024, 0x1000, unit_size, 0);
+    DataBuffer* address_db = arch_state_->db_factory()->Allocate<uint64_t>(1);
+    DataBuffer* mask_db = arch_state_->db_factory()->Allocate<bool>(8);
+    DataBuffer* ld_db = arch_state_->db_factory()->Allocate<uint16_t>(8);
+    DataBuffer* st_db = arch_state_->db_factory()->Allocate<uint16_t>(8);
+    auto ld_span = ld_db->Get<uint16_t>();
+    auto st_span = st_db->Get<uint16_t>();
+    auto mask_span = mask_db->Get<bool>();
+    address_db->Set<uint64_t>(0, 0x1010);
+    // Fill the memory range with ones.
+    for (int i = 0; i < 8; i++) {
+      mask_span[i] = true;
+      st_span[i] = 0xffff;
+    }
+    mem->Store<uint16_t>(address_db, mask_db, st_db);
+    // Store the odd elements only.
+    for (int i = 0; i < 8; i++) {
+      mask_span[i] = (i & 1) != 0;
+      st_span[i] = i;
+    }
+    mem->Store<uint16_t>(address_db, mask_db, st_db);
+    for (int i = 0; i < 8; i++) {
+      mask_span[i] = true;
+      ld_span[i] = 0;
+    }
+    mem->Load<uint16_t>(address_db, mask_db, ld_db, nullptr, nullptr);
+    for (int i = 0; i < 8; i++) {
+      EXPECT_EQ(ld_span[i], (i & 1) ? i : 0xffff) << unit_size << ":" << i;
+    }
+    // Load the even elements only. The other elements are left unchanged.
+    for (int i = 0; i < 8; i++) {
+      mask_span[i] = (i & 1) == 0;
+      ld_span[i] = 0x5555;
+    }
+    mem->Load<uint16_t>(address_db, mask_db, ld_db, nullptr, nullptr);
+    for (int i = 0; i < 8; i++) {
+      EXPECT_EQ(ld_span[i], (i & 1) ? 0x5555 : 0xffff) << unit_size << ":" << i;
+    }
+    // Elements past the end of the memory may be masked off.
+    address_db->Set<uint64_t>(0, 0x1000 + 1024 - 8);
+    for (int i = 0; i < 8; i++) mask_span[i] = i < 4;
+    mem->Store<uint16_t>(address_db, mask_db, st_db);
+    mem->Load<uint16_t>(address_db, mask_db, ld_db, nullptr, nullptr);
+    for (int i = 0; i < 4; i++) EXPECT_EQ(ld_span[i], i);
+    address_db->DecRef();
+    mask_db->DecRef();
+    ld_db->DecRef();
+    st_db->DecRef();
+  }
+}
+
 TEST_F(FlatMemoryTest, WordAddressableMemory) {
   auto mem = std::make_unique<FlatMemory>(1024, 0x1000, 4, 0);
   // Allocate data buffers for store data.
@@ -331,6 +387,65 @@ TEST_F(FlatMemoryTest, WordAddressableMemory) {
   st_db8->DecRef();
 }
 
+// Unit stride accesses that wrap around the top of the address space are
+// performed element by element.
+TEST_F(FlatMemoryTest, MaskedUnitStrideWrapAround) {
+  auto mem = std::make_unique<FlatMemory>(1024, 0, 1, 0);
+  DataBuffer* address_db = arch_state_->db_factory()->Allocate<uint64_t>(1);
+  DataBuffer* mask_db = arch_state_->db_factory()->Allocate<bool>(4);
+  DataBuffer* ld_db = arch_state_->db_factory()->Allocate<uint32_t>(4);
+  ld_db->set_latency(0);
+  DataBuffer* st_db = arch_state_->db_factory()->Allocate<uint32_t>(4);
+  auto ld_span = ld_db->Get<uint32_t>();
+  auto st_span = st_db->Get<uint32_t>();
+  auto mask_span = mask_db->Get<bool>();
+  // The elements are at 2^64 - 4, 0, 4, and 8. The first one is outside the
+  // memory, so it is masked off.
+  address_db->Set<uint64_t>(0, 0xffff'ffff'ffff'fffcULL);
+  for (int i = 0; i < 4; i++) {
+    mask_span[i] = i != 0;
+    st_span[i] = 0x100 + i;
+  }
+  mem->Store<uint32_t>(address_db, mask_db, st_db);
+  for (int i = 0; i < 4; i++) ld_span[i] = 0x5555;
+  mem->Load<uint32_t>(address_db, mask_db, ld_db, nullptr, nullptr);
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(ld_span[i], i != 0 ? 0x100 + i : 0x5555) << i;
+  }
+  address_db->DecRef();
+  mask_db->DecRef();
+  ld_db->DecRef();
+  st_db->DecRef();
+}
+
+// Direct access to the memory buffer.
+TEST_F(FlatMemoryTest, GetHostSpan) {
+  auto mem = std::make_unique<FlatMemory>(1024, 0x1000, 1, 0);
+  auto res = mem->GetHostSpan(0x1100, 16, MemoryInterface::HostAccess::kWrite);
+  ASSERT_TRUE(res.ok());
+  ASSERT_EQ(res->size(), 16);
+  for (int i = 0; i < 16; i++) (*res)[i] = i;
+  DataBuffer* db = arch_state_->db_factory()->Allocate<uint8_t>(16);
+  db->set_latency(0);
+  mem->Load(0x1100, db, nullptr, nullptr);
+  for (int i = 0; i < 16; i++) EXPECT_EQ(db->Get<uint8_t>(i), i);
+  db->DecRef();
+  // The span ends at the end of the memory.
+  res = mem->GetHostSpan(0x13f0, 64, MemoryInterface::HostAccess::kRead);
+  ASSERT_TRUE(res.ok());
+  EXPECT_EQ(res->size(), 16);
+  EXPECT_EQ(mem->GetHostSpan(0x1400, 4, MemoryInterface::HostAccess::kRead)
+                .status()
+                .code(),
+            absl::StatusCode::kOutOfRange);
+  // Word addressable memories do not support direct access.
+  auto word_mem = std::make_unique<FlatMemory>(1024, 0x1000, 2, 0);
+  EXPECT_EQ(word_mem->GetHostSpan(0x1000, 4, MemoryInterface::HostAccess::kRead)
+                .status()
+                .code(),
+            absl::StatusCode::kUnavailable);
+}
+
 }  // namespace
 }  // namespace util
 }  // namespace sim
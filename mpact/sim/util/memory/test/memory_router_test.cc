@@ -16,11 +16,20 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "googlemock/include/gmock/gmock.h"
 #include "googletest/include/gtest/gtest.h"
+#include "mpact/sim/generic/arch_state.h"
 #include "mpact/sim/generic/data_buffer.h"
+#include "mpact/sim/generic/instruction.h"
+#include "mpact/sim/util/memory/atomic_memory.h"
+#include "mpact/sim/util/memory/flat_demand_memory.h"
 #include "mpact/sim/util/memory/memory_interface.h"
 #include "mpact/sim/util/memory/single_initiator_router.h"
 #include "mpact/sim/util/memory/tagged_memory_interface.h"
@@ -29,8 +38,13 @@
 // This file contains unit tests for the MemoryRouter class.
 namespace {
 
+using ::mpact::sim::generic::ArchState;
+using ::mpact::sim::generic::DataBuffer;
 using ::mpact::sim::generic::DataBufferFactory;
+using ::mpact::sim::generic::Instruction;
+using ::mpact::sim::util::AtomicMemory;
 using ::mpact::sim::util::AtomicMemoryOpInterface;
+using ::mpact::sim::util::FlatDemandMemory;
 using ::mpact::sim::util::MemoryInterface;
 using ::mpact::sim::util::MemoryRouter;
 using ::mpact::sim::util::SingleInitiatorRouter;
@@ -174,4 +188,105 @@ TEST(MemoryRouterTest, RoutingTest) {
   db->DecRef();
 }
 
+class MockArchState : public ArchState {
+ public:
+  explicit MockArchState(absl::string_view id) : ArchState(id, nullptr) {}
+};
+
+// Initiators used from different threads perform atomic operations and
+// load-linked/store-conditional sequences on a shared memory.
+TEST(MemoryRouterTest, ThreadSafeRouting) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumIterations = 1000;
+  constexpr uint64_t kCounterAddress = 0x1000;
+  constexpr uint64_t kLlScCounterAddress = 0x1008;
+  auto memory_router = std::make_unique<MemoryRouter>(/*thread_safe=*/true);
+  EXPECT_TRUE(memory_router->thread_safe());
+  auto memory = std::make_unique<FlatDemandMemory>();
+  auto atomic_memory = std::make_unique<AtomicMemory>(memory.get());
+  EXPECT_TRUE(
+      memory_router
+          ->AddTarget("mem", static_cast<MemoryInterface*>(memory.get()))
+          .ok());
+  EXPECT_TRUE(memory_router
+                  ->AddTarget("atomic", static_cast<AtomicMemoryOpInterface*>(
+                                            atomic_memory.get()))
+                  .ok());
+  // The atomic memory operates on the same memory.
+  EXPECT_TRUE(memory_router->ShareTargetLock("atomic", "mem").ok());
+  EXPECT_FALSE(memory_router->ShareTargetLock("atomic", "none").ok());
+  // The load-linked reservations are held per core, identified by the
+  // ArchState of the instruction.
+  std::vector<std::unique_ptr<MockArchState>> cores;
+  std::vector<Instruction*> insts;
+  std::vector<MemoryInterface*> initiators;
+  std::vector<AtomicMemoryOpInterface*> atomic_initiators;
+  for (int i = 0; i < kNumThreads; i++) {
+    std::string name = absl::StrCat("core", i);
+    cores.push_back(std::make_unique<MockArchState>(name));
+    insts.push_back(new Instruction(0, cores.back().get()));
+    insts.back()->set_semantic_function([](Instruction*) {});
+    initiators.push_back(memory_router->AddMemoryInitiator(name));
+    atomic_initiators.push_back(memory_router->AddAtomicInitiator(name));
+    EXPECT_TRUE(memory_router->AddMapping(name, "mem", 0, 0xffff).ok());
+    EXPECT_TRUE(memory_router->AddMapping(name, "atomic", 0, 0xffff).ok());
+  }
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&, i]() {
+      DataBufferFactory factory;
+      DataBuffer* db = factory.Allocate<uint64_t>(1);
+      DataBuffer* st_db = factory.Allocate<uint64_t>(1);
+      db->set_latency(0);
+      st_db->Set<uint64_t>(0, i);
+      for (int j = 0; j < kNumIterations; j++) {
+        // Private location for each thread.
+        initiators[i]->Store(0x2000 + i * 8, st_db);
+        // Atomic increment.
+        db->Set<uint64_t>(0, 1);
+        EXPECT_TRUE(atomic_initiators[i]
+                        ->PerformMemoryOp(
+                            kCounterAddress,
+                            AtomicMemoryOpInterface::Operation::kAtomicAdd, db,
+                            nullptr, nullptr)
+                        .ok());
+        // Increment using a load-linked/store-conditional sequence.
+        uint64_t result;
+        do {
+          EXPECT_TRUE(atomic_initiators[i]
+                          ->PerformMemoryOp(
+                              kLlScCounterAddress,
+                              AtomicMemoryOpInterface::Operation::kLoadLinked,
+                              db, insts[i], nullptr)
+                          .ok());
+          db->Set<uint64_t>(0, db->Get<uint64_t>(0) + 1);
+          EXPECT_TRUE(
+              atomic_initiators[i]
+                  ->PerformMemoryOp(
+                      kLlScCounterAddress,
+                      AtomicMemoryOpInterface::Operation::kStoreConditional,
+                      db, insts[i], nullptr)
+                  .ok());
+          result = db->Get<uint64_t>(0);
+        } while (result != 0);
+      }
+      db->DecRef();
+      st_db->DecRef();
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  DataBufferFactory factory;
+  DataBuffer* db = factory.Allocate<uint64_t>(1);
+  memory->Load(kCounterAddress, db, nullptr, nullptr);
+  EXPECT_EQ(db->Get<uint64_t>(0), kNumThreads * kNumIterations);
+  memory->Load(kLlScCounterAddress, db, nullptr, nullptr);
+  EXPECT_EQ(db->Get<uint64_t>(0), kNumThreads * kNumIterations);
+  for (int i = 0; i < kNumThreads; i++) {
+    memory->Load(0x2000 + i * 8, db, nullptr, nullptr);
+    EXPECT_EQ(db->Get<uint64_t>(0), i);
+  }
+  db->DecRef();
+  for (auto* inst : insts) inst->DecRef();
+}
+
 }  // namespace
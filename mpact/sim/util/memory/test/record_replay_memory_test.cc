@@ -0,0 +1,104 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mpact/sim/util/memory/record_replay_memory.h"
+
+#include <cstdint>
+#include <sstream>
+
+#include "googletest/include/gtest/gtest.h"
+#include "mpact/sim/generic/data_buffer.h"
+#include "mpact/sim/generic/external_event_log.h"
+#include "mpact/sim/util/memory/flat_demand_memory.h"
+
+namespace {
+
+using ::mpact::sim::generic::DataBuffer;
+using ::mpact::sim::generic::DataBufferFactory;
+using ::mpact::sim::generic::ExternalEventReader;
+using ::mpact::sim::generic::ExternalEventWriter;
+using ::mpact::sim::util::FlatDemandMemory;
+using ::mpact::sim::util::RecordReplayMemory;
+
+class RecordReplayMemoryTest : public testing::Test {
+ protected:
+  RecordReplayMemoryTest() {
+    db_ = db_factory_.Allocate<uint32_t>(1);
+    vector_db_ = db_factory_.Allocate<uint16_t>(4);
+    address_db_ = db_factory_.Allocate<uint64_t>(1);
+    mask_db_ = db_factory_.Allocate<bool>(4);
+    address_db_->Set<uint64_t>(0, 0x2000);
+    for (int i = 0; i < 4; i++) mask_db_->Set<bool>(i, true);
+  }
+  ~RecordReplayMemoryTest() override {
+    db_->DecRef();
+    vector_db_->DecRef();
+    address_db_->DecRef();
+    mask_db_->DecRef();
+  }
+
+  DataBufferFactory db_factory_;
+  DataBuffer* db_;
+  DataBuffer* vector_db_;
+  DataBuffer* address_db_;
+  DataBuffer* mask_db_;
+};
+
+// Loads that are recorded are replayed without the target memory.
+TEST_F(RecordReplayMemoryTest, RecordAndReplay) {
+  std::stringstream log;
+  {
+    FlatDemandMemory memory(0);
+    ExternalEventWriter writer(&log);
+    RecordReplayMemory recorder(&memory, &writer);
+    // Stores are forwarded to the target.
+    db_->Set<uint32_t>(0, 0x1234'5678);
+    recorder.Store(0x1000, db_);
+    for (int i = 0; i < 4; i++) vector_db_->Set<uint16_t>(i, 0xa0 + i);
+    recorder.Store(address_db_, mask_db_, sizeof(uint16_t), vector_db_);
+    db_->Set<uint32_t>(0, 0);
+    recorder.Load(0x1000, db_, nullptr, nullptr);
+    EXPECT_EQ(db_->Get<uint32_t>(0), 0x1234'5678);
+    for (int i = 0; i < 4; i++) vector_db_->Set<uint16_t>(i, 0);
+    recorder.Load(address_db_, mask_db_, sizeof(uint16_t), vector_db_, nullptr,
+                  nullptr);
+    for (int i = 0; i < 4; i++) {
+      EXPECT_EQ(vector_db_->Get<uint16_t>(i), 0xa0 + i);
+    }
+    recorder.Load(0x3000, db_, nullptr, nullptr);
+    EXPECT_EQ(db_->Get<uint32_t>(0), 0);
+  }
+
+  ExternalEventReader reader(&log);
+  RecordReplayMemory replayer(&reader);
+  // Stores are dropped.
+  db_->Set<uint32_t>(0, 0xffff'ffff);
+  replayer.Store(0x1000, db_);
+  replayer.Load(0x1000, db_, nullptr, nullptr);
+  EXPECT_EQ(db_->Get<uint32_t>(0), 0x1234'5678);
+  for (int i = 0; i < 4; i++) vector_db_->Set<uint16_t>(i, 0);
+  replayer.Load(address_db_, mask_db_, sizeof(uint16_t), vector_db_, nullptr,
+                nullptr);
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(vector_db_->Get<uint16_t>(i), 0xa0 + i);
+  }
+  EXPECT_FALSE(replayer.diverged());
+  // A load from a different address than recorded diverges.
+  db_->Set<uint32_t>(0, 0xffff'ffff);
+  replayer.Load(0x3004, db_, nullptr, nullptr);
+  EXPECT_EQ(db_->Get<uint32_t>(0), 0);
+  EXPECT_TRUE(replayer.diverged());
+}
+
+}  // namespace
@@ -22,6 +22,8 @@
 #include "googlemock/include/gmock/gmock.h"
 #include "googletest/include/gtest/gtest.h"
 #include "mpact/sim/generic/data_buffer.h"
+#include "mpact/sim/util/memory/flat_demand_memory.h"
+#include "mpact/sim/util/memory/flat_memory.h"
 #include "mpact/sim/util/memory/memory_interface.h"
 #include "mpact/sim/util/memory/tagged_memory_interface.h"
 #include "mpact/sim/util/memory/test/dummy_memory.h"
@@ -30,6 +32,8 @@ namespace {
 
 using ::mpact::sim::generic::DataBufferFactory;
 using ::mpact::sim::util::AtomicMemoryOpInterface;
+using ::mpact::sim::util::FlatDemandMemory;
+using ::mpact::sim::util::FlatMemory;
 using ::mpact::sim::util::MemoryInterface;
 using ::mpact::sim::util::SingleInitiatorRouter;
 using ::mpact::sim::util::TaggedMemoryInterface;
@@ -592,4 +596,86 @@ TEST(SingleInitiatorRouterTest, MultiTargetAtomicMemory) {
 
   db->DecRef();
 }
+// Direct host memory access is forwarded to the target and limited to the
+// target's address range.
+TEST(SingleInitiatorRouterTest, GetHostSpan) {
+  constexpr auto kWrite = MemoryInterface::HostAccess::kWrite;
+  auto router = std::make_unique<SingleInitiatorRouter>("test");
+  auto flat_memory = std::make_unique<FlatMemory>(0x1000, 0x1000, 1, 0);
+  auto dummy_memory = std::make_unique<DummyMemory>();
+  auto default_memory = std::make_unique<FlatDemandMemory>();
+  CHECK_OK(router->AddTarget<MemoryInterface>(flat_memory.get(), 0x1000,
+                                              0x1fff));
+  CHECK_OK(router->AddTarget<MemoryInterface>(dummy_memory.get(), 0x3000,
+                                              0x3fff));
+  CHECK_OK(router->AddDefaultTarget<MemoryInterface>(default_memory.get()));
+  auto res = router->GetHostSpan(0x1ff0, 0x100, kWrite);
+  ASSERT_TRUE(res.ok());
+  EXPECT_EQ(res->size(), 0x10);
+  EXPECT_EQ(res->data(),
+            flat_memory->GetHostSpan(0x1ff0, 1, kWrite).value().data());
+  // Targets that don't support direct access.
+  EXPECT_EQ(router->GetHostSpan(0x3000, 0x100, kWrite).status().code(),
+            absl::StatusCode::kUnavailable);
+  // The span from the default target ends where the next target begins.
+  res = router->GetHostSpan(0x2ff0, 0x100, kWrite);
+  ASSERT_TRUE(res.ok());
+  EXPECT_EQ(res->size(), 0x10);
+  res = router->GetHostSpan(0x4000, 0x100, kWrite);
+  ASSERT_TRUE(res.ok());
+  EXPECT_EQ(res->size(), 0x100);
+}
+
+// The span length doesn't wrap around for a target covering the whole address
+// space.
+TEST(SingleInitiatorRouterTest, GetHostSpanFullRange) {
+  constexpr auto kWrite = MemoryInterface::HostAccess::kWrite;
+  auto router = std::make_unique<SingleInitiatorRouter>("test");
+  auto memory = std::make_unique<FlatDemandMemory>(0x1000, 0);
+  CHECK_OK(router->AddTarget<MemoryInterface>(memory.get(), 0,
+                                              0xffff'ffff'ffff'ffffULL));
+  auto res = router->GetHostSpan(0, 0x100, kWrite);
+  ASSERT_TRUE(res.ok());
+  EXPECT_EQ(res->size(), 0x100);
+}
+
+// Accesses within a page use the route cache, which is invalidated when
+// targets are added.
+TEST(SingleInitiatorRouterTest, RouteCache) {
+  DataBufferFactory db_factory;
+  auto router = std::make_unique<SingleInitiatorRouter>("test");
+  auto memory0 = std::make_unique<DummyMemory>();
+  auto memory1 = std::make_unique<DummyMemory>();
+  auto default_memory = std::make_unique<DummyMemory>();
+  auto* db = db_factory.Allocate<uint32_t>(1);
+  // Memory 0 covers part of the page at 0x2000.
+  CHECK_OK(router->AddTarget<MemoryInterface>(memory0.get(), 0x1000, 0x27ff));
+  CHECK_OK(router->AddDefaultTarget<MemoryInterface>(default_memory.get()));
+  router->Load(0x1000, db, nullptr, nullptr);
+  router->Load(0x1100, db, nullptr, nullptr);
+  router->Store(0x1200, db);
+  EXPECT_EQ(memory0->load_address(), 0x1100);
+  EXPECT_EQ(memory0->store_address(), 0x1200);
+  EXPECT_EQ(router->num_route_lookups(), 3);
+  EXPECT_EQ(router->num_route_cache_hits(), 2);
+  // Partially covered page.
+  router->Load(0x2400, db, nullptr, nullptr);
+  router->Load(0x2800, db, nullptr, nullptr);
+  EXPECT_EQ(memory0->load_address(), 0x2400);
+  EXPECT_EQ(default_memory->load_address(), 0x2800);
+  // Accesses that cross a page boundary don't use the route cache.
+  router->Load(0x1ffe, db, nullptr, nullptr);
+  EXPECT_EQ(memory0->load_address(), 0x1ffe);
+  EXPECT_EQ(router->num_route_lookups(), 5);
+  // Default target.
+  router->Store(0x3000, db);
+  EXPECT_EQ(default_memory->store_address(), 0x3000);
+  // Adding a target invalidates the route cache.
+  CHECK_OK(router->AddTarget<MemoryInterface>(memory1.get(), 0x3000, 0x3fff));
+  router->Store(0x3004, db);
+  EXPECT_EQ(memory1->store_address(), 0x3004);
+  EXPECT_EQ(default_memory->store_address(), 0x3000);
+  db->DecRef();
+}
+
 }  // namespace
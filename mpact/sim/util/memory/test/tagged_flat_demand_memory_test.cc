@@ -431,4 +431,33 @@ TEST_F(TaggedFlatDemandMemoryTest, ClearTags) {
   absl::RemoveLogSink(&log_sink);
 }
 
+// A bounded memory range is reserved in host memory. Clear() resets both the
+// data and the tags.
+TEST_F(TaggedFlatDemandMemoryTest, ClearHostMappedMemory) {
+  auto mem = std::make_unique<TaggedFlatDemandMemory>(0x10'0000, 0x1000,
+                                                      kTagGranule);
+  DataBuffer* data_db =
+      arch_state_->db_factory()->Allocate<uint8_t>(kTagGranule * 16);
+  DataBuffer* tag_db = arch_state_->db_factory()->Allocate<uint8_t>(16);
+  data_db->set_latency(0);
+  tag_db->set_latency(0);
+  for (int i = 0; i < data_db->size<uint8_t>(); i++) {
+    data_db->Set<uint8_t>(i, i + 1);
+  }
+  for (int i = 0; i < tag_db->size<uint8_t>(); i++) {
+    tag_db->Set<uint8_t>(i, 1);
+  }
+  mem->Store(0x4000 - kTagGranule * 8, data_db, tag_db);
+  mem->Clear();
+  mem->Load(0x4000 - kTagGranule * 8, data_db, tag_db, nullptr, nullptr);
+  for (int i = 0; i < data_db->size<uint8_t>(); i++) {
+    EXPECT_EQ(data_db->Get<uint8_t>(i), 0);
+  }
+  for (int i = 0; i < tag_db->size<uint8_t>(); i++) {
+    EXPECT_EQ(tag_db->Get<uint8_t>(i), 0);
+  }
+  data_db->DecRef();
+  tag_db->DecRef();
+}
+
 }  // namespace
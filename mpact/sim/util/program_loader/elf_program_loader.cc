@@ -107,6 +107,28 @@ absl::StatusOr<uint64_t> ElfProgramLoader::LoadSymbols(
   return elf_reader_.get_entry();
 }
 
+// Writes the segment data to memory. If the memory provides direct access to
+// host memory, the data is copied there, otherwise it is stored using a data
+// buffer.
+static void StoreSegment(MemoryInterface* memory, uint64_t address,
+                         const char* data, uint64_t size,
+                         generic::DataBufferFactory& db_factory) {
+  while (size > 0) {
+    auto res = memory->GetHostSpan(address, size,
+                                   MemoryInterface::HostAccess::kWrite);
+    if (!res.ok() || res->empty()) break;
+    std::memcpy(res->data(), data, res->size());
+    address += res->size();
+    data += res->size();
+    size -= res->size();
+  }
+  if (size == 0) return;
+  auto* db = db_factory.Allocate(size);
+  std::memcpy(db->raw_ptr(), data, size);
+  memory->Store(address, db);
+  db->DecRef();
+}
+
 // This is the main method of the class. It reads in the elf file, validates it
 // and iterates over the segments. For each segment it writes it to the
 // appropriate location in the given memories.
@@ -135,28 +157,27 @@ absl::StatusOr<uint64_t> ElfProgramLoader::LoadProgram(
     // Read the data from the elf file.
     if (dbg_if_ == nullptr) {  // Use memory interfaces.
       auto size = segment->get_file_size();
-      auto* db = db_factory.Allocate(size);
-      std::memcpy(db->raw_ptr(), segment->get_data(), size);
+      auto* data = segment->get_data();
       if (memories_ == nullptr) {
         if (segment->get_flags() &
             ELFIO::PF_X) {  // Executable, so write to code memory.
-          code_memory_->Store(dest_addr, db);
+          StoreSegment(code_memory_, dest_addr, data, size, db_factory);
         } else {  // Write to data memory.
-          data_memory_->Store(dest_addr, db);
+          StoreSegment(data_memory_, dest_addr, data, size, db_factory);
         }
       } else {
         for (auto& memory : *memories_) {
           if (memory.predicate_fcn(*segment)) {
             if (memory.address_fcn) {
-              memory.memory->Store(memory.address_fcn(dest_addr), db);
+              StoreSegment(memory.memory, memory.address_fcn(dest_addr), data,
+                           size, db_factory);
             } else {
-              memory.memory->Store(dest_addr, db);
+              StoreSegment(memory.memory, dest_addr, data, size, db_factory);
             }
             break;
           }
         }
       }
-      db->DecRef();
       continue;
     }
     // Use debug interface.
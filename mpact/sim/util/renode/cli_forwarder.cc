@@ -20,6 +20,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "mpact/sim/generic/core_debug_interface.h"
 #include "mpact/sim/generic/data_buffer.h"
 #include "mpact/sim/util/renode/renode_cli_top.h"
@@ -68,6 +69,22 @@ absl::StatusOr<DataBuffer*> CLIForwarder::GetRegisterDataBuffer(
   return top_->CLIGetRegisterDataBuffer(name);
 }
 
+absl::StatusOr<CoreDebugInterface::RegisterHandle>
+CLIForwarder::GetRegisterHandle(const std::string& name) {
+  return top_->CLIGetRegisterHandle(name);
+}
+
+absl::Status CLIForwarder::ReadRegisters(
+    absl::Span<const RegisterHandle> handles, absl::Span<uint64_t> values) {
+  return top_->CLIReadRegisters(handles, values);
+}
+
+absl::Status CLIForwarder::WriteRegisters(
+    absl::Span<const RegisterHandle> handles,
+    absl::Span<const uint64_t> values) {
+  return top_->CLIWriteRegisters(handles, values);
+}
+
 absl::StatusOr<size_t> CLIForwarder::ReadMemory(uint64_t address, void* buf,
                                                 size_t length) {
   return top_->CLIReadMemory(address, buf, length);
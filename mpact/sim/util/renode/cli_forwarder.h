@@ -21,6 +21,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "mpact/sim/generic/core_debug_interface.h"
 #include "mpact/sim/generic/data_buffer.h"
 #include "mpact/sim/generic/instruction.h"
@@ -78,6 +79,14 @@ class CLIForwarder : public CoreDebugInterface {
   absl::StatusOr<DataBuffer*> GetRegisterDataBuffer(
       const std::string& name) override;
 
+  // Indexed register access.
+  absl::StatusOr<RegisterHandle> GetRegisterHandle(
+      const std::string& name) override;
+  absl::Status ReadRegisters(absl::Span<const RegisterHandle> handles,
+                             absl::Span<uint64_t> values) override;
+  absl::Status WriteRegisters(absl::Span<const RegisterHandle> handles,
+                              absl::Span<const uint64_t> values) override;
+
   // Read/write the buffers to memory.
   absl::StatusOr<size_t> ReadMemory(uint64_t address, void* buf,
                                     size_t length) override;
@@ -24,6 +24,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "mpact/sim/generic/core_debug_interface.h"
 #include "mpact/sim/generic/data_buffer.h"
 #include "mpact/sim/generic/type_helpers.h"
@@ -260,6 +261,27 @@ absl::StatusOr<generic::DataBuffer*> RenodeCLITop::CLIGetRegisterDataBuffer(
       [this, &name]() { return top_->GetRegisterDataBuffer(name); });
 }
 
+absl::StatusOr<RegisterHandle> RenodeCLITop::CLIGetRegisterHandle(
+    const std::string& name) {
+  return DoWhenInControl<absl::StatusOr<RegisterHandle>>(
+      [this, &name]() { return top_->GetRegisterHandle(name); });
+}
+
+absl::Status RenodeCLITop::CLIReadRegisters(
+    absl::Span<const RegisterHandle> handles, absl::Span<uint64_t> values) {
+  return DoWhenInControl<absl::Status>([this, &handles, &values]() {
+    return top_->ReadRegisters(handles, values);
+  });
+}
+
+absl::Status RenodeCLITop::CLIWriteRegisters(
+    absl::Span<const RegisterHandle> handles,
+    absl::Span<const uint64_t> values) {
+  return DoWhenInControl<absl::Status>([this, &handles, &values]() {
+    return top_->WriteRegisters(handles, values);
+  });
+}
+
 absl::StatusOr<size_t> RenodeCLITop::CLIReadMemory(uint64_t address, void* buf,
                                                    size_t length) {
   return DoWhenInControl<absl::StatusOr<size_t>>(
@@ -23,6 +23,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "mpact/sim/generic/core_debug_interface.h"
 #include "mpact/sim/generic/data_buffer.h"
 #include "mpact/sim/generic/instruction.h"
@@ -37,6 +38,8 @@ using ::mpact::sim::generic::CoreDebugInterface;
 using ::mpact::sim::generic::DataBuffer;
 using ::mpact::sim::generic::Instruction;
 using HaltReason = ::mpact::sim::generic::CoreDebugInterface::HaltReason;
+using RegisterHandle =
+    ::mpact::sim::generic::CoreDebugInterface::RegisterHandle;
 using HaltReasonValueType =
     ::mpact::sim::generic::CoreDebugInterface::HaltReasonValueType;
 using RunStatus = ::mpact::sim::generic::CoreDebugInterface::RunStatus;
@@ -89,6 +92,14 @@ class RenodeCLITop {
                                         uint64_t value);
   virtual absl::StatusOr<DataBuffer*> CLIGetRegisterDataBuffer(
       const std::string& name);
+  // Indexed register access.
+  virtual absl::StatusOr<RegisterHandle> CLIGetRegisterHandle(
+      const std::string& name);
+  virtual absl::Status CLIReadRegisters(
+      absl::Span<const RegisterHandle> handles, absl::Span<uint64_t> values);
+  virtual absl::Status CLIWriteRegisters(
+      absl::Span<const RegisterHandle> handles,
+      absl::Span<const uint64_t> values);
   // Read and Write memory methods bypass any semihosting.
   virtual absl::StatusOr<size_t> CLIReadMemory(uint64_t address, void* buf,
                                                size_t length);
@@ -128,6 +128,10 @@ public class MpactBaseCPU : BaseCPU, ICPUWithRegisters,
         if (cfg_res < 0) {
             LogAndThrowRE("Failed to set configuration information");
         }
+        // Optionally step the simulator on its own thread, ahead of Renode.
+        if (run_ahead && (set_async_step(mpact_id, true) < 0)) {
+            LogAndThrowRE("Failed to enable asynchronous stepping");
+        }
         // Load executable file, symbols only from executable file, or bin
 	// file if specified. Use symbols load if the executable is loaded
 	// by the system.
@@ -235,6 +239,11 @@ public class MpactBaseCPU : BaseCPU, ICPUWithRegisters,
         set => wait_for_cli = value;
     }
 
+    public bool RunAhead {
+        get => run_ahead;
+        set => run_ahead = value;
+    }
+
     public override ulong ExecutedInstructions => totalExecutedInstructions;
 
     public override ExecutionMode ExecutionMode {
@@ -393,11 +402,22 @@ public class MpactBaseCPU : BaseCPU, ICPUWithRegisters,
             GetMpactRegisters();
         }
         var result = new Dictionary<string, ulong>();
-        foreach (var reg in registerNamesMap) {
-            var status = read_register(mpact_id, reg.Value, value_ptr);
-            if (status < 0) continue;
-            Int64 value = Marshal.ReadInt64(value_ptr);
-            result.Add(reg.Key, Convert.ToUInt64(value));
+        // Read all the registers in a single call. If that fails, read them
+        // one at a time, skipping the ones that can't be read.
+        var reg_names = registerNamesMap.Keys.ToArray();
+        var reg_ids = registerNamesMap.Values.ToArray();
+        var values = new UInt64[reg_ids.Length];
+        if (read_registers(mpact_id, reg_ids, values, reg_ids.Length) >= 0) {
+            for (int i = 0; i < reg_ids.Length; i++) {
+                result.Add(reg_names[i], values[i]);
+            }
+        } else {
+            foreach (var reg in registerNamesMap) {
+                var status = read_register(mpact_id, reg.Value, value_ptr);
+                if (status < 0) continue;
+                Int64 value = Marshal.ReadInt64(value_ptr);
+                result.Add(reg.Key, Convert.ToUInt64(value));
+            }
         }
         var table = new Table().AddRow("Name", "Value");
         table.AddRows(result, x=> x.Key, x=> "0x{0:X}".FormatWith(x.Value));
@@ -413,6 +433,38 @@ public class MpactBaseCPU : BaseCPU, ICPUWithRegisters,
         return load_image(mpact_id, file_name, address);
     }
 
+    // Cache the given RAM backed sysbus range in the simulator, so that
+    // accesses to it don't have to call back into Renode. Cached ranges must
+    // be flushed before other bus initiators read them, and invalidated after
+    // other bus initiators write them.
+    public Int32 AddCachedMemoryRange(UInt64 address, UInt64 size,
+                                      bool write_back) {
+        return add_cached_range(mpact_id, address, size, write_back);
+    }
+
+    public Int32 FlushMemory(UInt64 address, UInt64 length) {
+        return flush_memory(mpact_id, address, length);
+    }
+
+    public Int32 InvalidateMemory(UInt64 address, UInt64 length) {
+        return invalidate_memory(mpact_id, address, length);
+    }
+
+    // Record the external inputs of the simulator (sysbus reads, irqs,
+    // register and memory writes, and memory cache operations) to a file,
+    // which can later be replayed without the rest of the platform.
+    public Int32 StartRecording(string file_name) {
+        return start_recording(mpact_id, file_name);
+    }
+
+    public Int32 StartReplay(string file_name) {
+        return start_replay(mpact_id, file_name);
+    }
+
+    public Int32 StopRecordReplay() {
+        return stop_record_replay(mpact_id);
+    }
+
     public void OnGPIO(int number, bool value) {
         if (mpact_id < 0) {
             this.Log(LogLevel.Noisy,
@@ -574,6 +626,7 @@ public class MpactBaseCPU : BaseCPU, ICPUWithRegisters,
 
     private ushort cli_port = 0;
     private bool wait_for_cli = true;
+    private bool run_ahead = false;
     private UInt64 size = 0;
     private List<GDBFeatureDescriptor>
                 gdbFeatures = new List<GDBFeatureDescriptor>();
@@ -606,6 +659,10 @@ public class MpactBaseCPU : BaseCPU, ICPUWithRegisters,
     [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
     public delegate Int32 ReadRegister(Int32 param0, Int32 param1, IntPtr param2);
 
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+    public delegate Int32 ReadRegisters(Int32 param0, Int32[] param1,
+                                        [Out] UInt64[] param2, Int32 param3);
+
     [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
     public delegate Int32 MemoryAccess(Int32 param0, UInt64 param1, IntPtr param2, Int32 param3);
 
@@ -641,6 +698,23 @@ public class MpactBaseCPU : BaseCPU, ICPUWithRegisters,
     [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
     public delegate Int32 SetIrqValue(Int32 param0, Int32 param1, bool param2);
 
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+    public delegate Int32 SetAsyncStep(Int32 param0, bool param1);
+
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+    public delegate Int32 AddCachedRange(Int32 param0, UInt64 param1,
+                                         UInt64 param2, bool param3);
+
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+    public delegate Int32 MemoryRangeOp(Int32 param0, UInt64 param1,
+                                        UInt64 param2);
+
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+    public delegate Int32 FuncInt32Int32String_(Int32 param0, string param1);
+
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+    public delegate Int32 FuncInt32Int32_(Int32 param0);
+
     [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
     public delegate UInt64 LoadElf(Int32 param0, string param1, bool param2,
                                    IntPtr param3);
@@ -700,6 +774,11 @@ public class MpactBaseCPU : BaseCPU, ICPUWithRegisters,
     // Int32 read_register(Int32 id, Int32 reg_id, IntPtr *value);
     private ReadRegister read_register;
 
+    [Import(UseExceptionWrapper = false)]
+    // Int32 read_registers(Int32 id, Int32[] reg_ids, UInt64[] values,
+    //                      Int32 count);
+    private ReadRegisters read_registers;
+
     [Import(UseExceptionWrapper = false)]
     // Int32 write_register(Int32 id, Int32 reg_id, UInt64 value);
     private WriteRegister write_register;
@@ -720,6 +799,35 @@ public class MpactBaseCPU : BaseCPU, ICPUWithRegisters,
     // Int32 set_irq_value(Int32 id, Int32 irq_no, bool value);
     private SetIrqValue set_irq_value;
 
+    [Import(UseExceptionWrapper = false)]
+    // Int32 set_async_step(Int32 id, bool enable);
+    private SetAsyncStep set_async_step;
+
+    [Import(UseExceptionWrapper = false)]
+    // Int32 add_cached_range(Int32 id, UInt64 base, UInt64 size,
+    //                        bool write_back);
+    private AddCachedRange add_cached_range;
+
+    [Import(UseExceptionWrapper = false)]
+    // Int32 flush_memory(Int32 id, UInt64 address, UInt64 length);
+    private MemoryRangeOp flush_memory;
+
+    [Import(UseExceptionWrapper = false)]
+    // Int32 invalidate_memory(Int32 id, UInt64 address, UInt64 length);
+    private MemoryRangeOp invalidate_memory;
+
+    [Import(UseExceptionWrapper = false)]
+    // Int32 start_recording(Int32 id, string file_name);
+    private FuncInt32Int32String_ start_recording;
+
+    [Import(UseExceptionWrapper = false)]
+    // Int32 start_replay(Int32 id, string file_name);
+    private FuncInt32Int32String_ start_replay;
+
+    [Import(UseExceptionWrapper = false)]
+    // Int32 stop_record_replay(Int32 id);
+    private FuncInt32Int32_ stop_record_replay;
+
 #pragma warning restore 649
 
     private Int32 mpact_id = -1;
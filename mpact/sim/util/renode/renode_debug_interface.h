@@ -15,11 +15,14 @@
 #ifndef MPACT_SIM_UTIL_RENODE_RENODE_DEBUG_INTERFACE_H_
 #define MPACT_SIM_UTIL_RENODE_RENODE_DEBUG_INTERFACE_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "mpact/sim/generic/core_debug_interface.h"
 #include "mpact/sim/generic/type_helpers.h"
 
@@ -66,6 +69,48 @@ class RenodeDebugInterface : public generic::CoreDebugInterface {
   // Set IRQ.
   virtual absl::Status SetIrqValue(int32_t irq_num, bool irq_value) = 0;
 
+  // Indexed register access. The register handles are the numeric register
+  // ids, so the default implementations are in terms of the numeric id
+  // register accessors above.
+  absl::StatusOr<RegisterHandle> GetRegisterHandle(
+      const std::string& name) override {
+    int32_t size = GetRenodeRegisterInfoSize();
+    std::string reg_name;
+    for (int32_t i = 0; i < size; ++i) {
+      // Leave room to detect names that have the given name as a prefix.
+      reg_name.assign(name.size() + 2, '\0');
+      RenodeCpuRegister info;
+      auto status =
+          GetRenodeRegisterInfo(i, reg_name.size(), reg_name.data(), info);
+      if (!status.ok()) continue;
+      if (name == reg_name.c_str()) return info.index;
+    }
+    return absl::NotFoundError(absl::StrCat("Register '", name, "' not found"));
+  }
+  absl::Status ReadRegisters(absl::Span<const RegisterHandle> handles,
+                             absl::Span<uint64_t> values) override {
+    if (values.size() < handles.size()) {
+      return absl::InvalidArgumentError("Values span is too small");
+    }
+    for (size_t i = 0; i < handles.size(); ++i) {
+      auto result = ReadRegister(static_cast<uint32_t>(handles[i]));
+      if (!result.ok()) return result.status();
+      values[i] = result.value();
+    }
+    return absl::OkStatus();
+  }
+  absl::Status WriteRegisters(absl::Span<const RegisterHandle> handles,
+                              absl::Span<const uint64_t> values) override {
+    if (values.size() < handles.size()) {
+      return absl::InvalidArgumentError("Values span is too small");
+    }
+    for (size_t i = 0; i < handles.size(); ++i) {
+      auto status = WriteRegister(static_cast<uint32_t>(handles[i]), values[i]);
+      if (!status.ok()) return status;
+    }
+    return absl::OkStatus();
+  }
+
   // The following methods from CoreDebugInterface will not be used by ReNode,
   // so providing trivial "final" implementations for now.
   // TODO(torerik): Maybe consider not inheriting from CoreDebugInterface in the
@@ -14,44 +14,69 @@
 
 #include "mpact/sim/util/renode/renode_memory_access.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <memory>
 
+#include "absl/functional/function_ref.h"
 #include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
 #include "mpact/sim/generic/data_buffer.h"
+#include "mpact/sim/generic/external_event_log.h"
 #include "mpact/sim/generic/instruction.h"
 #include "mpact/sim/generic/ref_count.h"
 
 namespace mpact::sim::util::renode {
 
 using ::mpact::sim::generic::DataBuffer;
+using ::mpact::sim::generic::ExternalEvent;
+using ::mpact::sim::generic::ExternalEventType;
 using ::mpact::sim::generic::Instruction;
 using ::mpact::sim::generic::ReferenceCount;
 
 // Process the load using the interface to the ReNode system bus to fetch data.
 void RenodeMemoryAccess::Load(uint64_t address, DataBuffer* db,
                               Instruction* inst, ReferenceCount* context) {
-  if (read_fcn_ == nullptr) {
+  if (!can_read()) {
     LOG(WARNING) << "RenodeMemoryAccess: read_fcn_ is null";
     std::memset(db->raw_ptr(), 0, db->size<uint8_t>());
     FinishLoad(db->latency(), inst, context);
     return;
   }
-  int32_t size = db->size<uint8_t>();
-  // Call the C# function delegate.
-  auto bytes_read = read_fcn_(address, static_cast<char*>(db->raw_ptr()), size);
-  if (size != bytes_read) {
-    LOG(ERROR) << "Failed to read " << size - bytes_read << " bytes of "
-               << size;
-  }
+  ReadBytes(address, static_cast<uint8_t*>(db->raw_ptr()), db->size<uint8_t>());
   FinishLoad(db->latency(), inst, context);
 }
 
-// TODO(torerik): add vector load functionality.
+// Process the vector load one element at a time, except for unit stride loads
+// without masked off elements, which are performed as a single access.
 void RenodeMemoryAccess::Load(DataBuffer* address_db, DataBuffer* mask_db,
                               int el_size, DataBuffer* db, Instruction* inst,
                               ReferenceCount* context) {
-  LOG(ERROR) << "RenodeMemoryAccess: Vector loads are not supported";
+  if (!can_read()) {
+    LOG(WARNING) << "RenodeMemoryAccess: read_fcn_ is null";
+    std::memset(db->raw_ptr(), 0, db->size<uint8_t>());
+    FinishLoad(db->latency(), inst, context);
+    return;
+  }
+  auto masks = mask_db->Get<bool>();
+  auto addresses = address_db->Get<uint64_t>();
+  auto* data = static_cast<uint8_t*>(db->raw_ptr());
+  int num_elements = masks.size();
+  bool gather = addresses.size() > 1;
+  if (!gather && std::all_of(masks.begin(), masks.end(),
+                             [](bool mask) { return mask; })) {
+    ReadBytes(addresses[0], data, num_elements * el_size);
+  } else {
+    for (int i = 0; i < num_elements; ++i) {
+      if (!masks[i]) continue;
+      uint64_t address = gather ? addresses[i] : addresses[0] + i * el_size;
+      ReadBytes(address, data + i * el_size, el_size);
+    }
+  }
+  FinishLoad(db->latency(), inst, context);
 }
 
 // Complete the load by writing back (or scheduling the write back of) the
@@ -79,24 +104,274 @@ void RenodeMemoryAccess::FinishLoad(int latency, Instruction* inst,
 
 // Process the store using the interface to the ReNode system bus to store data.
 void RenodeMemoryAccess::Store(uint64_t address, DataBuffer* db) {
-  if (write_fcn_ == nullptr) {
+  if (!can_write()) {
     LOG(WARNING) << "RenodeMemoryAccess: write_fcn_ is null";
     return;
   }
-  int32_t size = db->size<uint8_t>();
-  // Call the C# function delegate.
-  auto bytes_written =
-      write_fcn_(address, static_cast<char*>(db->raw_ptr()), size);
+  WriteBytes(address, static_cast<uint8_t*>(db->raw_ptr()),
+             db->size<uint8_t>());
+}
+
+// Process the vector store one element at a time, except for unit stride
+// stores without masked off elements, which are performed as a single access.
+void RenodeMemoryAccess::Store(DataBuffer* address_db, DataBuffer* mask_db,
+                               int el_size, DataBuffer* db) {
+  if (!can_write()) {
+    LOG(WARNING) << "RenodeMemoryAccess: write_fcn_ is null";
+    return;
+  }
+  auto masks = mask_db->Get<bool>();
+  auto addresses = address_db->Get<uint64_t>();
+  auto* data = static_cast<uint8_t*>(db->raw_ptr());
+  int num_elements = masks.size();
+  bool gather = addresses.size() > 1;
+  if (!gather && std::all_of(masks.begin(), masks.end(),
+                             [](bool mask) { return mask; })) {
+    WriteBytes(addresses[0], data, num_elements * el_size);
+    return;
+  }
+  for (int i = 0; i < num_elements; ++i) {
+    if (!masks[i]) continue;
+    uint64_t address = gather ? addresses[i] : addresses[0] + i * el_size;
+    WriteBytes(address, data + i * el_size, el_size);
+  }
+}
+
+absl::Status RenodeMemoryAccess::AddCachedRange(uint64_t base, uint64_t size,
+                                                bool write_back) {
+  if ((size == 0) || (base % kCacheBlockSize != 0) ||
+      (size % kCacheBlockSize != 0) || (base + size - 1 < base)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Cached range [0x%x, 0x%x) is empty or not aligned to %d bytes", base,
+        base + size, kCacheBlockSize));
+  }
+  for (auto const& range : cached_ranges_) {
+    if ((base < range.base + range.size) && (range.base < base + size)) {
+      return absl::AlreadyExistsError(absl::StrFormat(
+          "Cached range [0x%x, 0x%x) overlaps [0x%x, 0x%x)", base, base + size,
+          range.base, range.base + range.size));
+    }
+  }
+  cached_ranges_.push_back({base, size, write_back});
+  return absl::OkStatus();
+}
+
+void RenodeMemoryAccess::Flush(uint64_t address, uint64_t length) {
+  if (length == 0) return;
+  uint64_t last = address + std::min<uint64_t>(length - 1, ~0ULL - address);
+  for (auto& [block_address, block] : cache_blocks_) {
+    if ((block_address > last) ||
+        (block_address + kCacheBlockSize - 1 < address)) {
+      continue;
+    }
+    WriteBackBlock(block_address, block.get());
+  }
+}
+
+void RenodeMemoryAccess::Invalidate(uint64_t address, uint64_t length) {
+  if (length == 0) return;
+  uint64_t last = address + std::min<uint64_t>(length - 1, ~0ULL - address);
+  for (auto iter = cache_blocks_.begin(); iter != cache_blocks_.end();) {
+    auto& [block_address, block] = *iter;
+    if ((block_address > last) ||
+        (block_address + kCacheBlockSize - 1 < address)) {
+      ++iter;
+      continue;
+    }
+    WriteBackBlock(block_address, block.get());
+    cache_blocks_.erase(iter++);
+  }
+  last_block_ = nullptr;
+}
+
+void RenodeMemoryAccess::ReadBytes(uint64_t address, uint8_t* data, int size) {
+  if (size <= 0) return;
+  if (FindCachedRange(address, size) != nullptr) {
+    // Make sure all the blocks are available before copying any data.
+    uint64_t first_block = address & ~(kCacheBlockSize - 1);
+    uint64_t last_block = (address + size - 1) & ~(kCacheBlockSize - 1);
+    bool cached = true;
+    for (uint64_t block_address = first_block; block_address <= last_block;
+         block_address += kCacheBlockSize) {
+      cached &= GetCacheBlock(block_address) != nullptr;
+    }
+    if (cached) {
+      while (size > 0) {
+        uint64_t block_address = address & ~(kCacheBlockSize - 1);
+        uint64_t offset = address - block_address;
+        int count = std::min<uint64_t>(size, kCacheBlockSize - offset);
+        std::memcpy(data, GetCacheBlock(block_address)->data + offset, count);
+        address += count;
+        data += count;
+        size -= count;
+      }
+      return;
+    }
+  }
+  auto bytes_read = SysbusRead(address, data, size);
+  if (size != bytes_read) {
+    LOG(ERROR) << "Failed to read " << size - bytes_read << " bytes of "
+               << size;
+  }
+}
+
+void RenodeMemoryAccess::WriteBytes(uint64_t address, const uint8_t* data,
+                                    int size) {
+  if (size <= 0) return;
+  auto* range = FindCachedRange(address, size);
+  if (range != nullptr) {
+    // Make sure all the blocks are available before copying any data.
+    uint64_t first_block = address & ~(kCacheBlockSize - 1);
+    uint64_t last_block = (address + size - 1) & ~(kCacheBlockSize - 1);
+    bool cached = true;
+    for (uint64_t block_address = first_block; block_address <= last_block;
+         block_address += kCacheBlockSize) {
+      cached &= GetCacheBlock(block_address) != nullptr;
+    }
+    if (cached) {
+      uint64_t store_address = address;
+      const uint8_t* store_data = data;
+      int remaining = size;
+      while (remaining > 0) {
+        uint64_t block_address = store_address & ~(kCacheBlockSize - 1);
+        uint64_t offset = store_address - block_address;
+        int count = std::min<uint64_t>(remaining, kCacheBlockSize - offset);
+        auto* block = GetCacheBlock(block_address);
+        std::memcpy(block->data + offset, store_data, count);
+        if (range->write_back) {
+          std::memset(block->dirty_bytes + offset, true, count);
+          block->dirty = true;
+        }
+        store_address += count;
+        store_data += count;
+        remaining -= count;
+      }
+      if (range->write_back) return;
+    }
+  }
+  auto bytes_written = SysbusWrite(address, data, size);
   if (size != bytes_written) {
     LOG(ERROR) << "Failed to write " << size - bytes_written << " bytes of "
                << size;
   }
 }
 
-// TODO(torerik): add vector store functionality.
-void RenodeMemoryAccess::Store(DataBuffer* address, DataBuffer* mask,
-                               int el_size, DataBuffer* db) {
-  LOG(ERROR) << "RenodeMemoryAccess: Vector stores are not supported";
+const RenodeMemoryAccess::CachedRange* RenodeMemoryAccess::FindCachedRange(
+    uint64_t address, int size) const {
+  for (auto const& range : cached_ranges_) {
+    if ((address >= range.base) && (address - range.base < range.size) &&
+        (static_cast<uint64_t>(size) <= range.size - (address - range.base))) {
+      return &range;
+    }
+  }
+  return nullptr;
+}
+
+RenodeMemoryAccess::CacheBlock* RenodeMemoryAccess::GetCacheBlock(
+    uint64_t block_address) {
+  if ((last_block_ != nullptr) && (last_block_address_ == block_address)) {
+    return last_block_;
+  }
+  auto iter = cache_blocks_.find(block_address);
+  if (iter == cache_blocks_.end()) {
+    if (!can_read()) return nullptr;
+    auto block = std::make_unique<CacheBlock>();
+    auto bytes_read = SysbusRead(block_address, block->data, kCacheBlockSize);
+    if (bytes_read != kCacheBlockSize) {
+      LOG(ERROR) << absl::StrFormat(
+          "Failed to fetch cache block at 0x%x - accessing it uncached",
+          block_address);
+      return nullptr;
+    }
+    iter = cache_blocks_.emplace(block_address, std::move(block)).first;
+  }
+  last_block_address_ = block_address;
+  last_block_ = iter->second.get();
+  return last_block_;
+}
+
+void RenodeMemoryAccess::WriteBackBlock(uint64_t block_address,
+                                        CacheBlock* block) {
+  if (!block->dirty || !can_write()) return;
+  // Write each contiguous run of dirty bytes separately.
+  uint64_t offset = 0;
+  while (offset < kCacheBlockSize) {
+    if (!block->dirty_bytes[offset]) {
+      offset++;
+      continue;
+    }
+    uint64_t end = offset + 1;
+    while ((end < kCacheBlockSize) && block->dirty_bytes[end]) end++;
+    int32_t size = end - offset;
+    auto bytes_written =
+        SysbusWrite(block_address + offset, block->data + offset, size);
+    if (bytes_written != size) {
+      LOG(ERROR) << absl::StrFormat(
+          "Failed to write back [0x%x, 0x%x) of cache block",
+          block_address + offset, block_address + end);
+    }
+    offset = end;
+  }
+  std::memset(block->dirty_bytes, false, kCacheBlockSize);
+  block->dirty = false;
+}
+
+int32_t RenodeMemoryAccess::SysbusRead(uint64_t address, uint8_t* data,
+                                       int32_t size) {
+  if (event_reader_ != nullptr) {
+    auto res = event_reader_->NextLoad();
+    if (res.ok() && (res->address == address) &&
+        (res->data.size() == static_cast<size_t>(size))) {
+      std::memcpy(data, res->data.data(), size);
+      // The value is the number of bytes read when recorded.
+      return static_cast<int32_t>(res->value);
+    }
+    // Only report the first divergence, as all subsequent reads are likely to
+    // fail too. The read returns zeros.
+    if (!replay_diverged_) {
+      LOG(ERROR) << absl::StrFormat(
+          "Replayed read of %d bytes from 0x%x does not match the log", size,
+          address);
+      replay_diverged_ = true;
+    }
+    std::memset(data, 0, size);
+    return size;
+  }
+  // Call the C# function delegate.
+  int32_t bytes_read;
+  CallSysbus([&]() {
+    bytes_read = read_fcn_(address, reinterpret_cast<char*>(data), size);
+  });
+  if (event_writer_ != nullptr) {
+    ExternalEvent event;
+    event.type = ExternalEventType::kLoad;
+    event.address = address;
+    event.value = static_cast<uint32_t>(bytes_read);
+    event.data.assign(reinterpret_cast<char*>(data), size);
+    event_writer_->Write(event);
+  }
+  return bytes_read;
+}
+
+int32_t RenodeMemoryAccess::SysbusWrite(uint64_t address, const uint8_t* data,
+                                        int32_t size) {
+  // Writes are dropped when replaying.
+  if (event_reader_ != nullptr) return size;
+  // Call the C# function delegate.
+  int32_t bytes_written;
+  CallSysbus([&]() {
+    bytes_written = write_fcn_(
+        address, reinterpret_cast<char*>(const_cast<uint8_t*>(data)), size);
+  });
+  return bytes_written;
+}
+
+void RenodeMemoryAccess::CallSysbus(absl::FunctionRef<void()> call) {
+  if (sysbus_caller_ == nullptr) {
+    call();
+    return;
+  }
+  sysbus_caller_(call);
 }
 
 }  // namespace mpact::sim::util::renode
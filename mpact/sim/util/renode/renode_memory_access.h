@@ -16,20 +16,40 @@
 #define MPACT_SIM_UTIL_RENODE_RENODE_MEMORY_ACCESS_H_
 
 #include <cstdint>
+#include <memory>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/functional/any_invocable.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
 #include "mpact/sim/generic/data_buffer.h"
+#include "mpact/sim/generic/external_event_log.h"
 #include "mpact/sim/generic/instruction.h"
 #include "mpact/sim/generic/ref_count.h"
 #include "mpact/sim/util/memory/memory_interface.h"
 
 // This file defines a class that acts as a shim between MemoryInterface and
 // ReNode memory access functions.
+//
+// Each call to the ReNode memory access functions crosses into managed (C#)
+// code, which is expensive. To reduce the number of such calls, address ranges
+// that are backed by RAM in ReNode can be cached locally. Cached data is
+// fetched from ReNode in blocks on first access. Stores to cached ranges are
+// either written through to ReNode, or kept in the cache (write back) until
+// the range is flushed. ReNode must flush cached ranges before the memory is
+// accessed by other bus initiators, and invalidate them after other bus
+// initiators write to the memory.
+//
+// The data read from ReNode can be recorded to an external event log, and
+// later replayed from the log without ReNode.
 
 namespace mpact::sim::util::renode {
 
 using ::mpact::sim::generic::DataBuffer;
+using ::mpact::sim::generic::ExternalEventReader;
+using ::mpact::sim::generic::ExternalEventWriter;
 using ::mpact::sim::generic::Instruction;
 using ::mpact::sim::generic::ReferenceCount;
 using ::mpact::sim::util::MemoryInterface;
@@ -39,10 +59,19 @@ class RenodeMemoryAccess : public MemoryInterface {
   // Function call signature for the sysbus read/write methods.
   using RenodeMemoryFunction =
       absl::AnyInvocable<int32_t(uint64_t, char*, int32_t)>;
+  // Function that performs a call to the sysbus read/write methods, e.g., on
+  // a different thread.
+  using SysbusCaller = absl::AnyInvocable<void(absl::FunctionRef<void()>)>;
+
+  // Size of the blocks in which cached data is fetched from ReNode.
+  static constexpr uint64_t kCacheBlockSize = 4096;
 
   RenodeMemoryAccess(RenodeMemoryFunction read_fcn,
                      RenodeMemoryFunction write_fcn)
       : read_fcn_(std::move(read_fcn)), write_fcn_(std::move(write_fcn)) {}
+  // Modified cached data is not written back on destruction, as the ReNode
+  // memory access functions may no longer be valid. Call Flush() first.
+  ~RenodeMemoryAccess() override = default;
 
   // MemoryInterface methods.
   // Single item load.
@@ -66,8 +95,70 @@ class RenodeMemoryAccess : public MemoryInterface {
   void set_write_fcn(RenodeMemoryFunction write_fcn) {
     write_fcn_ = std::move(write_fcn);
   }
+  // If a caller is set, all calls to the sysbus read/write methods are made
+  // through it. Pass nullptr to call them directly.
+  void set_sysbus_caller(SysbusCaller caller) {
+    sysbus_caller_ = std::move(caller);
+  }
+
+  // Enables caching of the address range [base, base + size). The range must
+  // be aligned to kCacheBlockSize, must not overlap other cached ranges, and
+  // must be backed by memory without side effects on reads or writes. If
+  // write_back is true, stores are not written to ReNode until the range is
+  // flushed.
+  absl::Status AddCachedRange(uint64_t base, uint64_t size, bool write_back);
+  // Writes the modified bytes of the cached blocks that overlap [address,
+  // address + length) back to ReNode. Bytes that were not stored to are not
+  // written, so that writes to the same memory by other bus initiators are
+  // preserved.
+  void Flush(uint64_t address, uint64_t length);
+  // Flushes, then drops, the cached blocks that overlap [address, address +
+  // length), so that they are fetched from ReNode on the next access.
+  void Invalidate(uint64_t address, uint64_t length);
+
+  // If a writer is set, all data read from ReNode is recorded to it. If a
+  // reader is set, the data is read from it instead of from ReNode, and writes
+  // to ReNode are dropped. Neither is owned. Pass nullptr to stop.
+  void set_event_writer(ExternalEventWriter* writer) { event_writer_ = writer; }
+  void set_event_reader(ExternalEventReader* reader) { event_reader_ = reader; }
 
  private:
+  struct CachedRange {
+    uint64_t base;
+    uint64_t size;
+    bool write_back;
+  };
+  struct CacheBlock {
+    uint8_t data[kCacheBlockSize];
+    // True if any byte is dirty, and which bytes are dirty.
+    bool dirty = false;
+    bool dirty_bytes[kCacheBlockSize] = {};
+  };
+
+  // Read/write size bytes at address, using the cache if the address range is
+  // cached, otherwise through the ReNode memory access functions.
+  void ReadBytes(uint64_t address, uint8_t* data, int size);
+  void WriteBytes(uint64_t address, const uint8_t* data, int size);
+  // Returns the cached range that contains [address, address + size), or
+  // nullptr if there is none.
+  const CachedRange* FindCachedRange(uint64_t address, int size) const;
+  // Returns the cache block for the given block address, fetching it from
+  // ReNode if needed. Returns nullptr if the block can't be fetched.
+  CacheBlock* GetCacheBlock(uint64_t block_address);
+  // Writes the dirty bytes of the cache block back to ReNode.
+  void WriteBackBlock(uint64_t block_address, CacheBlock* block);
+  // Read/write through the ReNode memory access functions, recording or
+  // replaying the data read if enabled. Returns the number of bytes accessed.
+  int32_t SysbusRead(uint64_t address, uint8_t* data, int32_t size);
+  int32_t SysbusWrite(uint64_t address, const uint8_t* data, int32_t size);
+  // Makes the call, through the sysbus caller if set.
+  void CallSysbus(absl::FunctionRef<void()> call);
+  bool can_read() const {
+    return (read_fcn_ != nullptr) || (event_reader_ != nullptr);
+  }
+  bool can_write() const {
+    return (write_fcn_ != nullptr) || (event_reader_ != nullptr);
+  }
   // Method that is responsible to write back the load data to the appropriate
   // destination.
   void FinishLoad(int latency, Instruction* inst, ReferenceCount* context);
@@ -75,6 +166,16 @@ class RenodeMemoryAccess : public MemoryInterface {
   // System bus read/write function pointers (point to C# delegates).
   RenodeMemoryFunction read_fcn_;
   RenodeMemoryFunction write_fcn_;
+  SysbusCaller sysbus_caller_;
+  ExternalEventWriter* event_writer_ = nullptr;
+  ExternalEventReader* event_reader_ = nullptr;
+  bool replay_diverged_ = false;
+  // Cached address ranges and the blocks currently in the cache.
+  std::vector<CachedRange> cached_ranges_;
+  absl::flat_hash_map<uint64_t, std::unique_ptr<CacheBlock>> cache_blocks_;
+  // Most recently used cache block.
+  uint64_t last_block_address_ = 0;
+  CacheBlock* last_block_ = nullptr;
 };
 
 }  // namespace mpact::sim::util::renode
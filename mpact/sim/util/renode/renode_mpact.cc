@@ -14,18 +14,27 @@
 
 #include "mpact/sim/util/renode/renode_mpact.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <fstream>
 #include <ios>
 #include <limits>
+#include <memory>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
 
+#include "absl/functional/function_ref.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "mpact/sim/generic/core_debug_interface.h"
+#include "mpact/sim/generic/external_event_log.h"
 #include "mpact/sim/generic/type_helpers.h"
 #include "mpact/sim/util/memory/memory_interface.h"
 #include "mpact/sim/util/renode/renode_debug_interface.h"
@@ -102,6 +111,16 @@ int32_t write_register(int32_t id, uint32_t reg_id, uint64_t value) {
   return RenodeAgent::Instance()->WriteRegister(id, reg_id, value);
 }
 
+int32_t read_registers(int32_t id, const uint32_t* reg_ids, uint64_t* values,
+                       int32_t count) {
+  return RenodeAgent::Instance()->ReadRegisters(id, reg_ids, values, count);
+}
+
+int32_t write_registers(int32_t id, const uint32_t* reg_ids,
+                        const uint64_t* values, int32_t count) {
+  return RenodeAgent::Instance()->WriteRegisters(id, reg_ids, values, count);
+}
+
 uint64_t read_memory(int32_t id, uint64_t address, char* buffer,
                      uint64_t length) {
   return RenodeAgent::Instance()->ReadMemory(id, address, buffer, length);
@@ -112,10 +131,27 @@ uint64_t write_memory(int32_t id, uint64_t address, const char* buffer,
   return RenodeAgent::Instance()->WriteMemory(id, address, buffer, length);
 }
 
+int32_t add_cached_range(int32_t id, uint64_t base, uint64_t size,
+                         bool write_back) {
+  return RenodeAgent::Instance()->AddCachedRange(id, base, size, write_back);
+}
+
+int32_t flush_memory(int32_t id, uint64_t address, uint64_t length) {
+  return RenodeAgent::Instance()->FlushMemory(id, address, length);
+}
+
+int32_t invalidate_memory(int32_t id, uint64_t address, uint64_t length) {
+  return RenodeAgent::Instance()->InvalidateMemory(id, address, length);
+}
+
 uint64_t step(int32_t id, uint64_t num_to_step, int32_t* status) {
   return RenodeAgent::Instance()->Step(id, num_to_step, status);
 }
 
+int32_t set_async_step(int32_t id, bool enable) {
+  return RenodeAgent::Instance()->SetAsyncStep(id, enable);
+}
+
 int32_t set_config(int32_t id, const char* config_names[],
                    const char* config_values[], int32_t size) {
   return RenodeAgent::Instance()->SetConfig(id, config_names, config_values,
@@ -126,11 +162,27 @@ int32_t set_irq_value(int32_t id, int32_t irq_num, bool irq_value) {
   return RenodeAgent::Instance()->SetIrqValue(id, irq_num, irq_value);
 }
 
+int32_t start_recording(int32_t id, const char* file_name) {
+  return RenodeAgent::Instance()->StartRecording(id, file_name);
+}
+
+int32_t start_replay(int32_t id, const char* file_name) {
+  return RenodeAgent::Instance()->StartReplay(id, file_name);
+}
+
+int32_t stop_record_replay(int32_t id) {
+  return RenodeAgent::Instance()->StopRecordReplay(id);
+}
+
 namespace mpact {
 namespace sim {
 namespace util {
 namespace renode {
 
+using ::mpact::sim::generic::ExternalEvent;
+using ::mpact::sim::generic::ExternalEventReader;
+using ::mpact::sim::generic::ExternalEventType;
+using ::mpact::sim::generic::ExternalEventWriter;
 using HaltReason = ::mpact::sim::generic::CoreDebugInterface::HaltReason;
 
 RenodeAgent* RenodeAgent::instance_ = nullptr;
@@ -168,6 +220,7 @@ int32_t RenodeAgent::Connect(char* cpu_type, int32_t id,
   // First check if the instance already exists.
   auto iter = core_dbg_instances_.find(id);
   if (iter != core_dbg_instances_.end()) {
+    WaitForStep(id);
     // If memory callbacks are provided, don't overwrite any previous non-null
     // callbacks.
     auto* mem_access = renode_memory_access_.at(id);
@@ -202,20 +255,27 @@ void RenodeAgent::Destroy(int32_t id) {
   // If it doesn't exist, it may already have been deleted, so just return.
   if (dbg_iter == core_dbg_instances_.end()) return;
 
+  // Stop any asynchronous stepping thread before deleting the instance.
+  SetAsyncStep(id, false);
   delete dbg_iter->second;
   core_dbg_instances_.erase(dbg_iter);
 
-  // Delete the memory access shim.
+  // Write back any modified cached data while the ReNode memory access
+  // functions are still valid, then delete the memory access shim.
   auto mem_iter = renode_memory_access_.find(id);
   if (mem_iter == renode_memory_access_.end()) return;
+  mem_iter->second->Flush(0, ~0ULL);
   delete mem_iter->second;
   renode_memory_access_.erase(mem_iter);
+  // The memory access shim may use the event log until it is deleted.
+  record_replay_.erase(id);
 }
 
 int32_t RenodeAgent::Reset(int32_t id) {
   // Check for valid instance.
   auto dbg_iter = core_dbg_instances_.find(id);
   if (dbg_iter == core_dbg_instances_.end()) return -1;
+  WaitForStep(id);
 
   // For now, do nothing.
   return 0;
@@ -225,6 +285,7 @@ int32_t RenodeAgent::GetRegisterInfoSize(int32_t id) const {
   // Check for valid instance.
   auto dbg_iter = core_dbg_instances_.find(id);
   if (dbg_iter == core_dbg_instances_.end()) return -1;
+  WaitForStep(id);
   auto* dbg = dbg_iter->second;
   return dbg->GetRenodeRegisterInfoSize();
 }
@@ -235,6 +296,7 @@ int32_t RenodeAgent::GetRegisterInfo(int32_t id, int32_t index, char* name,
   if (info == nullptr) return -1;
   auto dbg_iter = core_dbg_instances_.find(id);
   if (dbg_iter == core_dbg_instances_.end()) return -1;
+  WaitForStep(id);
   auto* dbg = dbg_iter->second;
   int32_t max_len = name_length_map_.at(id);
   auto result = dbg->GetRenodeRegisterInfo(index, max_len, name, *info);
@@ -249,6 +311,7 @@ int32_t RenodeAgent::ReadRegister(int32_t id, uint32_t reg_id,
   if (value == nullptr) return -1;
   auto dbg_iter = core_dbg_instances_.find(id);
   if (dbg_iter == core_dbg_instances_.end()) return -1;
+  WaitForStep(id);
   // Read register.
   auto* dbg = dbg_iter->second;
   auto result = dbg->ReadRegister(reg_id);
@@ -262,10 +325,65 @@ int32_t RenodeAgent::WriteRegister(int32_t id, uint32_t reg_id,
   // Check for valid instance.
   auto dbg_iter = core_dbg_instances_.find(id);
   if (dbg_iter == core_dbg_instances_.end()) return -1;
+  WaitForStep(id);
+  // Register writes come from the log when replaying.
+  auto* record_replay = GetRecordReplay(id);
+  if ((record_replay != nullptr) && (record_replay->reader != nullptr)) {
+    return 0;
+  }
   // Write register.
   auto* dbg = dbg_iter->second;
   auto result = dbg->WriteRegister(reg_id, value);
   if (!result.ok()) return -1;
+  if (record_replay != nullptr) {
+    record_replay->writer->WriteRegisterWrite(record_replay->instruction_count,
+                                              reg_id, value);
+  }
+  return 0;
+}
+
+// Read the registers given by the ids.
+int32_t RenodeAgent::ReadRegisters(int32_t id, const uint32_t* reg_ids,
+                                   uint64_t* values, int32_t count) {
+  // Check for valid instance.
+  if ((reg_ids == nullptr) || (values == nullptr) || (count < 0)) return -1;
+  auto dbg_iter = core_dbg_instances_.find(id);
+  if (dbg_iter == core_dbg_instances_.end()) return -1;
+  WaitForStep(id);
+  // The register ids are used as the register handles.
+  std::vector<RenodeDebugInterface::RegisterHandle> handles(reg_ids,
+                                                            reg_ids + count);
+  auto* dbg = dbg_iter->second;
+  auto status = dbg->ReadRegisters(handles, absl::MakeSpan(values, count));
+  if (!status.ok()) return -1;
+  return 0;
+}
+
+int32_t RenodeAgent::WriteRegisters(int32_t id, const uint32_t* reg_ids,
+                                    const uint64_t* values, int32_t count) {
+  // Check for valid instance.
+  if ((reg_ids == nullptr) || (values == nullptr) || (count < 0)) return -1;
+  auto dbg_iter = core_dbg_instances_.find(id);
+  if (dbg_iter == core_dbg_instances_.end()) return -1;
+  WaitForStep(id);
+  // The register ids are used as the register handles.
+  std::vector<RenodeDebugInterface::RegisterHandle> handles(reg_ids,
+                                                            reg_ids + count);
+  // Register writes come from the log when replaying.
+  auto* record_replay = GetRecordReplay(id);
+  if ((record_replay != nullptr) && (record_replay->reader != nullptr)) {
+    return 0;
+  }
+  auto* dbg = dbg_iter->second;
+  auto status =
+      dbg->WriteRegisters(handles, absl::MakeConstSpan(values, count));
+  if (!status.ok()) return -1;
+  if (record_replay != nullptr) {
+    for (int32_t i = 0; i < count; ++i) {
+      record_replay->writer->WriteRegisterWrite(
+          record_replay->instruction_count, reg_ids[i], values[i]);
+    }
+  }
   return 0;
 }
 
@@ -277,6 +395,7 @@ uint64_t RenodeAgent::ReadMemory(int32_t id, uint64_t address, char* buffer,
     LOG(ERROR) << "No such core dbg instance: " << id;
     return 0;
   }
+  WaitForStep(id);
   auto* dbg = dbg_iter->second;
   auto res = dbg->ReadMemory(address, buffer, length);
   if (!res.ok()) return 0;
@@ -291,12 +410,88 @@ uint64_t RenodeAgent::WriteMemory(int32_t id, uint64_t address,
     LOG(ERROR) << "No such core dbg instance: " << id;
     return 0;
   }
+  WaitForStep(id);
+  // Memory writes come from the log when replaying.
+  auto* record_replay = GetRecordReplay(id);
+  if ((record_replay != nullptr) && (record_replay->reader != nullptr)) {
+    return length;
+  }
   auto* dbg = dbg_iter->second;
   auto res = dbg->WriteMemory(address, buffer, length);
   if (!res.ok()) return 0;
+  if ((record_replay != nullptr) && (res.value() > 0)) {
+    record_replay->writer->WriteMemoryWrite(record_replay->instruction_count,
+                                            address, buffer, res.value());
+  }
   return res.value();
 }
 
+int32_t RenodeAgent::AddCachedRange(int32_t id, uint64_t base, uint64_t size,
+                                    bool write_back) {
+  auto mem_iter = renode_memory_access_.find(id);
+  if (mem_iter == renode_memory_access_.end()) {
+    LOG(ERROR) << "No such memory access instance: " << id;
+    return -1;
+  }
+  WaitForStep(id);
+  // Cache operations change the sequence of reads from ReNode, so they are
+  // recorded, and when replaying, they are applied from the log instead.
+  auto* record_replay = GetRecordReplay(id);
+  if ((record_replay != nullptr) && (record_replay->reader != nullptr)) {
+    return 0;
+  }
+  auto status = mem_iter->second->AddCachedRange(base, size, write_back);
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to add cached range: " << status.message();
+    return -1;
+  }
+  if (record_replay != nullptr) {
+    record_replay->writer->WriteAddCachedRange(record_replay->instruction_count,
+                                               base, size, write_back);
+  }
+  return 0;
+}
+
+int32_t RenodeAgent::FlushMemory(int32_t id, uint64_t address,
+                                 uint64_t length) {
+  auto mem_iter = renode_memory_access_.find(id);
+  if (mem_iter == renode_memory_access_.end()) {
+    LOG(ERROR) << "No such memory access instance: " << id;
+    return -1;
+  }
+  WaitForStep(id);
+  auto* record_replay = GetRecordReplay(id);
+  if ((record_replay != nullptr) && (record_replay->reader != nullptr)) {
+    return 0;
+  }
+  mem_iter->second->Flush(address, length);
+  if (record_replay != nullptr) {
+    record_replay->writer->WriteFlushMemory(record_replay->instruction_count,
+                                            address, length);
+  }
+  return 0;
+}
+
+int32_t RenodeAgent::InvalidateMemory(int32_t id, uint64_t address,
+                                      uint64_t length) {
+  auto mem_iter = renode_memory_access_.find(id);
+  if (mem_iter == renode_memory_access_.end()) {
+    LOG(ERROR) << "No such memory access instance: " << id;
+    return -1;
+  }
+  WaitForStep(id);
+  auto* record_replay = GetRecordReplay(id);
+  if ((record_replay != nullptr) && (record_replay->reader != nullptr)) {
+    return 0;
+  }
+  mem_iter->second->Invalidate(address, length);
+  if (record_replay != nullptr) {
+    record_replay->writer->WriteInvalidateMemory(
+        record_replay->instruction_count, address, length);
+  }
+  return 0;
+}
+
 uint64_t RenodeAgent::LoadExecutable(int32_t id, const char* file_name,
                                      bool for_symbols_only, int32_t* status) {
   // Get the debug interface.
@@ -307,6 +502,7 @@ uint64_t RenodeAgent::LoadExecutable(int32_t id, const char* file_name,
     return 0;
   }
   // Instantiate loader.
+  WaitForStep(id);
   auto* dbg = dbg_iter->second;
   auto res = dbg->LoadExecutable(file_name, for_symbols_only);
   if (!res.ok()) {
@@ -327,6 +523,7 @@ int32_t RenodeAgent::LoadImage(int32_t id, const char* file_name,
     LOG(ERROR) << "No such core dbg instance: " << id;
     return -1;
   }
+  WaitForStep(id);
   auto* dbg = dbg_iter->second;
   // Open up the image file.
   std::ifstream image_file;
@@ -370,6 +567,22 @@ uint64_t RenodeAgent::Step(int32_t id, uint64_t num_to_step, int32_t* status) {
     return 0;
   }
 
+  auto async_iter = async_steps_.find(id);
+  if (async_iter != async_steps_.end()) {
+    return StepAsync(async_iter->second.get(), num_to_step, status);
+  }
+  auto* record_replay = GetRecordReplay(id);
+  if (record_replay == nullptr) return StepCore(dbg, num_to_step, status);
+  if (record_replay->reader != nullptr) {
+    return StepReplay(dbg, record_replay, num_to_step, status);
+  }
+  uint64_t num_executed = StepCore(dbg, num_to_step, status);
+  record_replay->instruction_count += num_executed;
+  return num_executed;
+}
+
+uint64_t RenodeAgent::StepCore(RenodeDebugInterface* dbg, uint64_t num_to_step,
+                               int32_t* status) {
   if (num_to_step == 0) {
     *status = static_cast<int32_t>(ExecutionResult::kOk);
     return 0;
@@ -457,6 +670,140 @@ uint64_t RenodeAgent::Step(int32_t id, uint64_t num_to_step, int32_t* status) {
   return total_executed;
 }
 
+uint64_t RenodeAgent::StepAsync(AsyncStep* async, uint64_t num_to_step,
+                                int32_t* status) {
+  // Wait for the previous quantum to complete.
+  AwaitQuantum(async);
+  async->deficit += async->num_granted - async->num_executed;
+  async->num_granted = 0;
+  async->num_executed = 0;
+  // If the previous quantum ended with anything other than ok, report it now
+  // instead of starting a new quantum.
+  int32_t result = std::exchange(async->result,
+                                 static_cast<int32_t>(ExecutionResult::kOk));
+  if ((result != static_cast<int32_t>(ExecutionResult::kOk)) ||
+      (num_to_step == 0)) {
+    async->mutex.Unlock();
+    if (status != nullptr) *status = result;
+    return 0;
+  }
+  // Start the new quantum and report it as executed, less any instructions
+  // that were previously reported but not executed.
+  async->num_granted = num_to_step;
+  async->busy = true;
+  uint64_t deducted = std::min(async->deficit, num_to_step);
+  async->deficit -= deducted;
+  async->mutex.Unlock();
+  if (status != nullptr) {
+    *status = static_cast<int32_t>(ExecutionResult::kOk);
+  }
+  return num_to_step - deducted;
+}
+
+void RenodeAgent::AsyncStepLoop(RenodeDebugInterface* dbg, AsyncStep* async) {
+  while (true) {
+    uint64_t num_to_step;
+    {
+      absl::MutexLock lock(&async->mutex);
+      async->mutex.Await(absl::Condition(
+          +[](AsyncStep* state) { return state->busy || state->shutdown; },
+          async));
+      if (async->shutdown) return;
+      num_to_step = async->num_granted;
+    }
+    int32_t result;
+    uint64_t num_executed = StepCore(dbg, num_to_step, &result);
+    absl::MutexLock lock(&async->mutex);
+    async->num_executed = num_executed;
+    async->result = result;
+    async->busy = false;
+  }
+}
+
+void RenodeAgent::WaitForStep(int32_t id) const {
+  auto async_iter = async_steps_.find(id);
+  if (async_iter == async_steps_.end()) return;
+  auto* async = async_iter->second.get();
+  AwaitQuantum(async);
+  async->mutex.Unlock();
+}
+
+void RenodeAgent::AwaitQuantum(AsyncStep* async) {
+  async->mutex.Lock();
+  while (true) {
+    async->mutex.Await(absl::Condition(
+        +[](AsyncStep* state) {
+          return !state->busy || (state->pending_call != nullptr);
+        },
+        async));
+    if (async->pending_call == nullptr) return;
+    // Perform the access without holding the mutex, as it may take a while.
+    auto* call = async->pending_call;
+    async->mutex.Unlock();
+    (*call)();
+    async->mutex.Lock();
+    async->pending_call = nullptr;
+  }
+}
+
+int32_t RenodeAgent::SetAsyncStep(int32_t id, bool enable) {
+  // Get the core debug interface object.
+  auto* dbg = core_dbg(id);
+  // Is the debug interface valid?
+  if (dbg == nullptr) {
+    return -1;
+  }
+  auto async_iter = async_steps_.find(id);
+  if (enable) {
+    if (async_iter != async_steps_.end()) return 0;
+    if (record_replay_.contains(id)) {
+      LOG(ERROR) << "Asynchronous stepping is not supported when recording "
+                    "or replaying";
+      return -1;
+    }
+    auto async = std::make_unique<AsyncStep>();
+    async->thread =
+        std::thread(&RenodeAgent::AsyncStepLoop, this, dbg, async.get());
+    // The sysbus accesses made by the stepping thread are handed over to the
+    // ReNode thread, as the ReNode memory access functions are not thread
+    // safe. The stepping thread only accesses memory while executing a
+    // quantum, after the thread object is assigned.
+    auto mem_iter = renode_memory_access_.find(id);
+    if (mem_iter != renode_memory_access_.end()) {
+      mem_iter->second->set_sysbus_caller(
+          [async = async.get()](absl::FunctionRef<void()> call) {
+            if (std::this_thread::get_id() != async->thread.get_id()) {
+              call();
+              return;
+            }
+            absl::MutexLock lock(&async->mutex);
+            async->pending_call = &call;
+            async->mutex.Await(absl::Condition(
+                +[](AsyncStep* state) {
+                  return state->pending_call == nullptr;
+                },
+                async));
+          });
+    }
+    async_steps_.emplace(id, std::move(async));
+    return 0;
+  }
+  if (async_iter == async_steps_.end()) return 0;
+  // Complete any quantum in progress before stopping the thread. The result of
+  // the last quantum is discarded.
+  auto* async = async_iter->second.get();
+  AwaitQuantum(async);
+  async->shutdown = true;
+  async->mutex.Unlock();
+  async->thread.join();
+  auto mem_iter = renode_memory_access_.find(id);
+  if (mem_iter != renode_memory_access_.end()) {
+    mem_iter->second->set_sysbus_caller(nullptr);
+  }
+  async_steps_.erase(async_iter);
+  return 0;
+}
+
 // Set configuration item.
 int32_t RenodeAgent::SetConfig(int32_t id, const char* config_names[],
                                const char* config_values[], int size) {
@@ -466,6 +813,7 @@ int32_t RenodeAgent::SetConfig(int32_t id, const char* config_names[],
   if (dbg == nullptr) {
     return -1;
   }
+  WaitForStep(id);
   auto status = dbg->SetConfig(config_names, config_values, size);
   if (!status.ok()) {
     LOG(ERROR) << "SetConfig: " << status.message();
@@ -482,14 +830,174 @@ int32_t RenodeAgent::SetIrqValue(int32_t id, int32_t irq_num, bool irq_value) {
   if (dbg == nullptr) {
     return -1;
   }
+  WaitForStep(id);
+  // Irq changes come from the log when replaying.
+  auto* record_replay = GetRecordReplay(id);
+  if ((record_replay != nullptr) && (record_replay->reader != nullptr)) {
+    return 0;
+  }
   auto status = dbg->SetIrqValue(irq_num, irq_value);
   if (!status.ok()) {
     LOG(ERROR) << "SetIrqValue: " << status.message();
     return -1;
   }
+  if (record_replay != nullptr) {
+    record_replay->writer->WriteIrq(record_replay->instruction_count, irq_num,
+                                    irq_value);
+  }
+  return 0;
+}
+
+int32_t RenodeAgent::StartRecording(int32_t id, const char* file_name) {
+  return StartRecordReplay(id, file_name, /*replay=*/false);
+}
+
+int32_t RenodeAgent::StartReplay(int32_t id, const char* file_name) {
+  return StartRecordReplay(id, file_name, /*replay=*/true);
+}
+
+int32_t RenodeAgent::StartRecordReplay(int32_t id, const char* file_name,
+                                       bool replay) {
+  auto mem_iter = renode_memory_access_.find(id);
+  if (mem_iter == renode_memory_access_.end()) {
+    LOG(ERROR) << "No such memory access instance: " << id;
+    return -1;
+  }
+  if (async_steps_.contains(id)) {
+    LOG(ERROR) << "Recording or replaying is not supported with asynchronous "
+                  "stepping";
+    return -1;
+  }
+  StopRecordReplay(id);
+  auto* memory_access = mem_iter->second;
+  // Drop any cached data, so that all data is read through the log.
+  memory_access->Invalidate(0, ~0ULL);
+  auto record_replay = std::make_unique<RecordReplay>();
+  record_replay->memory_access = memory_access;
+  if (replay) {
+    record_replay->input.open(file_name, std::ios::in | std::ios::binary);
+    if (!record_replay->input.good()) {
+      LOG(ERROR) << "Failed to open replay file: " << file_name;
+      return -1;
+    }
+    record_replay->reader =
+        std::make_unique<ExternalEventReader>(&record_replay->input);
+    memory_access->set_event_reader(record_replay->reader.get());
+  } else {
+    record_replay->output.open(file_name, std::ios::out | std::ios::binary);
+    if (!record_replay->output.good()) {
+      LOG(ERROR) << "Failed to open recording file: " << file_name;
+      return -1;
+    }
+    record_replay->writer =
+        std::make_unique<ExternalEventWriter>(&record_replay->output);
+    memory_access->set_event_writer(record_replay->writer.get());
+  }
+  record_replay_.emplace(id, std::move(record_replay));
   return 0;
 }
 
+int32_t RenodeAgent::StopRecordReplay(int32_t id) {
+  auto mem_iter = renode_memory_access_.find(id);
+  if (mem_iter == renode_memory_access_.end()) {
+    LOG(ERROR) << "No such memory access instance: " << id;
+    return -1;
+  }
+  auto iter = record_replay_.find(id);
+  if (iter == record_replay_.end()) return 0;
+  // Write back data modified while replaying or recording, so that the
+  // writes are dropped or recorded consistently.
+  mem_iter->second->Invalidate(0, ~0ULL);
+  mem_iter->second->set_event_writer(nullptr);
+  mem_iter->second->set_event_reader(nullptr);
+  if (iter->second->writer != nullptr) iter->second->writer->Flush();
+  record_replay_.erase(iter);
+  return 0;
+}
+
+RenodeAgent::RecordReplay* RenodeAgent::GetRecordReplay(int32_t id) const {
+  auto iter = record_replay_.find(id);
+  if (iter == record_replay_.end()) return nullptr;
+  return iter->second.get();
+}
+
+uint64_t RenodeAgent::StepReplay(RenodeDebugInterface* dbg,
+                                 RecordReplay* record_replay,
+                                 uint64_t num_to_step, int32_t* status) {
+  auto* reader = record_replay->reader.get();
+  uint64_t total_executed = 0;
+  int32_t result = static_cast<int32_t>(ExecutionResult::kOk);
+  while (true) {
+    // Apply the events that are due, and find the time of the next one.
+    uint64_t next_time = ~0ULL;
+    while (true) {
+      auto res = reader->PeekEvent();
+      if (!res.ok()) {
+        LOG(ERROR) << "Replay: " << res.status().message();
+        result = static_cast<int32_t>(ExecutionResult::kAborted);
+        break;
+      }
+      const ExternalEvent* event = res.value();
+      if (event == nullptr) break;
+      if (event->time > record_replay->instruction_count) {
+        next_time = event->time;
+        break;
+      }
+      auto apply_status =
+          ApplyEvent(dbg, record_replay->memory_access, *event);
+      if (!apply_status.ok()) {
+        LOG(ERROR) << "Replay: " << apply_status.message();
+        result = static_cast<int32_t>(ExecutionResult::kAborted);
+        break;
+      }
+      reader->PopEvent();
+    }
+    if (result != static_cast<int32_t>(ExecutionResult::kOk)) break;
+    if (total_executed >= num_to_step) break;
+    // Step up to the next event.
+    uint64_t count = std::min(num_to_step - total_executed,
+                              next_time - record_replay->instruction_count);
+    uint64_t num_executed = StepCore(dbg, count, &result);
+    total_executed += num_executed;
+    record_replay->instruction_count += num_executed;
+    if ((result != static_cast<int32_t>(ExecutionResult::kOk)) ||
+        (num_executed < count)) {
+      break;
+    }
+  }
+  if (status != nullptr) *status = result;
+  return total_executed;
+}
+
+absl::Status RenodeAgent::ApplyEvent(RenodeDebugInterface* dbg,
+                                     RenodeMemoryAccess* memory_access,
+                                     const ExternalEvent& event) {
+  switch (event.type) {
+    case ExternalEventType::kIrq:
+      return dbg->SetIrqValue(static_cast<int32_t>(event.address),
+                              event.value != 0);
+    case ExternalEventType::kRegisterWrite:
+      return dbg->WriteRegister(static_cast<uint32_t>(event.address),
+                                event.value);
+    case ExternalEventType::kMemoryWrite:
+      return dbg
+          ->WriteMemory(event.address, event.data.data(), event.data.size())
+          .status();
+    case ExternalEventType::kAddCachedRange:
+      return memory_access->AddCachedRange(
+          event.address, event.value,
+          !event.data.empty() && (event.data[0] != 0));
+    case ExternalEventType::kFlushMemory:
+      memory_access->Flush(event.address, event.value);
+      return absl::OkStatus();
+    case ExternalEventType::kInvalidateMemory:
+      memory_access->Invalidate(event.address, event.value);
+      return absl::OkStatus();
+    default:
+      return absl::InternalError("Unexpected external event type");
+  }
+}
+
 }  // namespace renode
 }  // namespace util
 }  // namespace sim
@@ -17,9 +17,16 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <fstream>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/any_invocable.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "mpact/sim/generic/external_event_log.h"
 #include "mpact/sim/util/renode/renode_debug_interface.h"
 #include "mpact/sim/util/renode/renode_memory_access.h"
 
@@ -75,16 +82,47 @@ int32_t load_image(int32_t id, const char* file_name, uint64_t address);
 int32_t read_register(int32_t id, uint32_t reg_id, uint64_t* value);
 // Write register reg_id in the instance id. A return value < 0 is an error.
 int32_t write_register(int32_t id, uint32_t reg_id, uint64_t value);
+// Read/write the count registers in the reg_ids array in the instance id,
+// storing/taking the values in/from the values array. A return value < 0 is an
+// error.
+int32_t read_registers(int32_t id, const uint32_t* reg_ids, uint64_t* values,
+                       int32_t count);
+int32_t write_registers(int32_t id, const uint32_t* reg_ids,
+                        const uint64_t* values, int32_t count);
 // Read/Write memory.
 uint64_t read_memory(int32_t id, uint64_t address, char* buffer,
                      uint64_t length);
 uint64_t write_memory(int32_t id, uint64_t address, const char* buffer,
                       uint64_t length);
+// Enable local caching of the sysbus address range [base, base + size), which
+// must be backed by RAM. If write_back is true, stores are kept in the cache
+// until the range is flushed. A return value < 0 is an error.
+int32_t add_cached_range(int32_t id, uint64_t base, uint64_t size,
+                         bool write_back);
+// Write modified cached data in the given range back to the sysbus. Must be
+// called before the memory is accessed by other bus initiators. A return value
+// < 0 is an error.
+int32_t flush_memory(int32_t id, uint64_t address, uint64_t length);
+// Flush and drop cached data in the given range. Must be called after the
+// memory is written by other bus initiators. A return value < 0 is an error.
+int32_t invalidate_memory(int32_t id, uint64_t address, uint64_t length);
 // Reset the instance. A return value < 0 is an error.
 int32_t reset(int32_t id);
 // Step the instance id by num_to_step instructions. Return the number of
 // instructions stepped. The status is written to the pointer *status.
 uint64_t step(int32_t id, uint64_t num_to_step, int32_t* status);
+// Enable/disable asynchronous (run-ahead) stepping of the instance id. When
+// enabled, step starts executing the instructions on a separate thread and
+// returns without waiting for them to complete, so that the caller can advance
+// the rest of the platform in the meantime. Any subsequent call for the
+// instance waits until the instructions have been executed. A halt of the
+// instance (e.g., at a breakpoint) is reported by the next call to step. The
+// memory callbacks are only called from the caller's thread: a sysbus access
+// that misses the cached ranges stalls the stepping thread until the next call
+// for the instance, which performs the access before waiting for the
+// instructions to complete. Cache the RAM ranges (add_cached_range) to avoid
+// such stalls. A return value < 0 is an error.
+int32_t set_async_step(int32_t id, bool enable);
 // Set configuration items. This passes in the id, two arrays of strings (names
 // and values), and the size of the two arrays. Depending on the name of the
 // configuration item, the string will be interpreted according to the expected
@@ -93,6 +131,22 @@ int32_t set_config(int32_t id, const char* config_name[],
                    const char* config_value[], int32_t size);
 // Set the given irq number (if valid) to the provided value.
 int32_t set_irq_value(int32_t id, int32_t irq_number, bool irq_value);
+// Record the external inputs of the instance id to the given file: the data
+// read from the sysbus, as well as irq value changes, register and memory
+// writes, and memory cache operations, together with the number of
+// instructions executed when they occur. Recording is not supported together
+// with asynchronous stepping. A return value < 0 is an error.
+int32_t start_recording(int32_t id, const char* file_name);
+// Replay the external inputs of the instance id from a file written by
+// start_recording, without calling the sysbus. The instance must be in the same
+// state as when recording started. Sysbus writes are dropped, and calls to
+// set_irq_value, write_register(s), write_memory, add_cached_range,
+// flush_memory and invalidate_memory are ignored, as they are applied from the
+// file when the instance reaches the recorded instruction count. A return value
+// < 0 is an error.
+int32_t start_replay(int32_t id, const char* file_name);
+// Stop recording or replaying. A return value < 0 is an error.
+int32_t stop_record_replay(int32_t id);
 }  // extern "C"
 
 namespace mpact {
@@ -138,18 +192,30 @@ class RenodeAgent {
                           RenodeCpuRegister* info);
   int32_t ReadRegister(int32_t id, uint32_t reg_id, uint64_t* value);
   int32_t WriteRegister(int32_t id, uint32_t reg_id, uint64_t value);
+  int32_t ReadRegisters(int32_t id, const uint32_t* reg_ids, uint64_t* values,
+                        int32_t count);
+  int32_t WriteRegisters(int32_t id, const uint32_t* reg_ids,
+                         const uint64_t* values, int32_t count);
   uint64_t ReadMemory(int32_t id, uint64_t address, char* buffer,
                       uint64_t length);
   uint64_t WriteMemory(int32_t id, uint64_t address, const char* buffer,
                        uint64_t length);
+  int32_t AddCachedRange(int32_t id, uint64_t base, uint64_t size,
+                         bool write_back);
+  int32_t FlushMemory(int32_t id, uint64_t address, uint64_t length);
+  int32_t InvalidateMemory(int32_t id, uint64_t address, uint64_t length);
 
   uint64_t LoadExecutable(int32_t id, const char* elf_file_name,
                           bool for_symbols_only, int32_t* status);
   int32_t LoadImage(int32_t id, const char* file_name, uint64_t address);
   uint64_t Step(int32_t id, uint64_t num_to_step, int32_t* status);
+  int32_t SetAsyncStep(int32_t id, bool enable);
   int32_t SetConfig(int32_t id, const char* config_names[],
                     const char* config_values[], int32_t size);
   int32_t SetIrqValue(int32_t id, int32_t irq_number, bool irq_value);
+  int32_t StartRecording(int32_t id, const char* file_name);
+  int32_t StartReplay(int32_t id, const char* file_name);
+  int32_t StopRecordReplay(int32_t id);
 
   // Accessor.
   RenodeDebugInterface* core_dbg(int32_t id) const {
@@ -160,8 +226,65 @@ class RenodeAgent {
 
  private:
   using RenodeMemoryFcn = absl::AnyInvocable<int32_t(uint64_t, char*, int32_t)>;
+  // State of an instance that is stepped asynchronously on its own thread.
+  struct AsyncStep {
+    absl::Mutex mutex;
+    std::thread thread;
+    // True while the thread is executing a quantum.
+    bool busy = false;
+    bool shutdown = false;
+    // Sysbus access that the thread is waiting for the ReNode thread to
+    // perform, or nullptr.
+    absl::FunctionRef<void()>* pending_call = nullptr;
+    // Number of instructions granted for, and executed in, the last quantum,
+    // and the execution result.
+    uint64_t num_granted = 0;
+    uint64_t num_executed = 0;
+    int32_t result = 0;
+    // Number of instructions reported to Renode as executed ahead of time, but
+    // not executed due to the core halting. It is deducted from the number of
+    // instructions reported in subsequent steps.
+    uint64_t deficit = 0;
+  };
+  // State of an instance whose external inputs are recorded or replayed. Only
+  // one of writer and reader is set.
+  struct RecordReplay {
+    std::ofstream output;
+    std::ifstream input;
+    std::unique_ptr<generic::ExternalEventWriter> writer;
+    std::unique_ptr<generic::ExternalEventReader> reader;
+    // The memory access shim of the instance, to which replayed cache
+    // operations are applied.
+    RenodeMemoryAccess* memory_access = nullptr;
+    // Number of instructions executed since recording or replay started.
+    uint64_t instruction_count = 0;
+  };
+
   // Private constructor.
   RenodeAgent() = default;
+  // Step the core synchronously.
+  uint64_t StepCore(RenodeDebugInterface* dbg, uint64_t num_to_step,
+                    int32_t* status);
+  // Step the core asynchronously.
+  uint64_t StepAsync(AsyncStep* async, uint64_t num_to_step, int32_t* status);
+  // The loop executed by the asynchronous stepping thread.
+  void AsyncStepLoop(RenodeDebugInterface* dbg, AsyncStep* async);
+  // Wait until any asynchronous step of the instance id has completed.
+  void WaitForStep(int32_t id) const;
+  // Wait until the quantum in progress has completed, while performing the
+  // sysbus accesses requested by the stepping thread. Returns with the mutex
+  // held.
+  static void AwaitQuantum(AsyncStep* async);
+  int32_t StartRecordReplay(int32_t id, const char* file_name, bool replay);
+  // Returns the record/replay state of the instance id, or nullptr if it is
+  // neither recording nor replaying.
+  RecordReplay* GetRecordReplay(int32_t id) const;
+  // Step the core while applying the replayed events when they are due.
+  uint64_t StepReplay(RenodeDebugInterface* dbg, RecordReplay* record_replay,
+                      uint64_t num_to_step, int32_t* status);
+  absl::Status ApplyEvent(RenodeDebugInterface* dbg,
+                          RenodeMemoryAccess* memory_access,
+                          const generic::ExternalEvent& event);
   static RenodeAgent* instance_;
   static int32_t count_;
   // Map of renode memory access interfaces used to access devices and memory
@@ -172,6 +295,10 @@ class RenodeAgent {
   absl::flat_hash_map<int32_t, int32_t> name_length_map_;
   absl::flat_hash_map<int32_t, uint64_t> memory_bases_;
   absl::flat_hash_map<int32_t, uint64_t> memory_sizes_;
+  // Map of instances that are stepped asynchronously.
+  absl::flat_hash_map<int32_t, std::unique_ptr<AsyncStep>> async_steps_;
+  // Map of instances that are recorded or replayed.
+  absl::flat_hash_map<int32_t, std::unique_ptr<RecordReplay>> record_replay_;
 };
 
 }  // namespace renode
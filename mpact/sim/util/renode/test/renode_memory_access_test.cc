@@ -0,0 +1,270 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mpact/sim/util/renode/renode_memory_access.h"
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "googlemock/include/gmock/gmock.h"
+#include "googletest/include/gtest/gtest.h"
+#include "mpact/sim/generic/data_buffer.h"
+
+namespace {
+
+using ::mpact::sim::generic::DataBuffer;
+using ::mpact::sim::generic::DataBufferFactory;
+using ::mpact::sim::util::renode::RenodeMemoryAccess;
+using ::testing::ElementsAre;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+constexpr uint64_t kBlockSize = RenodeMemoryAccess::kCacheBlockSize;
+constexpr uint64_t kBase = 0x10000;
+constexpr uint64_t kSize = 4 * kBlockSize;
+
+// Tests the RenodeMemoryAccess class using sysbus read/write functions that
+// access a local memory array, and that record the address and size of each
+// call.
+class RenodeMemoryAccessTest : public ::testing::Test {
+ protected:
+  RenodeMemoryAccessTest()
+      : sysbus_memory_(kSize),
+        memory_(
+            [this](uint64_t address, char* data, int32_t size) {
+              reads_.emplace_back(address, size);
+              if ((address < kBase) || (address - kBase + size > kSize)) {
+                return 0;
+              }
+              std::memcpy(data, &sysbus_memory_[address - kBase], size);
+              return size;
+            },
+            [this](uint64_t address, char* data, int32_t size) {
+              writes_.emplace_back(address, size);
+              if ((address < kBase) || (address - kBase + size > kSize)) {
+                return 0;
+              }
+              std::memcpy(&sysbus_memory_[address - kBase], data, size);
+              return size;
+            }) {
+    for (uint64_t i = 0; i < kSize; ++i) sysbus_memory_[i] = i & 0xff;
+  }
+
+  // Returns the 32 bit value in the sysbus memory at address.
+  uint32_t SysbusValue(uint64_t address) const {
+    uint32_t value;
+    std::memcpy(&value, &sysbus_memory_[address - kBase], sizeof(value));
+    return value;
+  }
+  void SetSysbusValue(uint64_t address, uint32_t value) {
+    std::memcpy(&sysbus_memory_[address - kBase], &value, sizeof(value));
+  }
+
+  uint64_t LoadUint64(uint64_t address) {
+    DataBuffer* db = db_factory_.Allocate<uint64_t>(1);
+    db->set_latency(0);
+    memory_.Load(address, db, nullptr, nullptr);
+    uint64_t value = db->Get<uint64_t>(0);
+    db->DecRef();
+    return value;
+  }
+  uint32_t LoadUint32(uint64_t address) {
+    DataBuffer* db = db_factory_.Allocate<uint32_t>(1);
+    db->set_latency(0);
+    memory_.Load(address, db, nullptr, nullptr);
+    uint32_t value = db->Get<uint32_t>(0);
+    db->DecRef();
+    return value;
+  }
+  template <typename T>
+  void Store(uint64_t address, T value) {
+    DataBuffer* db = db_factory_.Allocate<T>(1);
+    db->Set<T>(0, value);
+    memory_.Store(address, db);
+    db->DecRef();
+  }
+
+  std::vector<uint8_t> sysbus_memory_;
+  std::vector<std::pair<uint64_t, int32_t>> reads_;
+  std::vector<std::pair<uint64_t, int32_t>> writes_;
+  RenodeMemoryAccess memory_;
+  DataBufferFactory db_factory_;
+};
+
+// Without cached ranges, each access is a sysbus call.
+TEST_F(RenodeMemoryAccessTest, Uncached) {
+  EXPECT_EQ(LoadUint32(kBase + 8), 0x0b0a'0908);
+  Store<uint32_t>(kBase + 8, 0x1234'5678);
+  EXPECT_EQ(SysbusValue(kBase + 8), 0x1234'5678);
+  EXPECT_THAT(reads_, ElementsAre(Pair(kBase + 8, 4)));
+  EXPECT_THAT(writes_, ElementsAre(Pair(kBase + 8, 4)));
+}
+
+// Loads and stores that straddle a cache block boundary fetch both blocks, and
+// are written back as one dirty run per block.
+TEST_F(RenodeMemoryAccessTest, StraddlingAccess) {
+  ASSERT_TRUE(memory_.AddCachedRange(kBase, kSize, /*write_back=*/true).ok());
+  uint64_t address = kBase + kBlockSize - 4;
+  uint64_t expected;
+  std::memcpy(&expected, &sysbus_memory_[address - kBase], sizeof(expected));
+  EXPECT_EQ(LoadUint64(address), expected);
+  EXPECT_THAT(reads_, ElementsAre(Pair(kBase, kBlockSize),
+                                  Pair(kBase + kBlockSize, kBlockSize)));
+  Store<uint64_t>(address, 0x1122'3344'5566'7788);
+  EXPECT_EQ(LoadUint64(address), 0x1122'3344'5566'7788);
+  EXPECT_TRUE(writes_.empty());
+  EXPECT_EQ(reads_.size(), 2);
+  memory_.Flush(kBase, kSize);
+  EXPECT_THAT(writes_, UnorderedElementsAre(Pair(address, 4),
+                                            Pair(kBase + kBlockSize, 4)));
+  EXPECT_EQ(SysbusValue(address), 0x5566'7788);
+  EXPECT_EQ(SysbusValue(address + 4), 0x1122'3344);
+}
+
+// A straddling store to a write through range updates the cached blocks and is
+// written to the sysbus as a single access.
+TEST_F(RenodeMemoryAccessTest, StraddlingWriteThrough) {
+  ASSERT_TRUE(memory_.AddCachedRange(kBase, kSize, /*write_back=*/false).ok());
+  uint64_t address = kBase + 2 * kBlockSize - 4;
+  Store<uint64_t>(address, 0x1122'3344'5566'7788);
+  EXPECT_THAT(writes_, ElementsAre(Pair(address, 8)));
+  EXPECT_EQ(LoadUint64(address), 0x1122'3344'5566'7788);
+  EXPECT_EQ(reads_.size(), 2);
+  memory_.Flush(kBase, kSize);
+  EXPECT_EQ(writes_.size(), 1);
+}
+
+// Only the bytes that were stored to are written back, so that the writes by
+// other bus initiators to the rest of the block are preserved.
+TEST_F(RenodeMemoryAccessTest, WriteBackDirtyRunsOnly) {
+  ASSERT_TRUE(memory_.AddCachedRange(kBase, kSize, /*write_back=*/true).ok());
+  EXPECT_EQ(LoadUint32(kBase), 0x0302'0100);
+  Store<uint32_t>(kBase + 16, 0xdead'beef);
+  Store<uint32_t>(kBase + 20, 0xfeed'f00d);
+  Store<uint16_t>(kBase + 64, 0xabcd);
+  // Writes by another bus initiator.
+  SetSysbusValue(kBase, 0x1111'1111);
+  SetSysbusValue(kBase + 100, 0x2222'2222);
+  memory_.Flush(kBase, kBlockSize);
+  EXPECT_THAT(writes_, ElementsAre(Pair(kBase + 16, 8), Pair(kBase + 64, 2)));
+  EXPECT_EQ(SysbusValue(kBase), 0x1111'1111);
+  EXPECT_EQ(SysbusValue(kBase + 16), 0xdead'beef);
+  EXPECT_EQ(SysbusValue(kBase + 20), 0xfeed'f00d);
+  EXPECT_EQ(SysbusValue(kBase + 64) & 0xffff, 0xabcd);
+  EXPECT_EQ(SysbusValue(kBase + 100), 0x2222'2222);
+  // The dirty bytes are cleared by the write back.
+  memory_.Flush(kBase, kSize);
+  EXPECT_EQ(writes_.size(), 2);
+  // Flushing a range that doesn't overlap the dirty block writes nothing.
+  Store<uint32_t>(kBase + 16, 0);
+  memory_.Flush(kBase + kBlockSize, kBlockSize);
+  EXPECT_EQ(writes_.size(), 2);
+}
+
+// Invalidated blocks are written back, then fetched again on the next access.
+TEST_F(RenodeMemoryAccessTest, InvalidateRefetch) {
+  ASSERT_TRUE(memory_.AddCachedRange(kBase, kSize, /*write_back=*/true).ok());
+  EXPECT_EQ(LoadUint32(kBase), 0x0302'0100);
+  Store<uint32_t>(kBase + 8, 0x5555'5555);
+  SetSysbusValue(kBase, 0x1234'5678);
+  // The cached data is stale until the block is invalidated.
+  EXPECT_EQ(LoadUint32(kBase), 0x0302'0100);
+  EXPECT_EQ(reads_.size(), 1);
+  memory_.Invalidate(kBase, 4);
+  EXPECT_THAT(writes_, ElementsAre(Pair(kBase + 8, 4)));
+  EXPECT_EQ(LoadUint32(kBase), 0x1234'5678);
+  EXPECT_EQ(LoadUint32(kBase + 8), 0x5555'5555);
+  EXPECT_THAT(reads_, ElementsAre(Pair(kBase, kBlockSize),
+                                  Pair(kBase, kBlockSize)));
+}
+
+// Unit stride vector accesses without masked off elements are performed as a
+// single access, others one element at a time.
+TEST_F(RenodeMemoryAccessTest, VectorLoadStore) {
+  constexpr int kNumElements = 4;
+  DataBuffer* address_db = db_factory_.Allocate<uint64_t>(1);
+  DataBuffer* mask_db = db_factory_.Allocate<bool>(kNumElements);
+  DataBuffer* db = db_factory_.Allocate<uint32_t>(kNumElements);
+  db->set_latency(0);
+  address_db->Set<uint64_t>(0, kBase + 32);
+  for (int i = 0; i < kNumElements; ++i) mask_db->Set<bool>(i, true);
+  memory_.Load(address_db, mask_db, sizeof(uint32_t), db, nullptr, nullptr);
+  for (int i = 0; i < kNumElements; ++i) {
+    EXPECT_EQ(db->Get<uint32_t>(i), SysbusValue(kBase + 32 + i * 4));
+  }
+  EXPECT_THAT(reads_, ElementsAre(Pair(kBase + 32, 16)));
+  for (int i = 0; i < kNumElements; ++i) db->Set<uint32_t>(i, i + 1);
+  memory_.Store(address_db, mask_db, sizeof(uint32_t), db);
+  EXPECT_THAT(writes_, ElementsAre(Pair(kBase + 32, 16)));
+  // Masked accesses skip the masked off elements.
+  reads_.clear();
+  writes_.clear();
+  mask_db->Set<bool>(1, false);
+  mask_db->Set<bool>(2, false);
+  for (int i = 0; i < kNumElements; ++i) db->Set<uint32_t>(i, 0);
+  SetSysbusValue(kBase + 36, 0x7777'7777);
+  memory_.Load(address_db, mask_db, sizeof(uint32_t), db, nullptr, nullptr);
+  EXPECT_THAT(reads_, ElementsAre(Pair(kBase + 32, 4), Pair(kBase + 44, 4)));
+  EXPECT_EQ(db->Get<uint32_t>(0), 1);
+  EXPECT_EQ(db->Get<uint32_t>(1), 0);
+  EXPECT_EQ(db->Get<uint32_t>(2), 0);
+  EXPECT_EQ(db->Get<uint32_t>(3), 4);
+  for (int i = 0; i < kNumElements; ++i) db->Set<uint32_t>(i, 0x10 + i);
+  memory_.Store(address_db, mask_db, sizeof(uint32_t), db);
+  EXPECT_THAT(writes_, ElementsAre(Pair(kBase + 32, 4), Pair(kBase + 44, 4)));
+  EXPECT_EQ(SysbusValue(kBase + 32), 0x10);
+  EXPECT_EQ(SysbusValue(kBase + 36), 0x7777'7777);
+  EXPECT_EQ(SysbusValue(kBase + 40), 3);
+  EXPECT_EQ(SysbusValue(kBase + 44), 0x13);
+  address_db->DecRef();
+  mask_db->DecRef();
+  db->DecRef();
+}
+
+// Vector accesses to a cached range are served by the cache.
+TEST_F(RenodeMemoryAccessTest, CachedVectorLoadStore) {
+  ASSERT_TRUE(memory_.AddCachedRange(kBase, kSize, /*write_back=*/true).ok());
+  constexpr int kNumElements = 4;
+  DataBuffer* address_db = db_factory_.Allocate<uint64_t>(kNumElements);
+  DataBuffer* mask_db = db_factory_.Allocate<bool>(kNumElements);
+  DataBuffer* db = db_factory_.Allocate<uint32_t>(kNumElements);
+  db->set_latency(0);
+  // Gather from both sides of a block boundary.
+  for (int i = 0; i < kNumElements; ++i) {
+    address_db->Set<uint64_t>(i, kBase + kBlockSize - 8 + i * 4);
+    mask_db->Set<bool>(i, i != 2);
+    db->Set<uint32_t>(i, 0x100 + i);
+  }
+  memory_.Store(address_db, mask_db, sizeof(uint32_t), db);
+  EXPECT_THAT(reads_, ElementsAre(Pair(kBase, kBlockSize),
+                                  Pair(kBase + kBlockSize, kBlockSize)));
+  EXPECT_TRUE(writes_.empty());
+  for (int i = 0; i < kNumElements; ++i) mask_db->Set<bool>(i, true);
+  memory_.Load(address_db, mask_db, sizeof(uint32_t), db, nullptr, nullptr);
+  EXPECT_EQ(db->Get<uint32_t>(0), 0x100);
+  EXPECT_EQ(db->Get<uint32_t>(1), 0x101);
+  EXPECT_EQ(db->Get<uint32_t>(2), SysbusValue(kBase + kBlockSize));
+  EXPECT_EQ(db->Get<uint32_t>(3), 0x103);
+  EXPECT_EQ(reads_.size(), 2);
+  memory_.Flush(kBase, kSize);
+  EXPECT_THAT(writes_, UnorderedElementsAre(Pair(kBase + kBlockSize - 8, 8),
+                                            Pair(kBase + kBlockSize + 4, 4)));
+  address_db->DecRef();
+  mask_db->DecRef();
+  db->DecRef();
+}
+
+}  // namespace
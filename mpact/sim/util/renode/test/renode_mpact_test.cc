@@ -0,0 +1,292 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mpact/sim/util/renode/renode_mpact.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "googletest/include/gtest/gtest.h"
+#include "mpact/sim/generic/core_debug_interface.h"
+#include "mpact/sim/generic/data_buffer.h"
+#include "mpact/sim/util/memory/memory_interface.h"
+#include "mpact/sim/util/renode/renode_debug_interface.h"
+
+namespace {
+
+using ::mpact::sim::generic::DataBuffer;
+using ::mpact::sim::generic::DataBufferFactory;
+using ::mpact::sim::util::MemoryInterface;
+using ::mpact::sim::util::renode::ExecutionResult;
+using ::mpact::sim::util::renode::RenodeCpuRegister;
+using ::mpact::sim::util::renode::RenodeDebugInterface;
+
+constexpr uint64_t kBase = 0x1000;
+constexpr uint64_t kSize = 0x1000;
+
+// Memory behind the sysbus.
+uint8_t sysbus_memory[kSize];
+// Number of sysbus reads, and the thread that made the most recent one.
+int sysbus_read_count = 0;
+std::thread::id sysbus_read_thread;
+
+int32_t SysbusRead(uint64_t address, char* data, int32_t size) {
+  sysbus_read_count++;
+  sysbus_read_thread = std::this_thread::get_id();
+  if ((address < kBase) || (address - kBase + size > kSize)) return 0;
+  std::memcpy(data, &sysbus_memory[address - kBase], size);
+  return size;
+}
+
+int32_t SysbusWrite(uint64_t address, char* data, int32_t size) {
+  if ((address < kBase) || (address - kBase + size > kSize)) return 0;
+  std::memcpy(&sysbus_memory[address - kBase], data, size);
+  return size;
+}
+
+// Core model that loads one of the first 16 words of the memory in each step,
+// and computes a checksum of the loaded values. It can be made to halt at a
+// software breakpoint when a given instruction count is reached, and to take
+// a while for each step, so that asynchronous steps are still in progress when
+// the next call is made.
+class TestCore : public RenodeDebugInterface {
+ public:
+  explicit TestCore(MemoryInterface* memory) : memory_(memory) {}
+
+  absl::StatusOr<int> Step(int num) override {
+    halt_reason_ = *HaltReason::kNone;
+    if (step_delay_ > absl::ZeroDuration()) absl::SleepFor(step_delay_);
+    for (int i = 0; i < num; ++i) {
+      if (count_ == halt_at_) {
+        halt_reason_ = *HaltReason::kSoftwareBreakpoint;
+        halt_at_ = ~0ULL;
+        return i;
+      }
+      DataBuffer* db = db_factory_.Allocate<uint32_t>(1);
+      db->set_latency(0);
+      memory_->Load(kBase + (count_ % 16) * sizeof(uint32_t), db, nullptr,
+                    nullptr);
+      last_value_ = db->Get<uint32_t>(0);
+      checksum_ = checksum_ * 31 + last_value_;
+      db->DecRef();
+      count_++;
+    }
+    return num;
+  }
+  absl::StatusOr<HaltReasonValueType> GetLastHaltReason() override {
+    return halt_reason_;
+  }
+
+  absl::StatusOr<uint64_t> LoadExecutable(const char* elf_file_name,
+                                          bool for_symbols_only) override {
+    return 0;
+  }
+  // Register reads return the instruction count.
+  absl::StatusOr<uint64_t> ReadRegister(uint32_t reg_id) override {
+    return count_;
+  }
+  absl::Status WriteRegister(uint32_t reg_id, uint64_t value) override {
+    return absl::OkStatus();
+  }
+  int32_t GetRenodeRegisterInfoSize() const override { return 0; }
+  absl::Status GetRenodeRegisterInfo(int32_t index, int32_t max_len,
+                                     char* name,
+                                     RenodeCpuRegister& info) override {
+    return absl::NotFoundError("No registers");
+  }
+  absl::Status SetConfig(const char* config_names[],
+                         const char* config_values[], int size) override {
+    return absl::OkStatus();
+  }
+  absl::Status SetIrqValue(int32_t irq_num, bool irq_value) override {
+    return absl::OkStatus();
+  }
+  // Memory reads return the instruction count.
+  absl::StatusOr<size_t> ReadMemory(uint64_t address, void* buf,
+                                    size_t length) override {
+    length = std::min(length, sizeof(count_));
+    std::memcpy(buf, &count_, length);
+    return length;
+  }
+  absl::StatusOr<size_t> WriteMemory(uint64_t address, const void* buf,
+                                     size_t length) override {
+    return length;
+  }
+
+  uint64_t count() const { return count_; }
+  uint64_t checksum() const { return checksum_; }
+  uint32_t last_value() const { return last_value_; }
+  void set_halt_at(uint64_t halt_at) { halt_at_ = halt_at; }
+  void set_step_delay(absl::Duration step_delay) { step_delay_ = step_delay; }
+
+ private:
+  MemoryInterface* memory_;
+  DataBufferFactory db_factory_;
+  HaltReasonValueType halt_reason_ = *HaltReason::kNone;
+  uint64_t halt_at_ = ~0ULL;
+  absl::Duration step_delay_ = absl::ZeroDuration();
+  uint64_t count_ = 0;
+  uint64_t checksum_ = 0;
+  uint32_t last_value_ = 0;
+};
+
+TestCore* test_core = nullptr;
+
+}  // namespace
+
+// Called by the agent to create the core model.
+RenodeDebugInterface* CreateMpactSim(std::string name, std::string cpu_type,
+                                     MemoryInterface* memory) {
+  test_core = new TestCore(memory);
+  return test_core;
+}
+
+namespace {
+
+// Cache operations change the sequence of sysbus reads, so they have to be
+// replayed at the same point of execution as they were recorded.
+TEST(RenodeMpactTest, RecordAndReplayWithInvalidate) {
+  std::string file_name = testing::TempDir() + "/renode_mpact_test.log";
+  char cpu_type[] = "test";
+  for (uint64_t i = 0; i < kSize; ++i) sysbus_memory[i] = i;
+  int32_t status;
+
+  int32_t id = construct_with_sysbus(cpu_type, 32, SysbusRead, SysbusWrite);
+  ASSERT_GE(id, 0);
+  ASSERT_EQ(start_recording(id, file_name.c_str()), 0);
+  ASSERT_EQ(add_cached_range(id, kBase, kSize, /*write_back=*/true), 0);
+  EXPECT_EQ(step(id, 128, &status), 128);
+  // Another bus initiator writes the memory. The core doesn't see the new
+  // value until the cached data is invalidated.
+  uint32_t value = 0x1234'5678;
+  std::memcpy(sysbus_memory, &value, sizeof(value));
+  EXPECT_EQ(step(id, 1, &status), 1);
+  EXPECT_EQ(test_core->last_value(), 0x0302'0100);
+  EXPECT_EQ(step(id, 15, &status), 15);
+  ASSERT_EQ(invalidate_memory(id, kBase, kSize), 0);
+  EXPECT_EQ(step(id, 1, &status), 1);
+  EXPECT_EQ(test_core->last_value(), value);
+  EXPECT_EQ(step(id, 50, &status), 50);
+  ASSERT_EQ(stop_record_replay(id), 0);
+  uint64_t count = test_core->count();
+  uint64_t checksum = test_core->checksum();
+  destruct(id);
+
+  // Replay without the sysbus, in steps of a different size. The cache
+  // operations requested during the replay are ignored.
+  id = construct(cpu_type, 32);
+  ASSERT_GE(id, 0);
+  ASSERT_EQ(start_replay(id, file_name.c_str()), 0);
+  uint64_t total = 0;
+  while (total < count) {
+    uint64_t num_executed =
+        step(id, std::min<uint64_t>(13, count - total), &status);
+    ASSERT_GT(num_executed, 0);
+    total += num_executed;
+    EXPECT_EQ(invalidate_memory(id, kBase, kSize), 0);
+  }
+  EXPECT_EQ(test_core->count(), count);
+  EXPECT_EQ(test_core->checksum(), checksum);
+  ASSERT_EQ(stop_record_replay(id), 0);
+  destruct(id);
+}
+
+// A halt during an asynchronous step is reported by the next step. The
+// instructions that were reported ahead of time but not executed are deducted
+// from the following steps.
+TEST(RenodeMpactTest, AsyncStepHaltDeficit) {
+  char cpu_type[] = "test";
+  int32_t status;
+  int32_t id = construct_with_sysbus(cpu_type, 32, SysbusRead, SysbusWrite);
+  ASSERT_GE(id, 0);
+  ASSERT_EQ(add_cached_range(id, kBase, kSize, /*write_back=*/false), 0);
+  ASSERT_EQ(set_async_step(id, true), 0);
+  test_core->set_halt_at(20);
+  // The quantum is reported as executed before it completes.
+  EXPECT_EQ(step(id, 32, &status), 32);
+  EXPECT_EQ(status, static_cast<int32_t>(ExecutionResult::kOk));
+  // The halt is reported by the next step, without executing anything.
+  EXPECT_EQ(step(id, 32, &status), 0);
+  EXPECT_EQ(status,
+            static_cast<int32_t>(ExecutionResult::kStoppedAtBreakpoint));
+  EXPECT_EQ(test_core->count(), 20);
+  // The 12 instructions that were not executed are deducted.
+  EXPECT_EQ(step(id, 32, &status), 20);
+  EXPECT_EQ(status, static_cast<int32_t>(ExecutionResult::kOk));
+  EXPECT_EQ(step(id, 5, &status), 5);
+  EXPECT_EQ(status, static_cast<int32_t>(ExecutionResult::kOk));
+  // Disabling asynchronous stepping completes the quantum in progress. The
+  // number of instructions reported now matches the number executed.
+  ASSERT_EQ(set_async_step(id, false), 0);
+  EXPECT_EQ(test_core->count(), 32 + 20 + 5);
+  EXPECT_EQ(step(id, 3, &status), 3);
+  EXPECT_EQ(test_core->count(), 32 + 20 + 5 + 3);
+  destruct(id);
+}
+
+// Register and memory calls for an instance wait for the asynchronous step in
+// progress to complete.
+TEST(RenodeMpactTest, AsyncStepWaitForStep) {
+  char cpu_type[] = "test";
+  int32_t status;
+  int32_t id = construct_with_sysbus(cpu_type, 32, SysbusRead, SysbusWrite);
+  ASSERT_GE(id, 0);
+  ASSERT_EQ(add_cached_range(id, kBase, kSize, /*write_back=*/false), 0);
+  ASSERT_EQ(set_async_step(id, true), 0);
+  test_core->set_step_delay(absl::Milliseconds(20));
+  EXPECT_EQ(step(id, 10, &status), 10);
+  uint64_t value = 0;
+  ASSERT_EQ(read_register(id, 0, &value), 0);
+  EXPECT_EQ(value, 10);
+  EXPECT_EQ(step(id, 10, &status), 10);
+  value = 0;
+  ASSERT_EQ(read_memory(id, kBase, reinterpret_cast<char*>(&value),
+                        sizeof(value)),
+            sizeof(value));
+  EXPECT_EQ(value, 20);
+  test_core->set_step_delay(absl::ZeroDuration());
+  destruct(id);
+}
+
+// A sysbus access by the stepping thread that misses the cached ranges is
+// performed on the calling thread by the next call for the instance.
+TEST(RenodeMpactTest, AsyncStepPendingSysbusCall) {
+  char cpu_type[] = "test";
+  int32_t status;
+  for (uint64_t i = 0; i < kSize; ++i) sysbus_memory[i] = i;
+  int32_t id = construct_with_sysbus(cpu_type, 32, SysbusRead, SysbusWrite);
+  ASSERT_GE(id, 0);
+  ASSERT_EQ(set_async_step(id, true), 0);
+  sysbus_read_count = 0;
+  EXPECT_EQ(step(id, 4, &status), 4);
+  // The stepping thread stalls at the first load until the next call.
+  EXPECT_EQ(sysbus_read_count, 0);
+  uint64_t value = 0;
+  ASSERT_EQ(read_register(id, 0, &value), 0);
+  EXPECT_EQ(value, 4);
+  EXPECT_EQ(sysbus_read_count, 4);
+  EXPECT_EQ(sysbus_read_thread, std::this_thread::get_id());
+  EXPECT_EQ(test_core->last_value(), 0x0f0e'0d0c);
+  destruct(id);
+}
+
+}  // namespace